@@ -1,11 +1,15 @@
 #include <filesystem>
 #include <csignal>
+#include <thread>
+
+#include <pthread.h>
 
 #include <tentris/store/TripleStore.hpp>
 #include "config/ServerConfig.hpp"
 #include <tentris/store/AtomicTripleStore.hpp>
 #include <tentris/store/config/AtomicTripleStoreConfig.cpp>
 #include <tentris/http/SparqlEndpoint.hpp>
+#include <tentris/store/BackgroundReload.hpp>
 #include <restinio/all.hpp>
 
 #include <fmt/format.h>
@@ -18,20 +22,21 @@ namespace {
 	using namespace fmt::literals;
 }
 
-void bulkload(std::string triple_file) {
+void bulkload(std::string triple_file, size_t load_threads) {
 
 	// log the starting time and print resource usage information
 	auto loading_start_time = log_health_data();
 
-	if (fs::is_regular_file(triple_file)) {
+	if (fs::is_regular_file(triple_file) or triple_file == "-") {
 		log("nt-file: {} loading ..."_format(triple_file));
-		AtomicTripleStore::getInstance().loadRDF(triple_file);
+		AtomicTripleStore::getInstance().loadRDF(triple_file, load_threads);
 	} else {
 		log("nt-file {} was not found."_format(triple_file));
 		log("Exiting ...");
 		std::exit(EXIT_FAILURE);
 	}
 	log("Loaded {} triples.\n"_format(AtomicTripleStore::getInstance().size()));
+	log("term store:\n{}"_format(AtomicTripleStore::getInstance().getTermIndex()));
 
 	// log the end time and print resource usage information
 	auto loading_end_time = log_health_data();
@@ -39,7 +44,53 @@ void bulkload(std::string triple_file) {
 	log_duration(loading_start_time, loading_end_time);
 }
 
+void load_snapshot(const std::string &snapshot_file) {
+	auto loading_start_time = log_health_data();
+
+	if (fs::is_regular_file(snapshot_file)) {
+		log("snapshot: {} loading ..."_format(snapshot_file));
+		AtomicTripleStore::getInstance().loadSnapshot(snapshot_file);
+	} else {
+		log("snapshot {} was not found."_format(snapshot_file));
+		log("Exiting ...");
+		std::exit(EXIT_FAILURE);
+	}
+	log("Loaded {} triples.\n"_format(AtomicTripleStore::getInstance().size()));
+	log("term store:\n{}"_format(AtomicTripleStore::getInstance().getTermIndex()));
+
+	auto loading_end_time = log_health_data();
+	log_duration(loading_start_time, loading_end_time);
+}
+
+/**
+ * Reloads the RDF file in the background whenever SIGHUP is received. SIGHUP must be blocked in all threads.
+ */
+void reload_on_sighup() {
+	std::thread([]() {
+		sigset_t signals;
+		sigemptyset(&signals);
+		sigaddset(&signals, SIGHUP);
+		while (true) {
+			int signal;
+			if (sigwait(&signals, &signal) != 0)
+				return;
+			const auto &store_cfg = AtomicTripleStoreConfig::getInstance();
+			log("SIGHUP received.");
+			if (store_cfg.rdf_file.empty() or store_cfg.rdf_file == "-")
+				logError("No reloadable RDF file is configured.");
+			else if (not tentris::store::BackgroundReload::start(store_cfg.rdf_file, store_cfg.load_threads))
+				logError("A reload is already running.");
+		}
+	}).detach();
+}
+
 int main(int argc, char *argv[]) {
+	// SIGHUP is handled by reload_on_sighup. Threads inherit the signal mask, so it is blocked before any is started.
+	sigset_t signals;
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGHUP);
+	pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
 	ServerConfig cfg{argc, argv};
 
 	init_logging(cfg.logstdout, cfg.logfile, cfg.logfiledir, cfg.loglevel);
@@ -47,21 +98,52 @@ int main(int argc, char *argv[]) {
 	auto &store_cfg = AtomicTripleStoreConfig::getInstance();
 	store_cfg.rdf_file = cfg.rdf_file;
 	store_cfg.timeout = cfg.timeout;
+	store_cfg.update_wait = cfg.update_wait;
 	store_cfg.cache_size = cfg.cache_size;
+	store_cfg.cache_bytes = cfg.cache_bytes;
+	store_cfg.cache_admission = cfg.cache_admission;
+	store_cfg.prepared_queries = cfg.prepared_queries;
+	store_cfg.adaptive_planner = cfg.adaptive_planner;
+	store_cfg.planner_exploration = cfg.planner_exploration;
+	store_cfg.load_threads = cfg.load_threads;
 
 	// bulkload file
-	if (not cfg.rdf_file.empty()) {
-		bulkload(cfg.rdf_file);
+	if (not cfg.snapshot_in.empty()) {
+		load_snapshot(cfg.snapshot_in);
+	} else if (not cfg.rdf_file.empty()) {
+		bulkload(cfg.rdf_file, cfg.load_threads);
 	} else {
 		log("No file loaded.");
 	}
 
+	if (not cfg.snapshot_out.empty())
+		AtomicTripleStore::getInstance().writeSnapshot(cfg.snapshot_out);
+
 	// create endpoint
 	using namespace restinio;
 	auto router = std::make_unique<router::express_router_t<>>();
 	router->http_get(
 			R"(/sparql)",
 			tentris::http::sparql_endpoint::sparql_endpoint);
+	router->http_post(
+			R"(/update)",
+			tentris::http::sparql_endpoint::update_endpoint);
+	router->http_post(
+			R"(/reload)",
+			tentris::http::sparql_endpoint::reload_endpoint);
+	router->http_post(
+			R"(/prepare)",
+			tentris::http::sparql_endpoint::prepare_endpoint);
+	router->http_delete(
+			R"(/prepare/:id)",
+			tentris::http::sparql_endpoint::unprepare_endpoint);
+	router->http_get(
+			R"(/execute/:id)",
+			tentris::http::sparql_endpoint::execute_endpoint);
+	router->http_get(
+			R"(/heuristics)",
+			tentris::http::sparql_endpoint::heuristics_endpoint);
+	reload_on_sighup();
 
 	router->non_matched_request_handler(
 			[](auto req) -> restinio::request_handling_status_t {
@@ -76,7 +76,13 @@ writeNTriple(std::ostream &stream, const std::shared_ptr<QueryExecutionPackage>
 	bool first = true;
 
 	if (not query_package->is_trivial_empty) {
+		const auto &term_store = AtomicTripleStore::getInstance().getTermIndex();
 		std::shared_ptr<void> raw_results = query_package->getEinsum(timeout);
+		if (not raw_results) {
+			::error = Errors::PROCESSING_TIMEOUT;
+			actual_timeout = steady_clock::now();
+			return;
+		}
 		auto &results = *static_cast<Einsum<RESULT_TYPE> *>(raw_results.get());
 		for (const auto &result : results) {
 			if (first) {
@@ -91,8 +97,8 @@ writeNTriple(std::ostream &stream, const std::shared_ptr<QueryExecutionPackage>
 					inner_first = false;
 				else
 					ss << ",";
-				if (binding != nullptr)
-					ss << binding->getIdentifier();
+				if (binding != tentris::store::rdf::TermStore::no_id)
+					ss << term_store.identifier(binding);
 			}
 			ss << "\n";
 
@@ -242,24 +248,40 @@ int main(int argc, char *argv[]) {
 
 	TripleStore triplestore{};
 
-	QueryExecutionPackage_cache executionpackage_cache{cfg.cache_size};
+	QueryExecutionPackage_cache executionpackage_cache{cfg.cache_size, cfg.cache_bytes, cfg.cache_admission};
 
 
 	onlystdout = cfg.onlystdout;
 
-	if (not cfg.rdf_file.empty()) {
+	if (not cfg.snapshot_in.empty()) {
+		logsink() << "Loading snapshot " << cfg.snapshot_in << " ..." << std::endl;
+		auto start_time = steady_clock::now();
+		AtomicTripleStore::getInstance().loadSnapshot(cfg.snapshot_in);
+		logsink() << fmt::format("... loading finished. {} triples loaded in {}.",
+								 AtomicTripleStore::getInstance().size(),
+								 tentris::logging::toDurationStr(start_time, steady_clock::now())) << std::endl;
+	} else if (not cfg.rdf_file.empty()) {
+		if (cfg.rdf_file == "-") {
+			logsink() << "The terminal reads its queries from stdin, so the RDF file can not be read from stdin."
+					  << std::endl;
+			std::exit(EXIT_FAILURE);
+		}
 		logsink() << "Loading file " << cfg.rdf_file << " ..." << std::endl;
 		auto start_time = steady_clock::now();
-		AtomicTripleStore::getInstance().loadRDF(cfg.rdf_file);
+		auto load_stats = AtomicTripleStore::getInstance().loadRDF(cfg.rdf_file, cfg.load_threads);
 		auto duration = steady_clock::now() - start_time;
 		logsink() << fmt::format("... loading finished. {} triples loaded.", AtomicTripleStore::getInstance().size())
 				  << std::endl;
+		logsink() << fmt::format("throughput: {:.0f} triples/s", load_stats.triplesPerSecond()) << std::endl;
 		logsink() << "duration: {} h {} min {} s"_format(
 				(duration_cast<hours>(duration) % 24).count(),
 				(duration_cast<minutes>(duration) % 60).count(),
 				(duration_cast<seconds>(duration) % 60).count()) << std::endl;
 	}
 
+	if (not cfg.snapshot_out.empty())
+		AtomicTripleStore::getInstance().writeSnapshot(cfg.snapshot_out);
+
 
 	std::thread commandline_client{commandlineInterface, std::ref(executionpackage_cache)};
 	// wait for keyboard interrupt
@@ -5,6 +5,7 @@
 #include <filesystem>
 #include <chrono>
 #include <iostream>
+#include <thread>
 
 #include <fmt/core.h>
 #include <fmt/format.h>
@@ -12,6 +13,8 @@
 
 #include <cxxopts.hpp>
 
+#include <tentris/util/FrequencySketch.hpp>
+
 
 namespace {
 	using namespace fmt::literals;
@@ -34,10 +37,46 @@ public:
 	 * The timeout for query processing of single queries.
 	 */
 	mutable std::chrono::steady_clock::duration timeout;
+	/**
+	 * How long an update waits for queries on the previous store version before it copies the store.
+	 */
+	mutable std::chrono::steady_clock::duration update_wait;
 	/**
 	 * Max number queries that may be cached.
 	 */
 	mutable size_t cache_size;
+	/**
+	 * Max estimated bytes of all cached queries. 0 means no limit.
+	 */
+	mutable size_t cache_bytes;
+	/**
+	 * Decides which queries are cached when the cache is full.
+	 */
+	mutable tentris::util::sync::AdmissionPolicy cache_admission;
+	/**
+	 * Max number of prepared queries.
+	 */
+	mutable size_t prepared_queries;
+	/**
+	 * If the join order heuristic of queries is chosen from the execution times of earlier queries.
+	 */
+	mutable bool adaptive_planner;
+	/**
+	 * Probability that the adaptive planner tries another heuristic than the fastest one.
+	 */
+	mutable double planner_exploration;
+	/**
+	 * Number of threads used for dictionary encoding while loading the RDF file.
+	 */
+	mutable size_t load_threads;
+	/**
+	 * Snapshot file that is loaded at startup instead of an RDF file.
+	 */
+	mutable std::string snapshot_in{};
+	/**
+	 * Snapshot file that is written after the data was loaded.
+	 */
+	mutable std::string snapshot_out{};
 
 	mutable logging::trivial::severity_level loglevel;
 
@@ -56,11 +95,36 @@ public:
 protected:
 	void addOptions() {
 		options.add_options()
-				("f,file", "ntriple file to load at startup", cxxopts::value<std::string>())
+				("f,file", "RDF file to load at startup. .gz, .bz2 and .zst files are decompressed while loading, - reads stdin.",
+				 cxxopts::value<std::string>())
 				("t,timeout", "time in seconds until processing a request is canceled by the server",
 				 cxxopts::value<uint>()->default_value("180"))
+				("update-wait",
+				 "time in milliseconds an update waits for queries on the store version before the last update to finish, so it can reuse that version instead of copying the store.",
+				 cxxopts::value<uint>()->default_value("1000"))
 				("l,cache_size", "Max number queries that may be cached.",
 				 cxxopts::value<size_t>()->default_value("500"))
+				("cache-bytes",
+				 "Max estimated memory in bytes of all cached queries. Cheap queries with large plans are evicted first. 0 means no limit.",
+				 cxxopts::value<size_t>()->default_value("0"))
+				("cache-admission",
+				 "Which queries are cached when the cache is full. Valid values are: [always, tinylfu]. tinylfu only caches a query if it was requested more often recently than the one it would evict.",
+				 cxxopts::value<std::string>()->default_value("always"))
+				("prepared-queries",
+				 "Max number of prepared queries. The least recently used one is dropped when a further one is prepared.",
+				 cxxopts::value<size_t>()->default_value("1000"))
+				("adaptive-planner",
+				 "If the join order heuristic of queries without sort and weight parameters is chosen from the execution times of earlier queries with the same shape. Queries that try another heuristic than the fastest one may take up to 10 times longer.",
+				 cxxopts::value<bool>()->default_value("false"))
+				("planner-exploration",
+				 "Probability in [0, 1] that the adaptive planner tries another join order heuristic than the fastest one.",
+				 cxxopts::value<double>()->default_value("0.05"))
+				("load-threads", "Number of threads used for dictionary encoding while loading the RDF file.",
+				 cxxopts::value<size_t>()->default_value("{}"_format(std::thread::hardware_concurrency())))
+				("snapshot-in", "binary snapshot to load at startup instead of an RDF file",
+				 cxxopts::value<std::string>())
+				("snapshot-out", "write a binary snapshot of the loaded data to this file",
+				 cxxopts::value<std::string>())
 				("loglevel", "Sets the logging level. Valid values are: [trace, debug, info, warning, error, fatal]",
 				 cxxopts::value<std::string>()->default_value("info"))
 				("logfile",
@@ -117,6 +181,8 @@ protected:
 		else
 			timeout = std::chrono::seconds(timeout_);
 
+		update_wait = std::chrono::milliseconds(arguments["update-wait"].as<uint>());
+
 
 		auto cache_size_ = arguments["cache_size"].as<size_t>();
 
@@ -126,6 +192,51 @@ protected:
 			cache_size = cache_size_;
 
 
+		cache_bytes = arguments["cache-bytes"].as<size_t>();
+
+
+		auto cache_admission_str = arguments["cache-admission"].as<std::string>();
+		if (cache_admission_str == "always")
+			cache_admission = tentris::util::sync::AdmissionPolicy::ALWAYS;
+		else if (cache_admission_str == "tinylfu")
+			cache_admission = tentris::util::sync::AdmissionPolicy::TINY_LFU;
+		else
+			throw cxxopts::argument_incorrect_type(
+					"{} is not a valid cache admission policy. Valid values are: [always, tinylfu]"_format(
+							cache_admission_str));
+
+
+		auto prepared_queries_ = arguments["prepared-queries"].as<size_t>();
+		if (prepared_queries_ == 0)
+			prepared_queries = 1;
+		else
+			prepared_queries = prepared_queries_;
+
+
+		adaptive_planner = arguments["adaptive-planner"].as<bool>();
+
+		planner_exploration = arguments["planner-exploration"].as<double>();
+		if (not(planner_exploration >= 0.0 and planner_exploration <= 1.0))
+			throw cxxopts::argument_incorrect_type(
+					"{} is not a valid planner exploration. It must be in [0, 1]."_format(planner_exploration));
+
+
+		auto load_threads_ = arguments["load-threads"].as<size_t>();
+
+		if (load_threads_ == 0)
+			load_threads = 1;
+		else
+			load_threads = load_threads_;
+
+
+		if (arguments.count("snapshot-in"))
+			snapshot_in = arguments["snapshot-in"].as<std::string>();
+		if (arguments.count("snapshot-out"))
+			snapshot_out = arguments["snapshot-out"].as<std::string>();
+		if (not snapshot_in.empty() and not rdf_file.empty())
+			throw cxxopts::argument_incorrect_type("Only one of file and snapshot-in may be set.");
+
+
 		auto loglevel_str = arguments["loglevel"].as<std::string>();
 		auto found = log_severity_mapping.find(loglevel_str);
 		if (found != log_severity_mapping.end()) {
@@ -1,6 +1,7 @@
 #include <iostream>
 #include <filesystem>
 
+#include <tentris/store/IdTripleFile.hpp>
 #include <tentris/store/RDF/SerdParser.hpp>
 #include <tentris/store/RDF/TermStore.hpp>
 #include <tentris/util/All.hpp>
@@ -9,28 +10,30 @@ int main(int argc, char *argv[]) {
 	using namespace rdf_parser::Turtle;
 	using namespace tentris::store;
 	using namespace fmt::literals;
-	if (argc != 2) {
-		std::cerr << "Please provide exactly one triple file as commandline argument." << std::endl;
+	if (argc != 3) {
+		std::cerr << "Usage: rdf2ids <triple file (- for stdin)> <output file>\n"
+					 "Writes the id triples to the output file and the dictionary to <output file>.dict."
+				  << std::endl;
 		exit(EXIT_FAILURE);
 	}
 
 	std::string rdf_file{argv[1]};
-	if (not std::filesystem::is_regular_file(rdf_file)) {
+	std::string ids_file{argv[2]};
+	if (not std::filesystem::is_regular_file(rdf_file) and rdf_file != "-") {
 		std::cerr << "{} is not a file."_format(rdf_file) << std::endl;
 		exit(EXIT_FAILURE);
 	}
 
 	rdf::TermStore ts{};
+	id_triples::Writer writer{ids_file};
 	unsigned int total = 0;
 	try {
 		unsigned int count = 0;
 		unsigned int _1mios = 0;
 		for (const Triple &triple : rdf::SerdParser{rdf_file}) {
-			std::array<uintptr_t, 3> id_triple{
-					(uintptr_t) ts[triple.subject()],
-					(uintptr_t) ts[triple.predicate()],
-					(uintptr_t) ts[triple.object()]};
-			fmt::print("{},{},{}\n", id_triple[0], id_triple[1], id_triple[2]);
+			writer.add({ts[triple.subject()],
+						ts[triple.predicate()],
+						ts[triple.object()]});
 			++count;
 			++total;
 			if (count == 1'000'000) {
@@ -44,4 +47,7 @@ int main(int argc, char *argv[]) {
 		throw std::invalid_argument{
 				"A parsing error occurred while parsing {}. Error occured at {}th triple."_format(rdf_file, total)};
 	}
+	writer.close();
+	id_triples::writeDictionary(ts, ids_file + ".dict");
+	std::cerr << "{:d} terms written to {}.dict."_format(ts.size(), ids_file) << std::endl;
 }
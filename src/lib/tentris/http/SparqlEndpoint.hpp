@@ -2,6 +2,7 @@
 #define TENTRIS_SPARQLENDPOINT_HPP
 
 #include <chrono>
+#include <optional>
 #include <sstream>
 #include <string>
 #include <tuple>
@@ -13,8 +14,14 @@
 
 #include "tentris/http/QueryResultState.hpp"
 #include "tentris/store/SPARQL/ParsedSPARQL.hpp"
+#include "tentris/store/SPARQL/ParsedUpdate.hpp"
+#include "tentris/store/AtomicHeuristicSelector.hpp"
+#include "tentris/store/AtomicPreparedQueries.hpp"
 #include "tentris/store/AtomicQueryExecutionPackageCache.hpp"
+#include "tentris/store/BackgroundReload.hpp"
 #include "tentris/store/JsonQueryResult.hpp"
+#include "tentris/tensor/PlannerOptions.hpp"
+#include "tentris/tensor/PlannerOptionsLock.hpp"
 #include "tentris/util/LogHelper.hpp"
 
 
@@ -27,20 +34,172 @@ namespace tentris::http {
 		using namespace ::tentris::logging;
 		using namespace std::string_literals;
 		using Status = ResultState;
+		using Term = ::rdf_parser::store::rdf::Term;
+		using PlannerOptions = ::tentris::tensor::PlannerOptions;
+		using PlannerOptionsLock = ::tentris::tensor::PlannerOptionsLock;
+		using HeuristicSelector = ::tentris::store::HeuristicSelector;
+		using AtomicHeuristicSelector = ::tentris::store::AtomicHeuristicSelector;
+		using AtomicPreparedQueries = ::tentris::store::AtomicPreparedQueries;
 	} // namespace
 
 
 	namespace sparql_endpoint {
 
+		/**
+		 * Limits the evaluation of a query and reports when it ran. The evaluation starts when the query got its join
+		 * order heuristic, see PlannerOptionsLock.
+		 */
+		struct Evaluation {
+			/**
+			 * Max time of the evaluation. Without it, only the timeout of the request applies.
+			 */
+			std::optional<steady_clock::duration> time_limit{};
+			/**
+			 * Nothing if the query was not evaluated, e.g. because it is trivially empty.
+			 */
+			std::optional<time_point_t> start{};
+			/**
+			 * When the evaluation finished or was stopped.
+			 */
+			time_point_t end{};
+			/**
+			 * When the evaluation was stopped at the latest.
+			 */
+			time_point_t deadline{};
+		};
+
 		Status
 		runQuery(restinio::request_handle_t &req, std::shared_ptr<QueryExecutionPackage> &query_package,
-				 const time_point_t timeout);
+				 const time_point_t timeout, const PlannerOptions &planner_options, Evaluation &evaluation);
 
 		template<typename RESULT_TYPE>
 		Status runQuery(restinio::request_handle_t &req, std::shared_ptr<QueryExecutionPackage> &query_package,
-						const time_point_t timeout);
+						const time_point_t timeout, const PlannerOptions &planner_options, Evaluation &evaluation);
+
+		/**
+		 * Reads the join order heuristic of a request from the URL parameters sort and weight, e.g.
+		 * /sparql?query=...&sort=MINIMUM&weight=CARDINALITY. Missing or unknown values keep the default.
+		 */
+		inline PlannerOptions parsePlannerOptions(const restinio::query_string_params_t &query_params) {
+			PlannerOptions planner_options{};
+			if (query_params.has("sort")) {
+				const std::string sort_string{query_params["sort"]};
+				if (auto sort_order = PlannerOptions::parseSortOrder(sort_string); sort_order)
+					planner_options.sort_order = *sort_order;
+				else
+					logError(" ## Unknown Sort String\n"
+							 "    sort_string: {}"_format(sort_string));
+			}
+			if (query_params.has("weight")) {
+				const std::string weight_string{query_params["weight"]};
+				if (auto weight_func = PlannerOptions::parseWeightFunc(weight_string); weight_func)
+					planner_options.weight_func = *weight_func;
+				else
+					logError(" ## Unknown Weight String\n"
+							 "    weight_string: {}"_format(weight_string));
+			}
+			return planner_options;
+		}
+
+		/**
+		 * Runs a query with the join order heuristic requested by the URL parameters sort and weight. Without them and
+		 * if the adaptive planner is enabled, the HeuristicSelector chooses it from the execution times of earlier
+		 * queries with the same shape, and the evaluation time of this query is recorded for it. If the chosen
+		 * heuristic is not the best one and exceeds its time limit, the query is run again with the best one.
+		 */
+		inline Status planAndRunQuery(restinio::request_handle_t &req,
+									  std::shared_ptr<QueryExecutionPackage> &query_package, const time_point_t timeout,
+									  const restinio::query_string_params_t &query_params) {
+			const bool adaptive_planner = AtomicTripleStoreConfig::getInstance().adaptive_planner;
+			const std::string &shape = query_package->getQueryShape()->getShapeStr();
+			PlannerOptions planner_options{};
+			std::optional<steady_clock::duration> time_limit{};
+			PlannerOptions best{};
+			if (query_params.has("sort") or query_params.has("weight")) {
+				planner_options = parsePlannerOptions(query_params);
+				logDebug("planner options: {} (requested)"_format(planner_options));
+			} else if (adaptive_planner) {
+				const auto choice = AtomicHeuristicSelector::getInstance().choose(shape);
+				planner_options = choice.planner_options;
+				time_limit = choice.time_limit;
+				best = choice.best;
+				logDebug("planner options: {} ({}, {:.3f} ms mean of {} executions)"_format(
+						planner_options, HeuristicSelector::reasonName(choice.reason), choice.mean.count(),
+						choice.executions));
+			} else {
+				logDebug("planner options: {} (default)"_format(planner_options));
+			}
+
+			// runs the query, evaluates it for at most time_limit and records the evaluation time
+			const auto run = [&]() {
+				Evaluation evaluation{time_limit};
+				const Status status = runQuery(req, query_package, timeout, planner_options, evaluation);
+				// the time of queries that were not evaluated or waited for their heuristic until the timeout says
+				// nothing about the heuristic
+				if (adaptive_planner and evaluation.start) {
+					auto &selector = AtomicHeuristicSelector::getInstance();
+					if (status == Status::OK)
+						selector.record(shape, planner_options, evaluation.end - *evaluation.start);
+					else if (status == Status::PROCESSING_TIMEOUT and *evaluation.start < evaluation.deadline)
+						selector.recordTimeout(shape, planner_options,
+											   time_limit.value_or(AtomicTripleStoreConfig::getInstance().timeout));
+				}
+				return status;
+			};
+
+			Status status = run();
+			if (status == Status::PROCESSING_TIMEOUT and time_limit and steady_clock::now() < timeout) {
+				planner_options = best;
+				time_limit = std::nullopt;
+				logDebug("planner options: {} (time limit exceeded)"_format(planner_options));
+				status = run();
+			}
+			return status;
+		}
 
 
+		/**
+		 * Sends the response for the status of a query request. For OK and SERIALIZATION_TIMEOUT, the response was
+		 * already sent.
+		 */
+		restinio::request_handling_status_t respond(restinio::request_handle_t &req, Status status,
+													const std::string &query_string, const std::string &error_message) {
+			using namespace std::string_literals;
+			switch (status) {
+				case OK:
+					return restinio::request_accepted();
+				case UNPARSABLE:
+					logError(" ## unparsable query\n"
+							 "    query_string: {}\n"
+							 "    exception_message: {}"_format(query_string, error_message)
+					);
+					return req->create_response(restinio::http_status_line_t{restinio::status_code::bad_request,
+																			 "Could not parse the requested query."s}).connection_close().done();
+				case UNKNOWN_REQUEST:
+					logError("unknown HTTP command. Only HTTP GET and POST are supported.");
+					return req->create_response(restinio::status_not_implemented()).connection_close().done();
+				case PROCESSING_TIMEOUT:
+					logError("timeout during request processing");
+					return req->create_response(restinio::status_request_time_out()).connection_close().done();
+				case SERIALIZATION_TIMEOUT:
+					// no REQUEST TIMEOUT response can be sent here because we stream results directly to the client.
+					// Thus, the code was already written to the header.
+					logError("timeout during writing the result");
+					return restinio::request_accepted();
+				case UNEXPECTED:
+					logError(" ## unexpected internal error, exception_message: {}"_format(error_message)
+					);
+					return req->create_response(
+							restinio::status_internal_server_error()).connection_close().done();
+				case SEVERE_UNEXPECTED:
+					logError(" ## severe unexpected internal error,  exception_message: {}"_format(error_message)
+					);
+					return req->create_response(
+							restinio::status_internal_server_error()).connection_close().done();
+			}
+			return restinio::request_rejected();
+		}
+
 		/**
 		 * Main SPARQL endpoint. Parses HTTP queries and returns SPARQL JSON Results.
 		 */
@@ -63,46 +222,16 @@ namespace tentris::http {
 				if (query_params.has("query")) {
 					query_string = std::string(query_params["query"]);
 					log("query: {}"_format(query_string));
-					// check if there is actually an query
-					/*
-					 * adding sort & weight
-					 */
-					std::string sort_string = std::string(query_params["sort"]);
-                    std::string weight_string = std::string(query_params["weight"]);
-                    //
-                    // .../sparql?query=assda&sort=ASC&weight=XY
-
-                    log("sort: {}"_format(sort_string));
-                    log("weight: {}"_format(weight_string));
-                    if (sort_string == "MINIMUM")
-                        einsum::internal::sort_order = einsum::internal::SORT::MINIMUM;
-                    else if(sort_string == "MAXIMUM")
-                        einsum::internal::sort_order = einsum::internal::SORT::MAXIMUM;
-                    else if(sort_string == "RANDOM")
-                        einsum::internal::sort_order = einsum::internal::SORT::RANDOM;
-                    else
-                        logError(" ## Unknown Sort String\n"
-                                 "    sort_string: {}"_format(sort_string)
-                        );
-
-
-                    if (weight_string == "CARDINALITY")
-                        einsum::internal::weight_func = einsum::internal::WEIGHT::CARDINALITY;
-                    else if(sort_string == "NORMAL")
-                        einsum::internal::weight_func = einsum::internal::WEIGHT::NORMAL;
-                    else
-                        logError(" ## Unknown Weight String\n"
-                                 "    weight_string: {}"_format(weight_string)
-                        );
-
-                    try {
-						query_package = AtomicQueryExecutionCache::getInstance()[query_string];
+					try {
+						// the package pins the current version of the store, updates do not change it
+						query_package = AtomicQueryExecutionCache::getInstance().get(query_string,
+																					 AtomicTripleStore::pin());
 					} catch (const std::invalid_argument &exc) {
 						status = Status::UNPARSABLE;
 						error_message = exc.what();
 					}
 					if (status == Status::OK) {
-						status = runQuery(req, query_package, timeout);
+						status = planAndRunQuery(req, query_package, timeout, query_params);
 					}
 				} else {
 					status = Status::UNPARSABLE;
@@ -117,64 +246,238 @@ namespace tentris::http {
 				status = Status::SEVERE_UNEXPECTED;
 			}
 
-			switch (status) {
-				case OK:
-					handled = restinio::request_accepted();
-					break;
-				case UNPARSABLE:
-					logError(" ## unparsable query\n"
-							 "    query_string: {}"_format(query_string)
-					);
-					handled = req->create_response(restinio::http_status_line_t{restinio::status_code::bad_request,
-																				"Could not parse the requested query."s}).connection_close().done();
-					break;
-				case UNKNOWN_REQUEST:
-					logError("unknown HTTP command. Only HTTP GET and POST are supported.");
-					handled = req->create_response(restinio::status_not_implemented()).connection_close().done();
-					break;
-				case PROCESSING_TIMEOUT:
-					logError("timeout during request processing");
-					handled = req->create_response(restinio::status_request_time_out()).connection_close().done();
-					break;
-				case SERIALIZATION_TIMEOUT:
-					// no REQUEST TIMEOUT response can be sent here because we stream results directly to the client.
-					// Thus, the code was already written to the header.
-					logError("timeout during writing the result");
-					handled = restinio::request_accepted();
-					break;
-				case UNEXPECTED:
-					logError(" ## unexpected internal error, exception_message: {}"_format(error_message)
-					);
-					handled = req->create_response(
-							restinio::status_internal_server_error()).connection_close().done();
-					break;
-				case SEVERE_UNEXPECTED:
-					logError(" ## severe unexpected internal error,  exception_message: {}"_format(error_message)
-					);
-					handled = req->create_response(
-							restinio::status_internal_server_error()).connection_close().done();
-					break;
-			}
+			handled = respond(req, status, query_string, error_message);
 			if (handled == restinio::request_rejected())
 				logError(fmt::format("Handling the request was rejected."));
 			auto end_memory = get_memory_usage();
 			logDebug("ram: {:d} kB"_format(end_memory));
 			logDebug("ram diff: {:+3d} kB"_format(long(end_memory) - long(start_memory)));
 			logDebug("request duration: {}"_format(toDurationStr(start_time, steady_clock::now())));
+			logDebug("query cache: {}"_format(AtomicQueryExecutionCache::getInstance().stats()));
 			log("request ended.");
 			return handled;
 		};
 
+		/**
+		 * SPARQL 1.1 Update endpoint for INSERT DATA and DELETE DATA. The update is accepted as body of type
+		 * application/sparql-update or as form parameter "update". The update is applied to a new version of the store
+		 * (see AtomicTripleStore::update), so running queries neither see it nor hold it back.
+		 */
+		auto update_endpoint = [](restinio::request_handle_t req,
+								  [[maybe_unused]] auto params) -> restinio::request_handling_status_t {
+			auto start_time = steady_clock::now();
+			log("update started.");
+			std::string update_string{};
+			try {
+				const auto content_type = req->header().get_field_or(restinio::http_field::content_type, "");
+				if (content_type.find("application/x-www-form-urlencoded") != std::string::npos) {
+					const auto form = restinio::parse_query<restinio::parse_query_traits::javascript_compatible>(
+							req->body());
+					if (form.has("update"))
+						update_string = std::string(form["update"]);
+				} else {
+					update_string = req->body();
+				}
+				log("update: {}"_format(update_string));
+				ParsedUpdate parsed_update{update_string};
+
+				// a reload must neither be running nor start before the update is applied, or the update is lost
+				const auto reload_lock = BackgroundReload::blockReload();
+				if (not reload_lock) {
+					logError("update rejected, a reload is running.");
+					return req->create_response(restinio::status_service_unavailable()).connection_close().done();
+				}
+				const auto stats = AtomicTripleStore::update(parsed_update,
+															 AtomicTripleStoreConfig::getInstance().update_wait);
+				log("inserted {} and deleted {} triples, {} triples in the store."_format(
+						stats.inserted, stats.deleted, AtomicTripleStore::pin()->size()));
+				logDebug("update duration: {}"_format(toDurationStr(start_time, steady_clock::now())));
+				return req->create_response()
+						.append_header(restinio::http_field::content_type, "application/json")
+						.connection_close()
+						.set_body(R"({{"inserted":{},"deleted":{}}})"_format(stats.inserted, stats.deleted))
+						.done();
+			} catch (const std::invalid_argument &exc) {
+				logError(" ## unparsable update\n"
+						 "    update_string: {}\n"
+						 "    exception_message: {}"_format(update_string, exc.what()));
+				return req->create_response(restinio::http_status_line_t{restinio::status_code::bad_request,
+																		 "Could not parse the requested update."s})
+						.connection_close().done();
+			} catch (const std::exception &exc) {
+				logError(" ## unexpected internal error, exception_message: {}"_format(exc.what()));
+				return req->create_response(restinio::status_internal_server_error()).connection_close().done();
+			}
+		};
+
+		/**
+		 * Starts reloading the configured RDF file in the background. Responds with 202 Accepted when the reload was
+		 * started and with 409 Conflict when a reload is already running.
+		 */
+		auto reload_endpoint = [](restinio::request_handle_t req,
+								  [[maybe_unused]] auto params) -> restinio::request_handling_status_t {
+			const auto &config = AtomicTripleStoreConfig::getInstance();
+			if (config.rdf_file.empty() or config.rdf_file == "-") {
+				logError("reload requested, but no reloadable RDF file is configured.");
+				return req->create_response(restinio::status_bad_request()).connection_close().done();
+			}
+			if (not BackgroundReload::start(config.rdf_file, config.load_threads)) {
+				logError("reload requested, but a reload is already running.");
+				return req->create_response(restinio::status_conflict()).connection_close().done();
+			}
+			return req->create_response(restinio::status_accepted()).connection_close().done();
+		};
+
+		/**
+		 * Prepares a query for repeated execution with execute_endpoint. The query is accepted as body of type
+		 * application/sparql-query or as form parameter "query". Variables written as $name in its triple patterns are
+		 * parameters. Responds with 201 Created and {"id":"<id>","parameters":["<name>",...]}.
+		 */
+		auto prepare_endpoint = [](restinio::request_handle_t req,
+								   [[maybe_unused]] auto params) -> restinio::request_handling_status_t {
+			std::string query_string{};
+			try {
+				const auto content_type = req->header().get_field_or(restinio::http_field::content_type, "");
+				if (content_type.find("application/x-www-form-urlencoded") != std::string::npos) {
+					const auto form = restinio::parse_query<restinio::parse_query_traits::javascript_compatible>(
+							req->body());
+					if (form.has("query"))
+						query_string = std::string(form["query"]);
+				} else {
+					query_string = req->body();
+				}
+				log("prepare: {}"_format(query_string));
+				const auto prepared = AtomicPreparedQueries::getInstance().prepare(query_string);
+				std::string parameters{};
+				for (const auto &name : prepared->getParameterNames())
+					parameters += R"({}"{}")"_format(parameters.empty() ? "" : ",", name);
+				log("prepared query {} with parameters [{}]"_format(prepared->getId(), parameters));
+				return req->create_response(restinio::status_created())
+						.append_header(restinio::http_field::content_type, "application/json")
+						.append_header(restinio::http_field::location, "/execute/{}"_format(prepared->getId()))
+						.connection_close()
+						.set_body(R"({{"id":"{}","parameters":[{}]}})"_format(prepared->getId(), parameters))
+						.done();
+			} catch (const std::invalid_argument &exc) {
+				return respond(req, Status::UNPARSABLE, query_string, exc.what());
+			} catch (const std::exception &exc) {
+				return respond(req, Status::UNEXPECTED, query_string, exc.what());
+			}
+		};
+
+		/**
+		 * Drops a prepared query. Responds with 204 No Content, or with 404 Not Found for unknown ids.
+		 */
+		auto unprepare_endpoint = [](restinio::request_handle_t req,
+									 auto params) -> restinio::request_handling_status_t {
+			const std::string id{params["id"]};
+			if (not AtomicPreparedQueries::getInstance().remove(id)) {
+				logError("there is no prepared query {}."_format(id));
+				return req->create_response(restinio::status_not_found()).connection_close().done();
+			}
+			log("dropped prepared query {}."_format(id));
+			return req->create_response(restinio::status_no_content()).connection_close().done();
+		};
+
+		/**
+		 * Parses the N3 representation of a term, e.g. <http://example.com/s> or "name"@en.
+		 * @throw std::invalid_argument it is no valid term
+		 */
+		inline Term parseTerm(const std::string &n3) {
+			try {
+				Term term = Term::make_term(n3);
+				if (term.type() != Term::NodeType::None)
+					return term;
+			} catch (const std::exception &) {
+			}
+			throw std::invalid_argument{"{} is no valid RDF term."_format(n3)};
+		}
+
+		/**
+		 * Executes a prepared query. The values of its parameters are passed as URL parameters $name=<N3 term>, e.g.
+		 * /execute/<id>?$s=<http://example.com/s>. Responds like sparql_endpoint, and with 404 Not Found for unknown ids.
+		 */
+		auto execute_endpoint = [](restinio::request_handle_t req, auto params) -> restinio::request_handling_status_t {
+			auto start_time = steady_clock::now();
+			const std::string id{params["id"]};
+			log("execution of prepared query {} started."_format(id));
+			const auto prepared = AtomicPreparedQueries::getInstance().find(id);
+			if (not prepared) {
+				logError("there is no prepared query {}."_format(id));
+				return req->create_response(restinio::status_not_found()).connection_close().done();
+			}
+			auto timeout = start_time + AtomicTripleStoreConfig::getInstance().timeout;
+			Status status = Status::OK;
+			std::string error_message{};
+			const std::string query_string{req->header().request_target()};
+			try {
+				const auto query_params = restinio::parse_query<restinio::parse_query_traits::javascript_compatible>(
+						req->header().query());
+				std::shared_ptr<QueryExecutionPackage> query_package;
+				try {
+					std::map<std::string, Term> values{};
+					for (const auto &name : prepared->getParameterNames())
+						if (const auto key = "${}"_format(name); query_params.has(key))
+							values.emplace(name, parseTerm(std::string(query_params[key])));
+					// the package pins the current version of the store, updates do not change it
+					query_package = prepared->bind(values, AtomicTripleStore::pin());
+				} catch (const std::invalid_argument &exc) {
+					status = Status::UNPARSABLE;
+					error_message = exc.what();
+				}
+				if (status == Status::OK)
+					status = planAndRunQuery(req, query_package, timeout, query_params);
+			} catch (const std::exception &exc) {
+				status = Status::UNEXPECTED;
+				error_message = exc.what();
+			} catch (...) {
+				status = Status::SEVERE_UNEXPECTED;
+			}
+			const auto handled = respond(req, status, query_string, error_message);
+			logDebug("request duration: {}"_format(toDurationStr(start_time, steady_clock::now())));
+			log("execution of prepared query {} ended."_format(id));
+			return handled;
+		};
+
+		/**
+		 * Reports how the adaptive planner chooses the join order heuristics: for each query shape, the mean execution
+		 * time of each heuristic, the currently best one and how often a heuristic was chosen to warm up, exploit or
+		 * explore.
+		 */
+		auto heuristics_endpoint = [](restinio::request_handle_t req,
+									  [[maybe_unused]] auto params) -> restinio::request_handling_status_t {
+			const auto &selector = AtomicHeuristicSelector::getInstance();
+			std::string shapes{};
+			for (const auto &report : selector.report()) {
+				std::string heuristics{};
+				for (std::size_t i = 0; i < HeuristicSelector::heuristic_count; ++i)
+					heuristics += R"({}{{"heuristic":"{}","executions":{},"mean_ms":{:.3f}}})"_format(
+							heuristics.empty() ? "" : ",", HeuristicSelector::heuristics[i],
+							report.heuristics[i].executions, report.heuristics[i].mean.count());
+				shapes += R"({}{{"shape":"{}","best":"{}","choices":{{"warm-up":{},"exploit":{},"explore":{}}},"heuristics":[{}]}})"_format(
+						shapes.empty() ? "" : ",", escapeJsonString(report.shape),
+						HeuristicSelector::heuristics[report.best], report.choices[0], report.choices[1],
+						report.choices[2], heuristics);
+			}
+			return req->create_response()
+					.append_header(restinio::http_field::content_type, "application/json")
+					.connection_close()
+					.set_body(R"({{"adaptive_planner":{},"exploration_rate":{},"shapes":[{}]}})"_format(
+							AtomicTripleStoreConfig::getInstance().adaptive_planner, selector.getExplorationRate(),
+							shapes))
+					.done();
+		};
+
 		Status
 		runQuery(restinio::request_handle_t &req, std::shared_ptr<QueryExecutionPackage> &query_package,
-				 const time_point_t timeout) {
+				 const time_point_t timeout, const PlannerOptions &planner_options, Evaluation &evaluation) {
 
 			switch (query_package->getSelectModifier()) {
 				case SelectModifier::NONE: {
-					return runQuery<COUNTED_t>(req, query_package, timeout);
+					return runQuery<COUNTED_t>(req, query_package, timeout, planner_options, evaluation);
 				}
 				case SelectModifier::DISTINCT: {
-					return runQuery<DISTINCT_t>(req, query_package, timeout);
+					return runQuery<DISTINCT_t>(req, query_package, timeout, planner_options, evaluation);
 				}
 				default:
 					break;
@@ -185,15 +488,22 @@ namespace tentris::http {
 
 		template<typename RESULT_TYPE>
 		Status runQuery(restinio::request_handle_t &req, std::shared_ptr<QueryExecutionPackage> &query_package,
-						const time_point_t timeout) {
+						const time_point_t timeout, const PlannerOptions &planner_options, Evaluation &evaluation) {
 			// check if it timed out
 			if (steady_clock::now() >= timeout) {
 				return Status::PROCESSING_TIMEOUT;
 			}
 			const std::vector<Variable> &vars = query_package->getQueryVariables();
-			JsonQueryResult<RESULT_TYPE> json_result{vars};
+			JsonQueryResult<RESULT_TYPE> json_result{vars, query_package->getTripleStore()->getTermIndex()};
 			if (not query_package->is_trivial_empty) {
-				std::shared_ptr<void> raw_results = query_package->getEinsum(timeout);
+				auto guard = PlannerOptionsLock::getInstance().acquire(planner_options, timeout);
+				// queries with another heuristic ran until the timeout
+				if (not guard)
+					return Status::PROCESSING_TIMEOUT;
+				evaluation.start = steady_clock::now();
+				evaluation.deadline = (evaluation.time_limit)
+									  ? std::min(timeout, *evaluation.start + *evaluation.time_limit) : timeout;
+				std::shared_ptr<void> raw_results = query_package->getEinsum(std::move(*guard), evaluation.deadline);
 				auto &results = *static_cast<Einsum<RESULT_TYPE> *>(raw_results.get());
 
 
@@ -201,11 +511,17 @@ namespace tentris::http {
 				for (const EinsumEntry<RESULT_TYPE> &result : results) {
 					json_result.add(result);
 					if (++timout_check == 100) {
-						if (steady_clock::now() >= timeout)
+						if (steady_clock::now() >= evaluation.deadline) {
+							evaluation.end = steady_clock::now();
 							return Status::PROCESSING_TIMEOUT;
+						}
 						timout_check = 0;
 					}
 				}
+				evaluation.end = steady_clock::now();
+				// the Einsum stops at its deadline without an error
+				if (evaluation.end >= evaluation.deadline)
+					return Status::PROCESSING_TIMEOUT;
 			}
 
 			if (steady_clock::now() >= timeout) {
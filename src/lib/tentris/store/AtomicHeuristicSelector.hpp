@@ -0,0 +1,24 @@
+#ifndef TENTRIS_ATOMICHEURISTICSELECTOR_HPP
+#define TENTRIS_ATOMICHEURISTICSELECTOR_HPP
+
+#include "tentris/util/SingletonFactory.hpp"
+#include "tentris/store/HeuristicSelector.hpp"
+#include "tentris/store/config/AtomicTripleStoreConfig.cpp"
+
+namespace tentris::util::sync {
+	template<>
+	inline ::tentris::store::HeuristicSelector *
+	SingletonFactory<::tentris::store::HeuristicSelector>::make_instance() {
+		const auto &config = ::tentris::store::config::AtomicTripleStoreConfig::getInstance();
+		return new ::tentris::store::HeuristicSelector{config.planner_exploration};
+	}
+};
+
+namespace tentris::store {
+
+	/**
+	 * A SingletonFactory that allows to share a single HeuristicSelector instance between multiple threads.
+	 */
+	using AtomicHeuristicSelector = util::sync::SingletonFactory<HeuristicSelector>;
+};
+#endif //TENTRIS_ATOMICHEURISTICSELECTOR_HPP
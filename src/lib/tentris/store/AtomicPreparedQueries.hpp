@@ -0,0 +1,24 @@
+#ifndef TENTRIS_ATOMICPREPAREDQUERIES_HPP
+#define TENTRIS_ATOMICPREPAREDQUERIES_HPP
+
+#include "tentris/util/SingletonFactory.hpp"
+#include "tentris/store/PreparedQueries.hpp"
+#include "tentris/store/config/AtomicTripleStoreConfig.cpp"
+
+namespace tentris::util::sync {
+	template<>
+	inline ::tentris::store::PreparedQueries *
+	SingletonFactory<::tentris::store::PreparedQueries>::make_instance() {
+		const auto &config = ::tentris::store::config::AtomicTripleStoreConfig::getInstance();
+		return new ::tentris::store::PreparedQueries{config.prepared_queries};
+	}
+};
+
+namespace tentris::store {
+
+	/**
+	 * A SingletonFactory that allows to share a single PreparedQueries registry between multiple threads.
+	 */
+	using AtomicPreparedQueries = util::sync::SingletonFactory<PreparedQueries>;
+};
+#endif //TENTRIS_ATOMICPREPAREDQUERIES_HPP
@@ -18,7 +18,8 @@ namespace tentris::util::sync {
 	inline ::tentris::store::cache::QueryExecutionPackage_cache *
 	SingletonFactory<::tentris::store::cache::QueryExecutionPackage_cache>::make_instance() {
 		const auto &config = AtomicTripleStoreConfig::getInstance();
-		return new ::tentris::store::cache::QueryExecutionPackage_cache{config.cache_size};
+		return new ::tentris::store::cache::QueryExecutionPackage_cache{config.cache_size, config.cache_bytes,
+																		   config.cache_admission};
 	}
 };
 
@@ -1,10 +1,16 @@
 #ifndef TENTRIS_ATOMIC_TRIPLE_STORE
 #define TENTRIS_ATOMIC_TRIPLE_STORE
 
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
 
-#include "tentris/util/SingletonFactory.hpp"
 #include "tentris/store/TripleStore.hpp"
 #include "tentris/store/config/AtomicTripleStoreConfig.cpp"
+#include "tentris/util/LogHelper.hpp"
 
 namespace {
 	using namespace tentris::store;
@@ -12,20 +18,145 @@ namespace {
 	using namespace tentris::store::config;
 }
 
-namespace tentris::util::sync {
-	template<>
-	inline TripleStore *SingletonFactory<TripleStore>::make_instance() {
-		return new TripleStore{};
-	}
-};
-
 namespace tentris::store {
 
 	/**
-	 * A SingletonFactory that allows to share a single TripleStore instance between multiple threads.
+	 * Shares the current TripleStore between multiple threads. The instance can be replaced at runtime with swap().
+	 * Threads that work with the store for longer than a single call (e.g. to answer a query) must pin() it: the
+	 * replaced store is destroyed when the last pin is released.
+	 *
+	 * Updates are applied to a new version of the store that replaces the current one (see update()), so a query
+	 * reads the version it pinned until it is done, and neither waits for updates nor holds them back. The replaced
+	 * version is kept as spare: once no query reads it anymore, the next update catches it up with the changes it
+	 * missed and applies itself to it. Only if queries still read the spare, the update copies the current version.
+	 * After the first update, the store thus holds the hypertrie twice.
 	 */
+	class AtomicTripleStore {
+		inline static std::shared_ptr<TripleStore> instance{};
+		/**
+		 * Guards instance and the spare.
+		 */
+		inline static std::mutex mutex;
+		/**
+		 * Lets one update run at a time.
+		 */
+		inline static std::mutex update_mutex;
+		/**
+		 * The version that the last update replaced.
+		 */
+		inline static std::shared_ptr<TripleStore> spare{};
+		/**
+		 * The version that the last update created from the current one. The spare can only be reused as long as
+		 * this version is the current one, i.e. no reload replaced it.
+		 */
+		inline static std::weak_ptr<TripleStore> spare_successor{};
+		/**
+		 * The changes of the last update, which the spare misses.
+		 */
+		inline static std::vector<TripleChange> spare_changes{};
+
+	public:
+		AtomicTripleStore() = delete;
+
+		/**
+		 * @return the current store. The reference is only valid until the store is replaced; use pin() if it may
+		 * be replaced concurrently.
+		 */
+		inline static TripleStore &getInstance() {
+			return *pin();
+		}
+
+		/**
+		 * @return shared ownership of the current store. Creates an empty store on first use.
+		 */
+		inline static std::shared_ptr<TripleStore> pin() {
+			auto inst = std::atomic_load_explicit(&instance, std::memory_order_acquire);
+			if (not inst) {
+				std::lock_guard<std::mutex> lock(mutex);
+				inst = std::atomic_load_explicit(&instance, std::memory_order_relaxed);
+				if (not inst) {
+					inst = std::make_shared<TripleStore>();
+					std::atomic_store_explicit(&instance, inst, std::memory_order_release);
+				}
+			}
+			return inst;
+		}
+
+		/**
+		 * Replaces the current store.
+		 * @param replacement the new store
+		 * @return the replaced store
+		 */
+		inline static std::shared_ptr<TripleStore> swap(std::shared_ptr<TripleStore> replacement) {
+			std::shared_ptr<TripleStore> dropped_spare;
+			std::lock_guard<std::mutex> lock(mutex);
+			// the spare belongs to the replaced data
+			dropped_spare = std::exchange(spare, nullptr);
+			spare_changes.clear();
+			return std::atomic_exchange_explicit(&instance, std::move(replacement), std::memory_order_acq_rel);
+		}
+
+		/**
+		 * Applies an update to a new version of the store and makes it the current one. Queries that pinned the
+		 * previous version do not see the update. Updates run one after another.
+		 * @param update parsed INSERT DATA / DELETE DATA operations
+		 * @param spare_wait how long to wait for queries that still read the spare before the current version is
+		 * copied instead
+		 * @return number of triples that were actually inserted or deleted
+		 */
+		inline static UpdateStats update(const ParsedUpdate &update, std::chrono::steady_clock::duration spare_wait) {
+			using namespace std::chrono;
+			using namespace ::tentris::logging;
+			using namespace fmt::literals;
+			std::lock_guard<std::mutex> update_lock(update_mutex);
+			std::shared_ptr<TripleStore> current = pin();
+			std::shared_ptr<TripleStore> next;
+			std::vector<TripleChange> missed_changes;
+			{
+				std::shared_ptr<TripleStore> outdated;
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					outdated = std::exchange(spare, nullptr);
+					missed_changes = std::exchange(spare_changes, {});
+				}
+				if (outdated and spare_successor.lock() == current)
+					next = std::move(outdated);
+			}
+			if (next) {
+				// nobody can pin the spare anymore, so it is only waited for queries that pinned it before
+				const auto deadline = steady_clock::now() + spare_wait;
+				while (next.use_count() > 1 and steady_clock::now() < deadline)
+					std::this_thread::sleep_for(milliseconds(1));
+				if (next.use_count() == 1) {
+					// use_count() loads relaxed, the fence pairs it with the release of the last query's reference
+					std::atomic_thread_fence(std::memory_order_acquire);
+					next->apply(missed_changes);
+				} else {
+					log("queries still read the previous version of the store, the store is copied.");
+					next.reset();
+				}
+			}
+			if (not next) {
+				const auto copy_start = steady_clock::now();
+				next = current->copy();
+				logDebug("store copied in {}."_format(toDurationStr(copy_start, steady_clock::now())));
+			}
 
+			std::vector<TripleChange> changes;
+			const UpdateStats stats = next->update(update, &changes);
 
-	using AtomicTripleStore = SingletonFactory<TripleStore>;
+			std::shared_ptr<TripleStore> previous;
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				previous = std::atomic_exchange_explicit(&instance, next, std::memory_order_acq_rel);
+				if (previous == current) {
+					spare = previous;
+					spare_successor = next;
+					spare_changes = std::move(changes);
+				}
+			}
+			return stats;
+		}
+	};
 };
 #endif //TENTRIS_ATOMIC_TRIPLE_STORE
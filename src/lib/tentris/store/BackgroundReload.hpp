@@ -0,0 +1,84 @@
+#ifndef TENTRIS_BACKGROUNDRELOAD_HPP
+#define TENTRIS_BACKGROUNDRELOAD_HPP
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include "tentris/store/AtomicTripleStore.hpp"
+#include "tentris/util/LogHelper.hpp"
+
+namespace tentris::store {
+
+	/**
+	 * Reloads the dataset without downtime. A new TripleStore is loaded in a background thread while the current one
+	 * keeps serving. Afterwards, the new store replaces the current one in AtomicTripleStore. The cached query shapes
+	 * do not depend on the data and stay valid. Running queries pin the old store (see QueryExecutionPackage), so it
+	 * is freed when the last of them is done. Both stores are in memory at the same time while the reload runs.
+	 *
+	 * An update applied to the current store while a reload runs would be lost with the swap. Updates therefore hold
+	 * blockReload() while they pin and change the store: it fails while a reload runs, and no reload starts meanwhile.
+	 * A reload replaces the data with the content of the file, so updates made before it are discarded on purpose.
+	 */
+	class BackgroundReload {
+		inline static std::atomic<bool> running{false};
+		inline static std::mutex start_mutex{};
+
+	public:
+		BackgroundReload() = delete;
+
+		/**
+		 * Starts a reload unless one is already running.
+		 * @param file_path RDF file, see TripleStore::loadRDF
+		 * @param load_threads number of threads used for dictionary encoding
+		 * @return if the reload was started
+		 */
+		static bool start(std::string file_path, std::size_t load_threads) {
+			using namespace ::tentris::logging;
+			std::lock_guard<std::mutex> lock{start_mutex};
+			if (running.exchange(true, std::memory_order_acq_rel))
+				return false;
+			std::thread t([file_path = std::move(file_path), load_threads]() {
+				try {
+					log("reload of {} started."_format(file_path));
+					auto start_time = log_health_data();
+					auto replacement = std::make_shared<TripleStore>();
+					replacement->loadRDF(file_path, load_threads);
+					auto previous = AtomicTripleStore::swap(replacement);
+					log("reload finished, serving {} triples instead of {}."_format(replacement->size(),
+																				   previous->size()));
+					log_duration(start_time, log_health_data());
+				} catch (const std::exception &exc) {
+					logError("reload of {} failed, the current store keeps serving: {}"_format(file_path, exc.what()));
+				}
+				running.store(false, std::memory_order_release);
+			});
+			t.detach();
+			return true;
+		}
+
+		/**
+		 * Keeps reloads from starting while the returned lock is held. The store that is pinned while holding it is
+		 * not replaced before the lock is released.
+		 * @return the lock, or nothing if a reload is running
+		 */
+		static std::optional<std::unique_lock<std::mutex>> blockReload() {
+			std::unique_lock<std::mutex> lock{start_mutex};
+			if (running.load(std::memory_order_acquire))
+				return std::nullopt;
+			return lock;
+		}
+
+		/**
+		 * @return if a reload is running
+		 */
+		static bool isRunning() {
+			return running.load(std::memory_order_acquire);
+		}
+	};
+}
+
+#endif //TENTRIS_BACKGROUNDRELOAD_HPP
@@ -0,0 +1,297 @@
+#ifndef TENTRIS_HEURISTICSELECTOR_HPP
+#define TENTRIS_HEURISTICSELECTOR_HPP
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+#include "tentris/tensor/PlannerOptions.hpp"
+
+namespace tentris::store {
+
+	/**
+	 * Chooses the join order heuristic (PlannerOptions) of a query from the execution times of earlier queries with
+	 * the same QueryShape. Each heuristic is an arm of an epsilon-greedy bandit:
+	 *  - warm up: every heuristic is tried once, the default heuristic first,
+	 *  - exploit: the heuristic with the lowest mean execution time is chosen,
+	 *  - explore: with probability exploration_rate another heuristic is chosen instead. Only heuristics whose mean
+	 *  time is less than max_slowdown times the best one are explored.
+	 * Once a heuristic was measured, warm-up and exploration executions get a time limit of max_slowdown times the best
+	 * mean. A query that exceeds it is run again with the best heuristic, so trying another heuristic costs at most
+	 * about max_slowdown times the best execution time.
+	 *
+	 * Execution times are measured by the caller from when the query got its heuristic from the
+	 * tensor::PlannerOptionsLock, so the time a query waited for queries with other heuristics is not credited to it.
+	 *
+	 * The mean is a plain mean over the first executions and then an exponential moving average, so the choice follows
+	 * changes of the data. At most max_shapes shapes are tracked; queries of further shapes use the default heuristic.
+	 */
+	class HeuristicSelector {
+	public:
+		using PlannerOptions = tensor::PlannerOptions;
+		using SORT = PlannerOptions::SORT;
+		using WEIGHT = PlannerOptions::WEIGHT;
+
+		constexpr static std::size_t heuristic_count = 6;
+		/**
+		 * All heuristics, the default one first.
+		 */
+		constexpr static std::array<PlannerOptions, heuristic_count> heuristics{
+				PlannerOptions{SORT::MINIMUM, WEIGHT::CARDINALITY},
+				PlannerOptions{SORT::MINIMUM, WEIGHT::NORMAL},
+				PlannerOptions{SORT::MAXIMUM, WEIGHT::CARDINALITY},
+				PlannerOptions{SORT::MAXIMUM, WEIGHT::NORMAL},
+				PlannerOptions{SORT::RANDOM, WEIGHT::CARDINALITY},
+				PlannerOptions{SORT::RANDOM, WEIGHT::NORMAL}};
+		/**
+		 * After this many executions of a heuristic, its mean becomes an exponential moving average.
+		 */
+		constexpr static std::size_t mean_window = 8;
+		/**
+		 * Lower bound of Choice::time_limit, so that very fast queries are not rerun for a few microseconds of delay.
+		 */
+		constexpr static std::chrono::milliseconds min_time_limit{1};
+
+		enum class Reason {
+			/**
+			 * The heuristic was not tried yet for the shape.
+			 */
+			WARM_UP,
+			/**
+			 * The heuristic has the lowest mean time for the shape.
+			 */
+			EXPLOIT,
+			/**
+			 * Another heuristic was chosen at random.
+			 */
+			EXPLORE,
+			/**
+			 * Too many shapes are tracked, the default heuristic is used.
+			 */
+			UNTRACKED
+		};
+
+		struct Choice {
+			PlannerOptions planner_options;
+			Reason reason;
+			/**
+			 * Mean execution time of the chosen heuristic so far.
+			 */
+			std::chrono::duration<double, std::milli> mean{0};
+			std::size_t executions = 0;
+			/**
+			 * The time the execution may take, for WARM_UP and EXPLORE once another heuristic was measured. If it is
+			 * exceeded, the query is run again with best.
+			 */
+			std::optional<std::chrono::steady_clock::duration> time_limit{};
+			/**
+			 * The heuristic with the lowest mean time.
+			 */
+			PlannerOptions best = heuristics[0];
+		};
+
+		struct HeuristicStats {
+			std::size_t executions = 0;
+			std::chrono::duration<double, std::milli> mean{0};
+		};
+
+		/**
+		 * The state of a shape for reports.
+		 */
+		struct ShapeReport {
+			std::string shape;
+			std::array<HeuristicStats, heuristic_count> heuristics;
+			std::array<std::size_t, 3> choices;
+			std::size_t best;
+		};
+
+	private:
+		struct ShapeStats {
+			mutable std::mutex mutex;
+			std::array<HeuristicStats, heuristic_count> heuristics{};
+			/**
+			 * number of choices made for WARM_UP, EXPLOIT and EXPLORE
+			 */
+			std::array<std::size_t, 3> choices{};
+
+			/**
+			 * @return the tried heuristic with the lowest mean time, or the default one
+			 */
+			[[nodiscard]] std::size_t best() const {
+				std::size_t best = 0;
+				for (std::size_t i = 1; i < heuristic_count; ++i)
+					if (heuristics[i].executions != 0 and
+						(heuristics[best].executions == 0 or heuristics[i].mean < heuristics[best].mean))
+						best = i;
+				return best;
+			}
+		};
+
+		mutable std::shared_mutex mutex;
+		std::map<std::string, std::unique_ptr<ShapeStats>> shapes{};
+		std::size_t max_shapes;
+		double exploration_rate;
+		double max_slowdown;
+
+	public:
+		/**
+		 * @param exploration_rate probability that a query explores another heuristic than the best one
+		 * @param max_slowdown only heuristics less than this much slower than the best one are explored, and warm-up
+		 * and exploration executions may take at most this much longer than the best one
+		 * @param max_shapes max number of tracked query shapes
+		 */
+		explicit HeuristicSelector(double exploration_rate = 0.05, double max_slowdown = 10.0,
+								   std::size_t max_shapes = 10'000)
+				: max_shapes(max_shapes), exploration_rate(exploration_rate), max_slowdown(max_slowdown) {}
+
+		/**
+		 * Chooses the heuristic for the next execution of a query shape.
+		 * @param shape the shape string of the query, see QueryShape::getShapeStr()
+		 */
+		Choice choose(const std::string &shape) {
+			ShapeStats *stats = find(shape);
+			if (stats == nullptr)
+				return Choice{heuristics[0], Reason::UNTRACKED};
+
+			std::lock_guard<std::mutex> lock(stats->mutex);
+			const std::size_t best = stats->best();
+			std::size_t chosen = heuristic_count;
+			Reason reason = Reason::EXPLOIT;
+			for (std::size_t i = 0; i < heuristic_count; ++i)
+				if (stats->heuristics[i].executions == 0) {
+					chosen = i;
+					reason = Reason::WARM_UP;
+					break;
+				}
+			if (chosen == heuristic_count) {
+				chosen = best;
+				if (std::bernoulli_distribution{exploration_rate}(random())) {
+					std::vector<std::size_t> candidates{};
+					for (std::size_t i = 0; i < heuristic_count; ++i)
+						if (i != chosen and
+							stats->heuristics[i].mean < stats->heuristics[chosen].mean * max_slowdown)
+							candidates.push_back(i);
+					if (not candidates.empty()) {
+						chosen = candidates[std::uniform_int_distribution<std::size_t>{
+								0, candidates.size() - 1}(random())];
+						reason = Reason::EXPLORE;
+					}
+				}
+			}
+			++stats->choices[std::size_t(reason)];
+			std::optional<std::chrono::steady_clock::duration> time_limit{};
+			if (chosen != best and stats->heuristics[best].executions != 0)
+				time_limit = std::max<std::chrono::steady_clock::duration>(
+						std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+								stats->heuristics[best].mean * max_slowdown),
+						min_time_limit);
+			return Choice{heuristics[chosen], reason, stats->heuristics[chosen].mean,
+						  stats->heuristics[chosen].executions, time_limit, heuristics[best]};
+		}
+
+		/**
+		 * Records the execution time of a query.
+		 * @param shape the shape string of the query
+		 * @param planner_options the heuristic the query was executed with
+		 * @param duration the execution time
+		 */
+		void record(const std::string &shape, const PlannerOptions &planner_options,
+					std::chrono::steady_clock::duration duration) {
+			ShapeStats *stats = find(shape);
+			if (stats == nullptr)
+				return;
+			const auto heuristic = std::find(heuristics.begin(), heuristics.end(), planner_options);
+			if (heuristic == heuristics.end())
+				return;
+			std::lock_guard<std::mutex> lock(stats->mutex);
+			HeuristicStats &heuristic_stats = stats->heuristics[std::size_t(heuristic - heuristics.begin())];
+			++heuristic_stats.executions;
+			heuristic_stats.mean += (std::chrono::duration<double, std::milli>(duration) - heuristic_stats.mean) /
+									double(std::min(heuristic_stats.executions, mean_window));
+		}
+
+		/**
+		 * Records a query that was stopped at its deadline. It counts with the whole time budget of the execution, not
+		 * with the time until the deadline, which is close to 0 if little of the budget was left. So a heuristic that
+		 * times out never looks faster than one that finishes.
+		 * @param shape the shape string of the query
+		 * @param planner_options the heuristic the query was executed with
+		 * @param budget the time the execution was allowed to take
+		 */
+		void recordTimeout(const std::string &shape, const PlannerOptions &planner_options,
+						   std::chrono::steady_clock::duration budget) {
+			record(shape, planner_options, budget);
+		}
+
+		/**
+		 * @return the state of all tracked shapes
+		 */
+		[[nodiscard]] std::vector<ShapeReport> report() const {
+			std::vector<ShapeReport> reports{};
+			std::shared_lock<std::shared_mutex> lock(mutex);
+			reports.reserve(shapes.size());
+			for (const auto &[shape, stats] : shapes) {
+				std::lock_guard<std::mutex> stats_lock(stats->mutex);
+				reports.push_back(ShapeReport{shape, stats->heuristics, stats->choices, stats->best()});
+			}
+			return reports;
+		}
+
+		[[nodiscard]] double getExplorationRate() const {
+			return exploration_rate;
+		}
+
+		static const char *reasonName(Reason reason) {
+			switch (reason) {
+				case Reason::WARM_UP:
+					return "warm-up";
+				case Reason::EXPLOIT:
+					return "exploit";
+				case Reason::EXPLORE:
+					return "explore";
+				case Reason::UNTRACKED:
+					return "untracked";
+			}
+			return "";
+		}
+
+	private:
+		/**
+		 * Starts tracking the shape unless max_shapes are tracked already. The stats are never removed while the
+		 * selector lives, so the pointer stays valid after the lock is released.
+		 * @return the stats of the shape or nullptr if it is not tracked
+		 */
+		ShapeStats *find(const std::string &shape) {
+			{
+				std::shared_lock<std::shared_mutex> lock(mutex);
+				if (auto found = shapes.find(shape); found != shapes.end())
+					return found->second.get();
+				if (shapes.size() >= max_shapes)
+					return nullptr;
+			}
+			std::unique_lock<std::shared_mutex> lock(mutex);
+			if (shapes.size() >= max_shapes and shapes.count(shape) == 0)
+				return nullptr;
+			auto &stats = shapes[shape];
+			if (not stats)
+				stats = std::make_unique<ShapeStats>();
+			return stats.get();
+		}
+
+		static std::mt19937_64 &random() {
+			thread_local std::mt19937_64 random{std::random_device{}()};
+			return random;
+		}
+	};
+}
+
+#endif //TENTRIS_HEURISTICSELECTOR_HPP
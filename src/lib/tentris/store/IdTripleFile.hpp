@@ -0,0 +1,332 @@
+#ifndef TENTRIS_IDTRIPLEFILE_HPP
+#define TENTRIS_IDTRIPLEFILE_HPP
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include "tentris/store/RDF/TermStore.hpp"
+#include "tentris/tensor/BoolHypertrie.hpp"
+#include "tentris/util/MMapFile.hpp"
+
+namespace tentris::store::id_triples {
+
+	namespace {
+		using namespace fmt::literals;
+	}
+
+	using key_part_type = tensor::key_part_type;
+	using key_type = std::array<key_part_type, 3>;
+
+	/**
+	 * Binary file of dictionary encoded triples as written by rdf2ids and read by ids2hypertrie.
+	 *
+	 * Layout (host byte order):
+	 * <pre>
+	 * Header
+	 * blocks: (uint32 triple count, uint32 byte size, varint data)*
+	 * </pre>
+	 * Within a block, every id is stored as the zigzag-encoded difference to the id at the same position of the
+	 * previous triple, written as LEB128 varint. Consecutive triples usually share the subject or have close ids, so
+	 * most ids take one or two bytes. Blocks are independent of each other and can be decoded in parallel.
+	 *
+	 * The ids are TermStore ids. The terms belong into a dictionary side file, see writeDictionary().
+	 */
+	struct Header {
+		constexpr static std::array<char, 8> expected_magic{'T', 'N', 'T', 'R', 'I', 'D', 'S', '3'};
+		constexpr static std::uint32_t current_version = 1;
+
+		std::array<char, 8> magic = expected_magic;
+		std::uint32_t version = current_version;
+		std::uint32_t reserved = 0;
+		std::uint64_t triple_count = 0;
+		std::uint64_t block_count = 0;
+	};
+
+	/**
+	 * Header of the dictionary side file. It is followed by term_count x (uint32 length, N-Triples identifier bytes)
+	 * for the ids 1 ... term_count.
+	 */
+	struct DictionaryHeader {
+		constexpr static std::array<char, 8> expected_magic{'T', 'N', 'T', 'R', 'D', 'I', 'C', 'T'};
+		constexpr static std::uint32_t current_version = 1;
+
+		std::array<char, 8> magic = expected_magic;
+		std::uint32_t version = current_version;
+		std::uint32_t reserved = 0;
+		std::uint64_t term_count = 0;
+	};
+
+	namespace detail {
+		inline void writeVarint(std::string &out, std::uint64_t value) {
+			while (value >= 0x80) {
+				out += char((value & 0x7F) | 0x80);
+				value >>= 7;
+			}
+			out += char(value);
+		}
+
+		inline std::uint64_t readVarint(const char *&pos, const char *end) {
+			std::uint64_t value = 0;
+			for (unsigned shift = 0; shift < 64; shift += 7) {
+				if (pos == end)
+					throw std::invalid_argument{"truncated varint"};
+				const auto byte = std::uint8_t(*pos++);
+				value |= std::uint64_t(byte & 0x7F) << shift;
+				if ((byte & 0x80) == 0)
+					return value;
+			}
+			throw std::invalid_argument{"varint too long"};
+		}
+
+		constexpr std::uint64_t zigzag(std::int64_t value) {
+			return (std::uint64_t(value) << 1) ^ std::uint64_t(value >> 63);
+		}
+
+		constexpr std::int64_t unzigzag(std::uint64_t value) {
+			return std::int64_t(value >> 1) ^ -std::int64_t(value & 1);
+		}
+	}
+
+	/**
+	 * Writes an id triple file. The output is buffered and written block by block.
+	 */
+	class Writer {
+		std::string file_path;
+		std::ofstream out;
+		std::vector<char> buffer = std::vector<char>(std::size_t(1) << 20);
+		Header header{};
+		std::size_t block_size;
+		std::string block{};
+		std::uint32_t block_triples = 0;
+		key_type previous{};
+		bool closed = false;
+
+	public:
+		/**
+		 * @param file_path destination. It is overwritten if it exists.
+		 * @param block_size triples per block
+		 * @throw std::runtime_error the file could not be opened
+		 */
+		explicit Writer(std::string file_path, std::size_t block_size = std::size_t(1) << 16)
+				: file_path(std::move(file_path)), block_size(block_size) {
+			out.rdbuf()->pubsetbuf(buffer.data(), buffer.size());
+			out.open(this->file_path, std::ios::binary | std::ios::trunc);
+			if (not out)
+				throw std::runtime_error{"Could not open {} for writing."_format(this->file_path)};
+			out.write(reinterpret_cast<const char *>(&header), sizeof(Header)); // rewritten by close()
+		}
+
+		Writer(const Writer &) = delete;
+
+		Writer &operator=(const Writer &) = delete;
+
+		~Writer() {
+			if (not closed)
+				try {
+					close();
+				} catch (...) {}
+		}
+
+		void add(const key_type &key) {
+			for (std::size_t i = 0; i < 3; ++i)
+				detail::writeVarint(block, detail::zigzag(std::int64_t(key[i]) - std::int64_t(previous[i])));
+			previous = key;
+			++header.triple_count;
+			if (++block_triples == block_size)
+				flushBlock();
+		}
+
+		/**
+		 * Writes the last block and the header.
+		 * @throw std::runtime_error writing failed
+		 */
+		void close() {
+			closed = true;
+			flushBlock();
+			out.seekp(0);
+			out.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+			out.flush();
+			if (not out)
+				throw std::runtime_error{"Writing {} failed."_format(file_path)};
+			out.close();
+		}
+
+		[[nodiscard]] std::uint64_t size() const {
+			return header.triple_count;
+		}
+
+	private:
+		void flushBlock() {
+			if (block_triples == 0)
+				return;
+			const auto byte_size = std::uint32_t(block.size());
+			out.write(reinterpret_cast<const char *>(&block_triples), sizeof(block_triples));
+			out.write(reinterpret_cast<const char *>(&byte_size), sizeof(byte_size));
+			out.write(block.data(), block.size());
+			++header.block_count;
+			block.clear();
+			block_triples = 0;
+			previous = {};
+		}
+	};
+
+	/**
+	 * Reads an id triple file. The file is memory-mapped and the blocks are decoded in parallel.
+	 */
+	class Reader {
+		struct Block {
+			const char *data;
+			std::uint32_t byte_size;
+			std::uint32_t triple_count;
+			/**
+			 * number of triples in all blocks before this one
+			 */
+			std::uint64_t first_triple;
+		};
+
+		util::MMapFile file;
+		Header header{};
+		std::vector<Block> blocks{};
+
+	public:
+		/**
+		 * Maps the file and indexes its blocks.
+		 * @throw std::invalid_argument the file is no id triple file or it is truncated
+		 */
+		explicit Reader(const std::string &file_path) : file{file_path} {
+			if (file.size() < sizeof(Header))
+				throw std::invalid_argument{"{} is too small to be an id triple file."_format(file_path)};
+			std::memcpy(&header, file.data(), sizeof(Header));
+			if (header.magic != Header::expected_magic)
+				throw std::invalid_argument{"{} is not an id triple file."_format(file_path)};
+			if (header.version != Header::current_version)
+				throw std::invalid_argument{"{} has version {}, but only version {} is supported."_format(
+						file_path, header.version, Header::current_version)};
+			const char *pos = file.data() + sizeof(Header);
+			const char *const end = file.data() + file.size();
+			blocks.reserve(header.block_count);
+			std::uint64_t triples = 0;
+			for (std::uint64_t i = 0; i < header.block_count; ++i) {
+				Block block{};
+				if (std::size_t(end - pos) < 2 * sizeof(std::uint32_t))
+					throw std::invalid_argument{"{} is truncated."_format(file_path)};
+				std::memcpy(&block.triple_count, pos, sizeof(std::uint32_t));
+				std::memcpy(&block.byte_size, pos + sizeof(std::uint32_t), sizeof(std::uint32_t));
+				pos += 2 * sizeof(std::uint32_t);
+				if (std::size_t(end - pos) < block.byte_size)
+					throw std::invalid_argument{"{} is truncated."_format(file_path)};
+				block.data = pos;
+				block.first_triple = triples;
+				pos += block.byte_size;
+				triples += block.triple_count;
+				blocks.push_back(block);
+			}
+			if (triples != header.triple_count)
+				throw std::invalid_argument{"{} is corrupted."_format(file_path)};
+		}
+
+		[[nodiscard]] std::uint64_t size() const {
+			return header.triple_count;
+		}
+
+		/**
+		 * Decodes all triples in parallel.
+		 * @return the triples in file order
+		 * @throw std::invalid_argument a block is corrupted
+		 */
+		[[nodiscard]] std::vector<key_type> readAll() const {
+			std::vector<key_type> keys(header.triple_count);
+			tbb::parallel_for(tbb::blocked_range<std::size_t>(0, blocks.size()),
+							  [&](const tbb::blocked_range<std::size_t> &range) {
+								  for (std::size_t i = range.begin(); i != range.end(); ++i)
+									  decode(blocks[i], keys.data() + blocks[i].first_triple);
+							  });
+			return keys;
+		}
+
+	private:
+		void decode(const Block &block, key_type *out) const {
+			const char *pos = block.data;
+			const char *const end = block.data + block.byte_size;
+			key_type previous{};
+			for (std::uint32_t t = 0; t < block.triple_count; ++t) {
+				key_type &key = out[t];
+				for (std::size_t i = 0; i < 3; ++i) {
+					const std::int64_t value = std::int64_t(previous[i]) + detail::unzigzag(detail::readVarint(pos, end));
+					if (value < 0 or value > std::int64_t(std::numeric_limits<key_part_type>::max()))
+						throw std::invalid_argument{"{} contains an invalid id."_format(file.path())};
+					key[i] = key_part_type(value);
+				}
+				previous = key;
+			}
+			if (pos != end)
+				throw std::invalid_argument{"{} contains a corrupted block."_format(file.path())};
+		}
+	};
+
+	/**
+	 * Writes the terms of a TermStore in id order.
+	 * @throw std::runtime_error the file could not be written
+	 */
+	inline void writeDictionary(const rdf::TermStore &term_store, const std::string &file_path) {
+		std::vector<char> buffer(std::size_t(1) << 20);
+		std::ofstream out{};
+		out.rdbuf()->pubsetbuf(buffer.data(), buffer.size());
+		out.open(file_path, std::ios::binary | std::ios::trunc);
+		if (not out)
+			throw std::runtime_error{"Could not open {} for writing."_format(file_path)};
+		DictionaryHeader header{};
+		header.term_count = term_store.size();
+		out.write(reinterpret_cast<const char *>(&header), sizeof(DictionaryHeader));
+		for (std::size_t id = 1; id <= term_store.size(); ++id) {
+			const std::string identifier = term_store.identifier(rdf::TermStore::id_type(id));
+			const auto length = std::uint32_t(identifier.size());
+			out.write(reinterpret_cast<const char *>(&length), sizeof(length));
+			out.write(identifier.data(), identifier.size());
+		}
+		out.flush();
+		if (not out)
+			throw std::runtime_error{"Writing {} failed."_format(file_path)};
+	}
+
+	/**
+	 * Reads a dictionary side file into an empty TermStore. The terms get the ids they had when the file was written.
+	 * @throw std::invalid_argument the file is no dictionary or is corrupted
+	 */
+	inline void readDictionary(rdf::TermStore &term_store, const std::string &file_path) {
+		using Term = rdf_parser::store::rdf::Term;
+		util::MMapFile file{file_path};
+		if (file.size() < sizeof(DictionaryHeader))
+			throw std::invalid_argument{"{} is too small to be a dictionary."_format(file_path)};
+		DictionaryHeader header{};
+		std::memcpy(&header, file.data(), sizeof(DictionaryHeader));
+		if (header.magic != DictionaryHeader::expected_magic or header.version != DictionaryHeader::current_version)
+			throw std::invalid_argument{"{} is no dictionary of a supported version."_format(file_path)};
+		const char *pos = file.data() + sizeof(DictionaryHeader);
+		const char *const end = file.data() + file.size();
+		for (std::uint64_t id = 1; id <= header.term_count; ++id) {
+			std::uint32_t length;
+			if (std::size_t(end - pos) < sizeof(length))
+				throw std::invalid_argument{"{} is truncated."_format(file_path)};
+			std::memcpy(&length, pos, sizeof(length));
+			pos += sizeof(length);
+			if (std::size_t(end - pos) < length)
+				throw std::invalid_argument{"{} is truncated."_format(file_path)};
+			if (term_store[Term::make_term(std::string{pos, length})] != id)
+				throw std::invalid_argument{"{} contains a term twice."_format(file_path)};
+			pos += length;
+		}
+	}
+}
+
+#endif //TENTRIS_IDTRIPLEFILE_HPP
@@ -36,6 +36,8 @@ namespace tentris::store {
 
 		std::vector<Variable> variables{};
 
+		const rdf::TermStore &term_store;
+
 		struct JsonBindings {
 			Value count{};
 			std::string json{};
@@ -44,7 +46,12 @@ namespace tentris::store {
 		tsl::sparse_map<Key, JsonBindings, ::einsum::internal::KeyHash<key_part_type>> entries{};
 
 	public:
-		explicit JsonQueryResult(std::vector<Variable> variables) : variables(std::move(variables)) {
+		/**
+		 * @param variables the projected variables
+		 * @param term_store dictionary used to decode the ids in the results
+		 */
+		JsonQueryResult(std::vector<Variable> variables, const rdf::TermStore &term_store)
+				: variables(std::move(variables)), term_store(term_store) {
 			if (not this->variables.empty())
 				json_size += (this->variables.size() - 1); // for commata
 			json_size += (this->variables.size() * 2); // for quotation marks
@@ -66,7 +73,7 @@ namespace tentris::store {
 				result_count += new_count - old_count;
 			} else {
 				auto[iter, valid] = entries.emplace(entry.key,
-													JsonBindings{entry.value, key2jsonStr(entry.key, variables)});
+													JsonBindings{entry.value, key2jsonStr(entry.key)});
 				JsonBindings &bindings = iter.value();
 				auto size = calc_size(entry.value, bindings.json.size());
 				json_size += size;
@@ -79,14 +86,16 @@ namespace tentris::store {
 		}
 
 	private:
-		[[nodiscard]] static std::string key2jsonStr(const Key &key, const std::vector<Variable> &variables) {
+		[[nodiscard]] std::string key2jsonStr(const Key &key) const {
 			std::string json{};
 			json.reserve(variables.size() * 50);
 			json += "{";
 			bool firstKey = true;
-			for (const auto[term, var] : iter::zip(key, variables)) {
-				if (term == nullptr)
+			std::string inline_buffer{};
+			for (const auto[term_id, var] : iter::zip(key, variables)) {
+				if (term_id == rdf::TermStore::no_id)
 					continue;
+				const rdf::TermStore::TermParts term = term_store.parts(term_id, inline_buffer);
 				if (firstKey) {
 					firstKey = false;
 				} else {
@@ -95,7 +104,7 @@ namespace tentris::store {
 
 				json += '"' +  var.name + R"(":{)";
 
-				const Term::NodeType termType = term->type();
+				const Term::NodeType termType = term.type;
 				switch (termType) {
 					case Term::NodeType::URIRef_:
 						json += R"("type":"uri")";
@@ -111,13 +120,15 @@ namespace tentris::store {
 						assert(false);
 				}
 
-				json += fmt::format(R"(,"value":"{}")", escapeJsonString(term->value()));
+				json += R"(,"value":")";
+				json += escapeJsonString(term.value_prefix);
+				json += escapeJsonString(term.value);
+				json += '"';
 				if (termType == Term::NodeType::Literal_) {
-                    const Literal & literal_term = term->castLiteral();
-					if (literal_term.hasDataType())
-						json += fmt::format(R"(,"datatype":"{}")", literal_term.dataType());
-					else if (literal_term.hasLang())
-						json += fmt::format(R"(,"xml:lang":"{}")", literal_term.lang());
+					if (not term.datatype.empty())
+						json += fmt::format(R"(,"datatype":"{}")", term.datatype);
+					else if (not term.lang.empty())
+						json += fmt::format(R"(,"xml:lang":"{}")", term.lang);
 				}
 				json += '}';
 			}
@@ -0,0 +1,222 @@
+#ifndef TENTRIS_LOADPIPELINE_HPP
+#define TENTRIS_LOADPIPELINE_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "tentris/store/RDF/TermStore.hpp"
+#include "tentris/store/RDF/SerdParser.hpp"
+#include "tentris/store/RDF/NTriplesParser.hpp"
+#include "tentris/tensor/BoolHypertrie.hpp"
+#include "tentris/util/BlockingQueue.hpp"
+#include "tentris/util/LogHelper.hpp"
+
+namespace tentris::store {
+
+	namespace {
+		using namespace ::tentris::logging;
+		using namespace fmt::literals;
+	}
+
+	/**
+	 * Statistics about a finished load.
+	 */
+	struct LoadStats {
+		std::size_t triples = 0;
+		std::chrono::steady_clock::duration duration{};
+		/**
+		 * Waits between parser and encoders.
+		 */
+		util::sync::QueueStalls parse_stalls{};
+		/**
+		 * Waits between encoders and trie insertion.
+		 */
+		util::sync::QueueStalls encode_stalls{};
+
+		[[nodiscard]] double triplesPerSecond() const {
+			auto seconds = std::chrono::duration<double>(duration).count();
+			return (seconds > 0) ? double(triples) / seconds : 0.0;
+		}
+	};
+
+	/**
+	 * Loads an RDF file into a TermStore and a BoolHypertrie in three stages that are connected by bounded queues of
+	 * batches:
+	 * <ol>
+	 *     <li>parsing: N-Triples files (*.nt) are parsed by encode_threads NTriplesParser workers, everything else by
+	 *     serd (see BulkLoad). Both produce batches of Triples. Compressed files and stdin ("-") go through serd with
+	 *     decompression on another thread.</li>
+	 *     <li>dictionary encoding: encode_threads workers hash the terms of a batch and map them to their TermStore
+	 *     entries</li>
+	 *     <li>trie insertion: the calling thread writes the encoded triples into the hypertrie</li>
+	 * </ol>
+	 * The TermStore is sharded, so the encoders only contend when they insert into the same shard at the same time.
+	 */
+	class LoadPipeline {
+		using Term = rdf_parser::store::rdf::Term;
+		using Triple = rdf_parser::store::rdf::Triple;
+		using TermStore = rdf::TermStore;
+		using key_part_type = tensor::key_part_type;
+		using BoolHypertrie = tensor::BoolHypertrie;
+		using TripleBatch = rdf::BulkLoad::TripleBatch;
+		using TripleQueue = rdf::BulkLoad::queue_type;
+		using KeyBatch = std::vector<std::array<key_part_type, 3>>;
+		using KeyQueue = util::sync::BlockingQueue<KeyBatch>;
+
+		constexpr static std::size_t batches_per_worker = 4;
+
+		TermStore &term_store;
+		BoolHypertrie &trie;
+		std::size_t encode_threads;
+
+		std::mutex error_lock{};
+		std::exception_ptr error{};
+
+	public:
+		/**
+		 * @param term_store dictionary to encode the terms with
+		 * @param trie hypertrie the encoded triples are written to
+		 * @param encode_threads number of dictionary encoding workers. 0 is treated as 1.
+		 */
+		LoadPipeline(TermStore &term_store, BoolHypertrie &trie, std::size_t encode_threads)
+				: term_store(term_store), trie(trie), encode_threads((encode_threads == 0) ? 1 : encode_threads) {}
+
+		/**
+		 * Loads the file.
+		 * @param file_path RDF file
+		 * @return statistics about the load
+		 * @throws the first exception that was raised in any of the stages
+		 */
+		LoadStats run(const std::string &file_path) {
+			using namespace std::chrono;
+			const auto start = steady_clock::now();
+
+			std::shared_ptr<rdf::BulkLoad> bulk_load;
+			std::shared_ptr<rdf::NTriplesParser> ntriples_parser;
+			if (isNTriples(file_path))
+				ntriples_parser = rdf::NTriplesParser::parse(file_path, encode_threads);
+			else
+				bulk_load = rdf::BulkLoad::parse(file_path);
+			TripleQueue &triple_batches = (ntriples_parser) ? ntriples_parser->result_queue : bulk_load->result_queue;
+			KeyQueue key_batches{encode_threads * batches_per_worker};
+
+			std::atomic<std::size_t> running_encoders{encode_threads};
+			std::vector<std::thread> encoders{};
+			encoders.reserve(encode_threads);
+			for (std::size_t i = 0; i < encode_threads; ++i)
+				encoders.emplace_back([&]() {
+					encode(triple_batches, key_batches);
+					// the last encoder tells the insertion stage that no more input will arrive
+					if (running_encoders.fetch_sub(1) == 1)
+						key_batches.close();
+				});
+
+			LoadStats stats{};
+			std::size_t next_report = 1'000'000;
+			try {
+				while (auto batch = key_batches.pop()) {
+					for (const auto &[subject, predicate, object] : *batch)
+						trie.set({subject, predicate, object}, true);
+					stats.triples += batch->size();
+					if (stats.triples >= next_report) {
+						next_report += 1'000'000;
+						const auto duration = steady_clock::now() - start;
+						logDebug("{:d} mio triples loaded ({:.0f} triples/s)."_format(
+								stats.triples / 1'000'000, LoadStats{stats.triples, duration}.triplesPerSecond()));
+					}
+				}
+			} catch (...) {
+				fail(std::current_exception(), triple_batches, key_batches);
+			}
+
+			for (auto &encoder : encoders)
+				encoder.join();
+
+			if (error)
+				std::rethrow_exception(error);
+			if (ntriples_parser)
+				if (auto parse_error = ntriples_parser->error())
+					throw std::invalid_argument{"Failed to parse {}: {}"_format(file_path, *parse_error)};
+			if (bulk_load and bulk_load->input_error)
+				throw std::invalid_argument{*bulk_load->input_error};
+			if (bulk_load and bulk_load->status > SERD_FAILURE)
+				throw std::invalid_argument{"serd failed to parse {} (status {})."_format(file_path,
+																						 int(bulk_load->status))};
+
+			stats.duration = steady_clock::now() - start;
+			log("{} triples loaded with {} encoding threads in {} ({:.0f} triples/s)."_format(
+					stats.triples, encode_threads, toDurationStr(start, steady_clock::now()),
+					stats.triplesPerSecond()));
+			const auto parse_stalls = triple_batches.stalls();
+			const auto encode_stalls = key_batches.stalls();
+			logDebug("queue stalls: parser waited {} times for encoders, encoders waited {} times for parser, "
+					 "encoders waited {} times for insertion, insertion waited {} times for encoders."_format(
+					parse_stalls.producer_stalls, parse_stalls.consumer_stalls,
+					encode_stalls.producer_stalls, encode_stalls.consumer_stalls));
+			stats.parse_stalls = parse_stalls;
+			stats.encode_stalls = encode_stalls;
+			return stats;
+		}
+
+		/**
+		 * @return if the file is parsed with the parallel NTriplesParser
+		 */
+		static bool isNTriples(const std::string &file_path) {
+			constexpr std::string_view extension = ".nt";
+			return file_path.size() >= extension.size()
+				   and std::string_view{file_path}.substr(file_path.size() - extension.size()) == extension;
+		}
+
+	private:
+		void encode(TripleQueue &triple_batches, KeyQueue &key_batches) {
+			try {
+				while (auto batch = triple_batches.pop()) {
+					KeyBatch keys{};
+					keys.reserve(batch->size());
+					for (const Triple &triple : *batch) {
+						if (triple.subject().isLiteral() or not triple.predicate().isURIRef())
+							throw std::invalid_argument{
+									"Subject or predicate of the triple have a term type that is not allowed there."};
+						keys.push_back({encodeTerm(triple.subject()),
+										encodeTerm(triple.predicate()),
+										encodeTerm(triple.object())});
+					}
+					if (not key_batches.push(std::move(keys)))
+						return;
+				}
+			} catch (...) {
+				fail(std::current_exception(), triple_batches, key_batches);
+			}
+		}
+
+		key_part_type encodeTerm(const Term &term) {
+			// literals that are encoded inline need neither a hash nor the dictionary
+			if (auto inline_id = rdf::inline_literal::encode(term))
+				return *inline_id;
+			return term_store.insert(term, TermStore::hash(term));
+		}
+
+		/**
+		 * Records the first error and closes all queues so that every stage terminates.
+		 */
+		void fail(std::exception_ptr exception, TripleQueue &triple_batches, KeyQueue &key_batches) {
+			{
+				std::lock_guard<std::mutex> g{error_lock};
+				if (not error)
+					error = std::move(exception);
+			}
+			triple_batches.close();
+			key_batches.close();
+		}
+	};
+}
+
+#endif //TENTRIS_LOADPIPELINE_HPP
@@ -0,0 +1,199 @@
+#ifndef TENTRIS_PREPAREDQUERIES_HPP
+#define TENTRIS_PREPAREDQUERIES_HPP
+
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+#include <Dice/rdf_parser/RDF/Term.hpp>
+
+#include "tentris/store/AtomicQueryExecutionPackageCache.hpp"
+#include "tentris/store/QueryExecutionPackage.hpp"
+#include "tentris/store/SPARQL/NormalizedQuery.hpp"
+#include "tentris/store/SPARQL/QueryShape.hpp"
+
+namespace tentris::store {
+
+	namespace {
+		using namespace fmt::literals;
+	}
+
+	/**
+	 * A query that was parsed once and is executed with different values for its named parameters ($name variables
+	 * in its triple patterns, see NormalizedQuery).
+	 */
+	class PreparedQuery {
+		using Term = rdf_parser::store::rdf::Term;
+
+		std::string id;
+		std::shared_ptr<const sparql::QueryShape> query_shape;
+		std::vector<Term> constants;
+		/**
+		 * Named parameters ordered by their parameter number.
+		 */
+		std::vector<std::string> parameter_names{};
+
+	public:
+		PreparedQuery(std::string id, const sparql::NormalizedQuery &normalized_query,
+					  std::shared_ptr<const sparql::QueryShape> query_shape)
+				: id(std::move(id)), query_shape(std::move(query_shape)),
+				  constants(normalized_query.getParameters()) {
+			parameter_names.resize(normalized_query.getNamedParameters().size());
+			for (const auto &[name, parameter] : normalized_query.getNamedParameters())
+				parameter_names[parameter - constants.size()] = name;
+		}
+
+		/**
+		 * Creates the package to execute this query.
+		 * @param values the value of each named parameter
+		 * @param triple_store the store the query is executed on
+		 * @throw std::invalid_argument a value is missing
+		 */
+		[[nodiscard]] std::shared_ptr<cache::QueryExecutionPackage>
+		bind(const std::map<std::string, Term> &values, std::shared_ptr<TripleStore> triple_store) const {
+			std::vector<Term> parameters = constants;
+			for (const auto &name : parameter_names) {
+				const auto value = values.find(name);
+				if (value == values.end())
+					throw std::invalid_argument{"No value for parameter ${}."_format(name)};
+				parameters.push_back(value->second);
+			}
+			return std::make_shared<cache::QueryExecutionPackage>(query_shape, parameters, std::move(triple_store));
+		}
+
+		[[nodiscard]] const std::string &getId() const {
+			return id;
+		}
+
+		[[nodiscard]] const std::vector<std::string> &getParameterNames() const {
+			return parameter_names;
+		}
+	};
+
+	/**
+	 * Registry of prepared queries. Queries are identified by their shape and constants, so preparing the same query
+	 * again returns the same id instead of registering it twice. At most capacity queries are kept; when a further
+	 * one is prepared, the least recently prepared or executed one is dropped. Ids are random, so the id of a query
+	 * prepared by another client can not be guessed.
+	 */
+	class PreparedQueries {
+		struct Registered {
+			std::shared_ptr<const PreparedQuery> prepared;
+			std::string query_key;
+		};
+
+		using lru_type = std::list<Registered>;
+
+		mutable std::mutex mutex;
+		/**
+		 * Most recently used first.
+		 */
+		mutable lru_type lru{};
+		std::map<std::string, lru_type::iterator> by_id{};
+		std::map<std::string, lru_type::iterator> by_query{};
+		std::size_t capacity;
+		std::random_device random{};
+
+	public:
+		/**
+		 * @param capacity max number of prepared queries. 0 is treated as 1.
+		 */
+		explicit PreparedQueries(std::size_t capacity = 1'000) : capacity((capacity == 0) ? 1 : capacity) {}
+
+		/**
+		 * Parses a query and registers it.
+		 * @param sparql_string a query with named parameters
+		 * @return the prepared query
+		 * @throw std::invalid_argument the query was not parsable
+		 */
+		std::shared_ptr<const PreparedQuery> prepare(const std::string &sparql_string) {
+			sparql::NormalizedQuery normalized_query{sparql_string, true};
+			std::string query_key = normalized_query.getShape();
+			for (const auto &constant : normalized_query.getParameters())
+				query_key += "\n{}"_format(constant.getIdentifier());
+
+			std::lock_guard<std::mutex> lock(mutex);
+			if (auto found = by_query.find(query_key); found != by_query.end()) {
+				lru.splice(lru.begin(), lru, found->second);
+				return found->second->prepared;
+			}
+			// parsing while holding the lock is fine, preparing is rare compared to executing
+			auto query_shape = AtomicQueryExecutionCache::getInstance().getShape(normalized_query.getShape());
+			auto prepared = std::make_shared<const PreparedQuery>(newId(), normalized_query, std::move(query_shape));
+			lru.push_front(Registered{prepared, query_key});
+			by_id[prepared->getId()] = lru.begin();
+			by_query[std::move(query_key)] = lru.begin();
+			if (lru.size() > capacity)
+				erase(std::prev(lru.end()));
+			return prepared;
+		}
+
+		/**
+		 * @return the prepared query or nullptr if no query has this id
+		 */
+		std::shared_ptr<const PreparedQuery> find(const std::string &id) {
+			std::lock_guard<std::mutex> lock(mutex);
+			if (auto found = by_id.find(id); found != by_id.end()) {
+				lru.splice(lru.begin(), lru, found->second);
+				return found->second->prepared;
+			}
+			return {};
+		}
+
+		/**
+		 * Drops a prepared query. Executions that already found it finish normally.
+		 * @return if a query had this id
+		 */
+		bool remove(const std::string &id) {
+			std::lock_guard<std::mutex> lock(mutex);
+			if (auto found = by_id.find(id); found != by_id.end()) {
+				erase(found->second);
+				return true;
+			}
+			return false;
+		}
+
+		/**
+		 * @return number of prepared queries
+		 */
+		[[nodiscard]] std::size_t size() const {
+			std::lock_guard<std::mutex> lock(mutex);
+			return lru.size();
+		}
+
+	private:
+		/**
+		 * Requires the lock.
+		 */
+		void erase(lru_type::iterator registered) {
+			by_id.erase(registered->prepared->getId());
+			by_query.erase(registered->query_key);
+			lru.erase(registered);
+		}
+
+		/**
+		 * Requires the lock.
+		 * @return 128 random bits as hex string
+		 */
+		std::string newId() {
+			std::string id{};
+			do {
+				id.clear();
+				for (int i = 0; i < 4; ++i)
+					id += "{:08x}"_format(std::uint32_t(random()));
+			} while (by_id.count(id) != 0);
+			return id;
+		}
+	};
+}
+
+#endif //TENTRIS_PREPAREDQUERIES_HPP
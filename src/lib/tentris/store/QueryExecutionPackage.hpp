@@ -7,8 +7,11 @@
 
 #include "tentris/store/RDF/TermStore.hpp"
 #include "tentris/store/AtomicTripleStore.hpp"
-#include "tentris/store/SPARQL/ParsedSPARQL.hpp"
+#include "tentris/store/SPARQL/NormalizedQuery.hpp"
+#include "tentris/store/SPARQL/QueryShape.hpp"
 #include "tentris/tensor/BoolHypertrie.hpp"
+#include "tentris/tensor/PlannerOptions.hpp"
+#include "tentris/tensor/PlannerOptionsLock.hpp"
 
 namespace tentris::store {
 	class TripleStore;
@@ -23,14 +26,12 @@ namespace tentris::store::cache {
 
 	/**
 	 * A QueryExecutionPackage contains everything that is necessary to execute a given sparql query for a state of the
-	 * RDF graph.
+	 * RDF graph. The parsed query is shared by all queries of the same QueryShape; only the operands are resolved per
+	 * query.
 	 */
 	struct QueryExecutionPackage {
 	private:
-		std::string sparql_string;
-		std::shared_ptr<Subscript> subscript;
-		SelectModifier select_modifier;
-		std::vector<Variable> query_variables;
+		std::shared_ptr<const QueryShape> query_shape;
 
 	public:
 		/**
@@ -41,6 +42,10 @@ namespace tentris::store::cache {
 		bool is_trivial_empty = false;
 
 	private:
+		/**
+		 * The store the operands were resolved in. Keeps it alive if it is replaced while the query runs.
+		 */
+		std::shared_ptr<TripleStore> triple_store;
 
 		std::vector<const_BoolHypertrie> operands{};
 
@@ -48,22 +53,25 @@ namespace tentris::store::cache {
 		QueryExecutionPackage() = delete;
 
 		/**
-		 *
+		 * Parses a query without caching its shape.
 		 * @param sparql_string sparql query to be parsed
-		 * @param trie current try holding the data
-		 * @param termIndex term store attached to the trie
 		 * @throw std::invalid_argument the sparql query was not parsable
 		 */
-		explicit QueryExecutionPackage(const std::string &sparql_string) : sparql_string{sparql_string} {
-			ParsedSPARQL parsed_sparql{sparql_string};
-			subscript = parsed_sparql.getSubscript();
-			select_modifier = parsed_sparql.getSelectModifier();
-			query_variables = parsed_sparql.getQueryVariables();
-
-			auto &triple_store = AtomicTripleStore::getInstance();
+		explicit QueryExecutionPackage(const std::string &sparql_string) : QueryExecutionPackage(
+				NormalizedQuery{sparql_string}, AtomicTripleStore::pin()) {}
 
-			for (const auto &tp: parsed_sparql.getBgps()) {
-				std::variant<std::optional<const_BoolHypertrie>, bool> op = triple_store.resolveTriplePattern(tp);
+		/**
+		 * @param query_shape the parsed shape of the query
+		 * @param parameters the constants of the query
+		 * @param triple_store the store the query is executed on
+		 * @throw std::invalid_argument the parameters do not match the shape
+		 */
+		QueryExecutionPackage(std::shared_ptr<const QueryShape> query_shape,
+							  const std::vector<rdf_parser::store::rdf::Term> &parameters,
+							  std::shared_ptr<TripleStore> triple_store)
+				: query_shape{std::move(query_shape)}, triple_store{std::move(triple_store)} {
+			for (const auto &tp: this->query_shape->bind(parameters)) {
+				std::variant<std::optional<const_BoolHypertrie>, bool> op = this->triple_store->resolveTriplePattern(tp);
 				if (std::holds_alternative<bool>(op)) {
 					is_trivial_empty = not std::get<bool>(op);
 				} else {
@@ -80,45 +88,91 @@ namespace tentris::store::cache {
 		}
 
 	private:
+		QueryExecutionPackage(const NormalizedQuery &normalized_query, std::shared_ptr<TripleStore> triple_store)
+				: QueryExecutionPackage(std::make_shared<const QueryShape>(normalized_query.getShape()),
+										normalized_query.getParameters(), std::move(triple_store)) {}
+
+		/**
+		 * An Einsum together with the guard of its heuristic. The guard is released after the Einsum is destroyed.
+		 */
+		template<typename RESULT_TYPE>
+		struct GuardedEinsum {
+			PlannerOptionsLock::Guard guard;
+			Einsum<RESULT_TYPE> einsum;
+
+			GuardedEinsum(PlannerOptionsLock::Guard guard, const std::shared_ptr<Subscript> &subscript,
+						  const std::vector<const_BoolHypertrie> &hypertries, const time_point_t &timeout)
+					: guard(std::move(guard)), einsum(subscript, hypertries, timeout) {}
+		};
+
 		/**
 		 * Builds the operator tree for this query.
 		 * @tparam RESULT_TYPE the type returned by the operand tree
-		 * @param slice_keys slice keys to extract the operands from the hypertries. slice_keys and hypertries must be
-		 * of equal length.
 		 * @param subscript the subscript that spans the operator tree.
 		 * @param hypertries a list of hypertries. typically this is a list containing the data base hypertrie multiple
 		 * times.
-		 * @return
+		 * @param timeout the time at which the evaluation is stopped
+		 * @param guard the join order heuristic
+		 * @return the Einsum
 		 */
 		template<typename RESULT_TYPE>
 		static std::shared_ptr<void> generateEinsum(const std::shared_ptr<Subscript> &subscript,
 													const std::vector<const_BoolHypertrie> &hypertries,
-													const time_point_t &timeout) {
-			return std::make_shared<Einsum<RESULT_TYPE>>(subscript, hypertries, timeout);
+													const time_point_t &timeout, PlannerOptionsLock::Guard guard) {
+			auto guarded = std::make_shared<GuardedEinsum<RESULT_TYPE>>(std::move(guard), subscript, hypertries,
+																		timeout);
+			// the returned pointer shares the ownership of the guard
+			return std::shared_ptr<void>(guarded, &guarded->einsum);
 		}
 
 	public:
-		std::shared_ptr<void> getEinsum(const time_point_t &timeout = time_point_t::max()) const {
-			if (select_modifier == SelectModifier::NONE)
-				return generateEinsum<COUNTED_t>(subscript, operands, timeout);
+		/**
+		 * Builds the Einsum of the query. As long as it exists, the globals of the hypertrie hold its heuristic and
+		 * queries with other heuristics wait, see PlannerOptionsLock. So release it as soon as it is iterated.
+		 * @param timeout the time at which the evaluation is stopped
+		 * @param planner_options the join order heuristic of this query
+		 * @return the Einsum<COUNTED_t> or Einsum<DISTINCT_t> that evaluates the query, or nullptr if the timeout passed
+		 * while queries with another heuristic were running
+		 */
+		std::shared_ptr<void> getEinsum(const time_point_t &timeout = time_point_t::max(),
+										const PlannerOptions &planner_options = {}) const {
+			auto guard = PlannerOptionsLock::getInstance().acquire(planner_options, timeout);
+			if (not guard)
+				return nullptr;
+			return getEinsum(std::move(*guard), timeout);
+		}
+
+		/**
+		 * Like getEinsum(timeout, planner_options), for a heuristic that the caller acquired already.
+		 * @param guard the join order heuristic of this query
+		 * @param timeout the time at which the evaluation is stopped
+		 * @return the Einsum<COUNTED_t> or Einsum<DISTINCT_t> that evaluates the query
+		 */
+		std::shared_ptr<void> getEinsum(PlannerOptionsLock::Guard guard, const time_point_t &timeout) const {
+			if (getSelectModifier() == SelectModifier::NONE)
+				return generateEinsum<COUNTED_t>(getSubscript(), operands, timeout, std::move(guard));
 			else
-				return generateEinsum<DISTINCT_t>(subscript, operands, timeout);
+				return generateEinsum<DISTINCT_t>(getSubscript(), operands, timeout, std::move(guard));
+		}
+
+		const std::shared_ptr<TripleStore> &getTripleStore() const {
+			return triple_store;
 		}
 
-		const std::string &getSparqlStr() const {
-			return sparql_string;
+		const std::shared_ptr<const QueryShape> &getQueryShape() const {
+			return query_shape;
 		}
 
 		const std::shared_ptr<Subscript> &getSubscript() const {
-			return subscript;
+			return query_shape->getSubscript();
 		}
 
 		SelectModifier getSelectModifier() const {
-			return select_modifier;
+			return query_shape->getSelectModifier();
 		}
 
 		const std::vector<Variable> &getQueryVariables() const {
-			return query_variables;
+			return query_shape->getQueryVariables();
 		}
 
 		friend struct ::fmt::formatter<QueryExecutionPackage>;
@@ -133,12 +187,12 @@ struct fmt::formatter<tentris::store::cache::QueryExecutionPackage> {
 	template<typename FormatContext>
 	auto format(const tentris::store::cache::QueryExecutionPackage &p, FormatContext &ctx) {
 		return format_to(ctx.begin(),
-						 " SPARQL:     {}\n"
+						 " shape:      {}\n"
 						 " subscript:  {}\n"
 						 " is_distinct:      {}\n"
 						 " is_trivial_empty: {}\n",
-						 p.sparql_string, p.subscript, p.select_modifier == SelectModifier::DISTINCT,
-						 p.is_trivial_empty);
+						 p.query_shape->getShapeStr(), p.getSubscript(),
+						 p.getSelectModifier() == SelectModifier::DISTINCT, p.is_trivial_empty);
 	}
 };
 
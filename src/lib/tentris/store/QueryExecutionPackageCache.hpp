@@ -3,11 +3,78 @@
 #define TENTRIS_PARSEDSPARQLCACHES_HPP
 
 #include "tentris/store/QueryExecutionPackage.hpp"
-#include "tentris/util/SyncedLRUCache.hpp"
+#include "tentris/store/SPARQL/NormalizedQuery.hpp"
+#include "tentris/store/SPARQL/QueryShape.hpp"
+#include "tentris/util/ShardedClockCache.hpp"
 #include <memory>
 
 namespace tentris::store::cache {
-	using QueryExecutionPackage_cache = util::sync::SyncedLRUCache<std::string, QueryExecutionPackage>;
+
+	/**
+	 * Creates QueryExecutionPackages from a cache of parsed QueryShapes. Queries that differ only in their constants,
+	 * whitespace or prefixes share a shape (see NormalizedQuery), so they are parsed once. Per query, only the
+	 * operands are resolved. The shapes do not depend on the stored data and stay valid across updates and reloads.
+	 */
+	class QueryExecutionPackage_cache {
+		using QueryShape_cache = util::sync::ShardedClockCache<std::string, QueryShape>;
+
+		QueryShape_cache shapes;
+
+	public:
+		/**
+		 * See ShardedClockCache.
+		 */
+		explicit QueryExecutionPackage_cache(std::size_t max_size = 1000, std::size_t max_bytes = 0,
+											 util::sync::AdmissionPolicy admission = util::sync::AdmissionPolicy::ALWAYS)
+				: shapes(max_size, max_bytes, admission) {}
+
+		/**
+		 * @param sparql_string a sparql query
+		 * @param triple_store the store the query is executed on
+		 * @return the package of the query
+		 * @throw std::invalid_argument the sparql query was not parsable
+		 */
+		std::shared_ptr<QueryExecutionPackage> get(const std::string &sparql_string,
+												   std::shared_ptr<TripleStore> triple_store) {
+			NormalizedQuery normalized_query{sparql_string};
+			return std::make_shared<QueryExecutionPackage>(getShape(normalized_query.getShape()),
+														   normalized_query.getParameters(), std::move(triple_store));
+		}
+
+		/**
+		 * @param shape_string a query shape, see NormalizedQuery::getShape()
+		 * @return the parsed shape
+		 * @throw std::invalid_argument the shape was not parsable
+		 */
+		std::shared_ptr<const QueryShape> getShape(const std::string &shape_string) {
+			return shapes[shape_string];
+		}
+
+		/**
+		 * @param sparql_string a sparql query
+		 * @return the package of the query for the current store
+		 * @throw std::invalid_argument the sparql query was not parsable
+		 */
+		std::shared_ptr<QueryExecutionPackage> operator[](const std::string &sparql_string) {
+			return get(sparql_string, AtomicTripleStore::pin());
+		}
+
+		void clear() {
+			shapes.clear();
+		}
+
+		[[nodiscard]] std::size_t size() const {
+			return shapes.size();
+		}
+
+		[[nodiscard]] std::size_t getMaxSize() const {
+			return shapes.getMaxSize();
+		}
+
+		[[nodiscard]] util::sync::CacheStats stats() const {
+			return shapes.stats();
+		}
+	};
 
 } // namespace tentris::store::cache
 
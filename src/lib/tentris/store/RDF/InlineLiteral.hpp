@@ -0,0 +1,300 @@
+#ifndef TENTRIS_INLINELITERAL_HPP
+#define TENTRIS_INLINELITERAL_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <Dice/rdf_parser/RDF/Term.hpp>
+
+namespace tentris::store::rdf::inline_literal {
+
+	/**
+	 * Tagged ids for literals whose value fits into the id itself. Such literals never enter the TermStore.
+	 *
+	 * Layout of a 32 bit id:
+	 * <pre>
+	 * bit 31      1 = inline literal, 0 = dictionary id
+	 * bits 29-30  tag (xsd:integer, xsd:boolean, xsd:date, xsd:double)
+	 * bits 0-28   payload
+	 * </pre>
+	 * Integers and dates are stored with a bias, so within one tag the payloads are ordered like the values.
+	 *
+	 * Only literals in canonical lexical form are inlined, e.g. "42"^^xsd:integer but not "042"^^xsd:integer. That
+	 * way decoding reproduces exactly the term that was encoded, and distinct RDF terms keep distinct ids.
+	 */
+	using id_type = std::uint32_t;
+
+	constexpr id_type inline_flag = id_type(1) << 31;
+	constexpr unsigned tag_shift = 29;
+	constexpr id_type tag_mask = id_type(3) << tag_shift;
+	constexpr id_type payload_mask = (id_type(1) << tag_shift) - 1;
+	/**
+	 * Integers and dates are stored as value + bias.
+	 */
+	constexpr std::int64_t bias = std::int64_t(1) << (tag_shift - 1);
+	constexpr std::int64_t min_value = -bias;
+	constexpr std::int64_t max_value = bias - 1;
+
+	enum struct Tag : id_type {
+		integer = 0,
+		boolean = 1,
+		date = 2,
+		double_ = 3
+	};
+
+	constexpr std::string_view xsd_integer = "http://www.w3.org/2001/XMLSchema#integer";
+	constexpr std::string_view xsd_boolean = "http://www.w3.org/2001/XMLSchema#boolean";
+	constexpr std::string_view xsd_date = "http://www.w3.org/2001/XMLSchema#date";
+	constexpr std::string_view xsd_double = "http://www.w3.org/2001/XMLSchema#double";
+
+	constexpr bool isInline(id_type id) {
+		return (id & inline_flag) != 0;
+	}
+
+	constexpr Tag tag(id_type id) {
+		return Tag((id & tag_mask) >> tag_shift);
+	}
+
+	constexpr id_type payload(id_type id) {
+		return id & payload_mask;
+	}
+
+	constexpr id_type make(Tag tag, id_type payload) {
+		return inline_flag | (id_type(tag) << tag_shift) | (payload & payload_mask);
+	}
+
+	namespace detail {
+		// days since 1970-01-01 of a date in the proleptic gregorian calendar (H. Hinnant, chrono-compatible)
+		constexpr std::int64_t daysFromCivil(std::int64_t y, unsigned m, unsigned d) {
+			y -= m <= 2;
+			const std::int64_t era = (y >= 0 ? y : y - 399) / 400;
+			const auto yoe = unsigned(y - era * 400);
+			const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+			const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+			return era * 146097 + std::int64_t(doe) - 719468;
+		}
+
+		inline void civilFromDays(std::int64_t z, std::int64_t &y, unsigned &m, unsigned &d) {
+			z += 719468;
+			const std::int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+			const auto doe = unsigned(z - era * 146097);
+			const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+			const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+			const unsigned mp = (5 * doy + 2) / 153;
+			d = doy - (153 * mp + 2) / 5 + 1;
+			m = mp < 10 ? mp + 3 : mp - 9;
+			y = std::int64_t(yoe) + era * 400 + (m <= 2);
+		}
+
+		constexpr bool isLeapYear(std::int64_t y) {
+			return (y % 4 == 0 and y % 100 != 0) or y % 400 == 0;
+		}
+
+		constexpr unsigned daysInMonth(std::int64_t y, unsigned m) {
+			constexpr unsigned days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+			return (m == 2 and isLeapYear(y)) ? 29 : days[m - 1];
+		}
+
+		inline bool isDigit(char c) {
+			return c >= '0' and c <= '9';
+		}
+
+		inline std::optional<id_type> encodeInteger(std::string_view lexical) {
+			// canonical: optional '-', no leading zeros, no "-0"
+			bool negative = not lexical.empty() and lexical.front() == '-';
+			std::string_view digits = lexical.substr(negative ? 1 : 0);
+			if (digits.empty() or digits.size() > 10 or (digits.size() > 1 and digits.front() == '0')
+				or (negative and digits == "0"))
+				return std::nullopt;
+			std::int64_t value = 0;
+			for (char c : digits) {
+				if (not isDigit(c))
+					return std::nullopt;
+				value = value * 10 + (c - '0');
+			}
+			if (negative)
+				value = -value;
+			if (value < min_value or value > max_value)
+				return std::nullopt;
+			return make(Tag::integer, id_type(value + bias));
+		}
+
+		inline std::optional<id_type> encodeDate(std::string_view lexical) {
+			// canonical without timezone: YYYY-MM-DD with a four digit year
+			if (lexical.size() != 10 or lexical[4] != '-' or lexical[7] != '-')
+				return std::nullopt;
+			for (auto pos : {0, 1, 2, 3, 5, 6, 8, 9})
+				if (not isDigit(lexical[pos]))
+					return std::nullopt;
+			auto number = [&](std::size_t pos, std::size_t len) {
+				unsigned value = 0;
+				for (std::size_t i = pos; i < pos + len; ++i)
+					value = value * 10 + unsigned(lexical[i] - '0');
+				return value;
+			};
+			const std::int64_t year = number(0, 4);
+			const unsigned month = number(5, 2);
+			const unsigned day = number(8, 2);
+			if (year == 0 or month == 0 or month > 12 or day == 0 or day > daysInMonth(year, month))
+				return std::nullopt;
+			const std::int64_t days = daysFromCivil(year, month, day);
+			if (days < min_value or days > max_value)
+				return std::nullopt;
+			return make(Tag::date, id_type(days + bias));
+		}
+
+		/**
+		 * Canonical lexical form of an xsd:double, e.g. 1.5E2, -1.0E-3, 0.0E0, INF or NaN. The mantissa is the
+		 * shortest decimal that reads back as the same value.
+		 */
+		inline std::string canonicalDouble(double value) {
+			if (std::isnan(value))
+				return "NaN";
+			if (std::isinf(value))
+				return (value > 0) ? "INF" : "-INF";
+			if (value == 0.0)
+				return std::signbit(value) ? "-0.0E0" : "0.0E0";
+			char buffer[32];
+			for (int precision = 0; precision < 17; ++precision) {
+				std::snprintf(buffer, sizeof(buffer), "%.*e", precision, value);
+				if (std::strtod(buffer, nullptr) == value)
+					break;
+			}
+			// buffer is "[-]d[.ddd]e[+-]xx"
+			std::string_view printed{buffer};
+			const auto e_pos = printed.find('e');
+			std::string_view mantissa = printed.substr(0, e_pos);
+			const int exponent = std::atoi(buffer + e_pos + 1);
+			std::string result{mantissa};
+			if (result.find('.') == std::string::npos)
+				result += ".0";
+			else
+				while (result.back() == '0' and result[result.size() - 2] != '.')
+					result.pop_back();
+			result += 'E';
+			result += std::to_string(exponent);
+			return result;
+		}
+
+		inline std::optional<id_type> encodeDouble(std::string_view lexical) {
+			if (lexical.empty() or lexical.size() > 31)
+				return std::nullopt;
+			// strtod needs a null-terminated string
+			char buffer[32];
+			std::memcpy(buffer, lexical.data(), lexical.size());
+			buffer[lexical.size()] = '\0';
+			char *end;
+			const double value = std::strtod(buffer, &end);
+			if (end != buffer + lexical.size() or std::isnan(value))
+				return std::nullopt;
+			// the value must survive the round trip through a float with the 3 lowest mantissa bits cleared
+			const auto as_float = float(value);
+			if (double(as_float) != value)
+				return std::nullopt;
+			id_type bits;
+			std::memcpy(&bits, &as_float, sizeof(bits));
+			if ((bits & 7) != 0)
+				return std::nullopt;
+			if (canonicalDouble(value) != lexical)
+				return std::nullopt;
+			return make(Tag::double_, bits >> 3);
+		}
+	}
+
+	/**
+	 * Encodes a literal inline if possible.
+	 * @param term any term
+	 * @return the tagged id or std::nullopt if the term must be stored in the TermStore
+	 */
+	inline std::optional<id_type> encode(const rdf_parser::store::rdf::Term &term) {
+		if (not term.isLiteral())
+			return std::nullopt;
+		const auto &literal = term.castLiteral();
+		if (not literal.hasDataType())
+			return std::nullopt;
+		const std::string_view datatype = literal.dataType();
+		const std::string_view lexical = literal.value();
+		if (datatype == xsd_integer)
+			return detail::encodeInteger(lexical);
+		if (datatype == xsd_boolean) {
+			if (lexical == "true")
+				return make(Tag::boolean, 1);
+			if (lexical == "false")
+				return make(Tag::boolean, 0);
+			return std::nullopt;
+		}
+		if (datatype == xsd_date)
+			return detail::encodeDate(lexical);
+		if (datatype == xsd_double)
+			return detail::encodeDouble(lexical);
+		return std::nullopt;
+	}
+
+	/**
+	 * @param id an inline id
+	 * @return canonical lexical form of the literal
+	 */
+	inline std::string lexicalForm(id_type id) {
+		const id_type value = payload(id);
+		switch (tag(id)) {
+			case Tag::integer:
+				return std::to_string(std::int64_t(value) - bias);
+			case Tag::boolean:
+				return value ? "true" : "false";
+			case Tag::date: {
+				std::int64_t year;
+				unsigned month, day;
+				detail::civilFromDays(std::int64_t(value) - bias, year, month, day);
+				char buffer[16];
+				std::snprintf(buffer, sizeof(buffer), "%04lld-%02u-%02u", static_cast<long long>(year), month, day);
+				return buffer;
+			}
+			case Tag::double_: {
+				const id_type bits = value << 3;
+				float as_float;
+				std::memcpy(&as_float, &bits, sizeof(as_float));
+				return detail::canonicalDouble(double(as_float));
+			}
+		}
+		return {};
+	}
+
+	/**
+	 * @param id an inline id
+	 * @return datatype IRI of the literal
+	 */
+	inline std::string_view datatype(id_type id) {
+		switch (tag(id)) {
+			case Tag::integer:
+				return xsd_integer;
+			case Tag::boolean:
+				return xsd_boolean;
+			case Tag::date:
+				return xsd_date;
+			case Tag::double_:
+				return xsd_double;
+		}
+		return {};
+	}
+
+	/**
+	 * @param id an inline id
+	 * @return N-Triples identifier of the literal, e.g. "42"^^&lt;http://www.w3.org/2001/XMLSchema#integer&gt;
+	 */
+	inline std::string identifier(id_type id) {
+		std::string result{"\""};
+		result += lexicalForm(id);
+		result += "\"^^<";
+		result += datatype(id);
+		result += '>';
+		return result;
+	}
+}
+
+#endif //TENTRIS_INLINELITERAL_HPP
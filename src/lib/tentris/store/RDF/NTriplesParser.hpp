@@ -0,0 +1,536 @@
+#ifndef TENTRIS_NTRIPLESPARSER_HPP
+#define TENTRIS_NTRIPLESPARSER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <fmt/format.h>
+#include <Dice/rdf_parser/RDF/Triple.hpp>
+#include <Dice/rdf_parser/RDF/Term.hpp>
+
+#include "tentris/store/RDF/SerdParser.hpp"
+#include "tentris/util/BlockingQueue.hpp"
+#include "tentris/util/MMapFile.hpp"
+
+namespace tentris::store::rdf {
+
+	namespace {
+		using namespace fmt::literals;
+	}
+
+	/**
+	 * Parallel parser for N-Triples files. The file is memory-mapped and cut into chunks that end at line boundaries.
+	 * Worker threads take chunks one after another and parse them into batches of Triples. The batches are handed over
+	 * through the same kind of queue as BulkLoad uses, so the consumers do not care which parser produced them. The
+	 * order of the batches is not the order of the file.
+	 *
+	 * The Terms are built like BulkLoad builds them from serd nodes: escape sequences are resolved and literals are
+	 * split into value, language tag and datatype. Blank node labels are renamed like serd renames them in Turtle:
+	 * serd generates labels b1, b2, ... for anonymous blank nodes, so a label of a 'b' followed by a digit becomes
+	 * 'B' followed by the digit. Files that use both kinds of labels are rejected, as serd rejects them. IRIs and
+	 * blank node labels are checked against the characters that serd accepts.
+	 */
+	class NTriplesParser {
+		using Term = rdf_parser::store::rdf::Term;
+		using Triple = rdf_parser::store::rdf::Triple;
+		using URIRef = rdf_parser::store::rdf::URIRef;
+		using BNode = rdf_parser::store::rdf::BNode;
+		using Literal = rdf_parser::store::rdf::Literal;
+
+	public:
+		using TripleBatch = BulkLoad::TripleBatch;
+		using queue_type = BulkLoad::queue_type;
+
+		constexpr static std::size_t batch_size = BulkLoad::batch_size;
+		/**
+		 * Chunks per worker. More chunks balance the load better when lines differ in length.
+		 */
+		constexpr static std::size_t chunks_per_worker = 16;
+
+		/**
+		 * Batches of parsed triples. The queue is closed when all workers are done or one failed.
+		 * Closing it from the consumer side stops the workers.
+		 */
+		queue_type result_queue;
+
+	private:
+		util::MMapFile file;
+		std::vector<std::string_view> chunks{};
+		std::atomic<std::size_t> next_chunk{0};
+		std::atomic<std::size_t> running_workers{0};
+		/**
+		 * If a blank node label b<digit>... was renamed.
+		 */
+		std::atomic<bool> renamed_labels{false};
+		/**
+		 * If a blank node label is B<digit>... in the file. Together with renamed ones, such labels would clash.
+		 */
+		std::atomic<bool> upper_case_labels{false};
+
+		mutable std::mutex error_lock{};
+		std::optional<std::string> error_{};
+
+	public:
+		NTriplesParser(const std::string &file_path, std::size_t workers)
+				: result_queue{workers * 4}, file{file_path} {
+			split(workers * chunks_per_worker);
+		}
+
+		/**
+		 * Starts parsing in the background.
+		 * @param file_path N-Triples file
+		 * @param workers number of parsing threads. 0 is treated as 1.
+		 * @return the parser. Its result_queue delivers the triples.
+		 * @throw std::runtime_error the file could not be mapped
+		 */
+		static std::shared_ptr<NTriplesParser> parse(const std::string &file_path, std::size_t workers) {
+			if (workers == 0)
+				workers = 1;
+			auto parser = std::make_shared<NTriplesParser>(file_path, workers);
+			parser->running_workers = workers;
+			for (std::size_t i = 0; i < workers; ++i) {
+				std::thread t([parser]() {
+					parser->work();
+					// the last worker tells the consumers that no more input will arrive
+					if (parser->running_workers.fetch_sub(1) == 1) {
+						if (parser->renamed_labels and parser->upper_case_labels)
+							parser->setError("found both `b' and `B' blank IDs, prefix required");
+						parser->result_queue.close();
+					}
+				});
+				t.detach();
+			}
+			return parser;
+		}
+
+		/**
+		 * @return the first syntax error. Valid after result_queue was closed by the parser.
+		 */
+		[[nodiscard]] std::optional<std::string> error() const {
+			std::lock_guard<std::mutex> g{error_lock};
+			return error_;
+		}
+
+		/**
+		 * Parses a single line.
+		 * @param line a line without the line break
+		 * @return the triple or std::nullopt if the line is empty or a comment
+		 * @throw std::invalid_argument the line is no valid N-Triples statement
+		 */
+		static std::optional<Triple> parseLine(std::string_view line) {
+			LineParser parser{line};
+			return parser.parse();
+		}
+
+	private:
+		void split(std::size_t chunk_count) {
+			const std::string_view content = file.view();
+			const std::size_t target_size = std::max<std::size_t>(content.size() / chunk_count, 1);
+			std::size_t begin = 0;
+			while (begin < content.size()) {
+				std::size_t end = std::min(begin + target_size, content.size());
+				// move the end behind the next line break
+				if (end < content.size()) {
+					end = content.find('\n', end);
+					end = (end == std::string_view::npos) ? content.size() : end + 1;
+				}
+				chunks.push_back(content.substr(begin, end - begin));
+				begin = end;
+			}
+		}
+
+		void setError(std::string message) {
+			std::lock_guard<std::mutex> g{error_lock};
+			if (not error_)
+				error_ = std::move(message);
+		}
+
+		void work() {
+			TripleBatch batch{};
+			batch.reserve(batch_size);
+			bool renamed = false;
+			bool upper_case = false;
+			try {
+				for (std::size_t chunk = next_chunk++; chunk < chunks.size(); chunk = next_chunk++) {
+					const std::string_view content = chunks[chunk];
+					std::size_t line_begin = 0;
+					while (line_begin < content.size()) {
+						auto line_end = content.find('\n', line_begin);
+						if (line_end == std::string_view::npos)
+							line_end = content.size();
+						std::string_view line = content.substr(line_begin, line_end - line_begin);
+						if (not line.empty() and line.back() == '\r')
+							line.remove_suffix(1);
+						try {
+							LineParser parser{line};
+							if (auto triple = parser.parse())
+								batch.push_back(std::move(*triple));
+							renamed |= parser.renamed_label;
+							upper_case |= parser.upper_case_label;
+						} catch (const std::invalid_argument &e) {
+							throw std::invalid_argument{"{} at byte {}: {}"_format(
+									e.what(), (line.data() - file.data()), line)};
+						}
+						line_begin = line_end + 1;
+						if (batch.size() == batch_size) {
+							// fails if the consumer closed the queue
+							if (not result_queue.push(std::move(batch)))
+								return;
+							batch = TripleBatch{};
+							batch.reserve(batch_size);
+						}
+					}
+				}
+				if (not batch.empty())
+					result_queue.push(std::move(batch));
+			} catch (const std::exception &e) {
+				setError(e.what());
+				result_queue.close();
+			}
+			if (renamed)
+				renamed_labels = true;
+			if (upper_case)
+				upper_case_labels = true;
+		}
+
+		/**
+		 * Recursive descent over a single line of N-Triples.
+		 */
+		class LineParser {
+			std::string_view line;
+			std::size_t pos = 0;
+
+		public:
+			/**
+			 * If a blank node label b<digit>... was renamed to B<digit>...
+			 */
+			bool renamed_label = false;
+			/**
+			 * If a blank node label is B<digit>... in the line.
+			 */
+			bool upper_case_label = false;
+
+			explicit LineParser(std::string_view line) : line(line) {}
+
+			std::optional<Triple> parse() {
+				skipWhitespace();
+				if (done() or peek() == '#')
+					return std::nullopt;
+				Term subject = (peek() == '<') ? Term{iri()} : Term{blankNode()};
+				skipWhitespace();
+				Term predicate = iri();
+				skipWhitespace();
+				Term object;
+				switch (peek()) {
+					case '<':
+						object = iri();
+						break;
+					case '_':
+						object = blankNode();
+						break;
+					case '"':
+						object = literal();
+						break;
+					default:
+						fail("expected an object");
+				}
+				skipWhitespace();
+				expect('.');
+				skipWhitespace();
+				if (not done() and peek() != '#')
+					fail("unexpected content after the statement");
+				return Triple{std::move(subject), std::move(predicate), std::move(object)};
+			}
+
+		private:
+			[[noreturn]] static void fail(const char *message) {
+				throw std::invalid_argument{message};
+			}
+
+			[[nodiscard]] bool done() const {
+				return pos >= line.size();
+			}
+
+			[[nodiscard]] char peek() const {
+				return done() ? '\0' : line[pos];
+			}
+
+			void expect(char c) {
+				if (peek() != c)
+					fail("unexpected character");
+				++pos;
+			}
+
+			void skipWhitespace() {
+				while (not done() and (line[pos] == ' ' or line[pos] == '\t'))
+					++pos;
+			}
+
+			URIRef iri() {
+				expect('<');
+				const std::size_t begin = pos;
+				const std::size_t end = line.find_first_of(">\\", pos);
+				if (end == std::string_view::npos)
+					fail("unterminated IRI");
+				for (std::size_t i = begin; i < end; ++i)
+					checkIriCharacter(line[i]);
+				if (line[end] == '>') {
+					// fast path without escape sequences
+					pos = end + 1;
+					return URIRef(std::string{line.substr(begin, end - begin)});
+				}
+				std::string value{line.substr(begin, end - begin)};
+				pos = end;
+				while (peek() != '>') {
+					if (done())
+						fail("unterminated IRI");
+					if (peek() == '\\') {
+						++pos;
+						const char escape = peek();
+						++pos;
+						if (escape == 'u')
+							appendUtf8(value, hex(4));
+						else if (escape == 'U')
+							appendUtf8(value, hex(8));
+						else
+							fail("invalid escape sequence in IRI");
+					} else {
+						checkIriCharacter(line[pos]);
+						value += line[pos++];
+					}
+				}
+				++pos;
+				return URIRef(std::move(value));
+			}
+
+			/**
+			 * Rejects the characters that serd does not accept unescaped in an IRI.
+			 */
+			static void checkIriCharacter(char c) {
+				switch (c) {
+					case '"':
+					case '<':
+					case '^':
+					case '`':
+					case '{':
+					case '|':
+					case '}':
+						fail("invalid IRI character");
+					default:
+						if (static_cast<unsigned char>(c) <= 0x20)
+							fail("invalid IRI character");
+				}
+			}
+
+			BNode blankNode() {
+				expect('_');
+				expect(':');
+				const std::size_t begin = pos;
+				// BLANK_NODE_LABEL: (PN_CHARS_U | [0-9]) ((PN_CHARS | '.')* PN_CHARS)?
+				if (peek() == '_' or std::isdigit(static_cast<unsigned char>(peek())))
+					++pos;
+				else if (not labelCharacter(true))
+					fail("invalid blank node label");
+				while (not done()) {
+					if (line[pos] == '.')
+						++pos;
+					else if (not labelCharacter(false))
+						break;
+				}
+				// a label may contain '.', but a trailing one ends the statement, like in serd
+				if (line[pos - 1] == '.')
+					--pos;
+				if (not done() and line[pos] != ' ' and line[pos] != '\t' and line[pos] != '<' and line[pos] != '.')
+					fail("invalid character in blank node label");
+				std::string label{line.substr(begin, pos - begin)};
+				if (label.size() > 1 and std::isdigit(static_cast<unsigned char>(label[1]))) {
+					if (label[0] == 'b') {
+						label[0] = 'B';
+						renamed_label = true;
+					} else if (label[0] == 'B') {
+						upper_case_label = true;
+					}
+				}
+				return BNode(std::move(label));
+			}
+
+			/**
+			 * Consumes a character of PN_CHARS_BASE or '_' if first, of PN_CHARS otherwise. Non-ASCII characters are
+			 * decoded from UTF-8.
+			 * @return if a character was consumed
+			 */
+			bool labelCharacter(bool first) {
+				const auto c = static_cast<unsigned char>(peek());
+				if (c < 0x80) {
+					if (std::isalpha(c) or c == '_' or (not first and (std::isdigit(c) or c == '-'))) {
+						++pos;
+						return true;
+					}
+					return false;
+				}
+				std::size_t length;
+				std::uint32_t code_point;
+				if ((c & 0xE0) == 0xC0) {
+					length = 2;
+					code_point = c & 0x1F;
+				} else if ((c & 0xF0) == 0xE0) {
+					length = 3;
+					code_point = c & 0x0F;
+				} else if ((c & 0xF8) == 0xF0) {
+					length = 4;
+					code_point = c & 0x07;
+				} else {
+					fail("invalid UTF-8 in blank node label");
+				}
+				if (pos + length > line.size())
+					fail("invalid UTF-8 in blank node label");
+				for (std::size_t i = 1; i < length; ++i) {
+					const auto continuation = static_cast<unsigned char>(line[pos + i]);
+					if ((continuation & 0xC0) != 0x80)
+						fail("invalid UTF-8 in blank node label");
+					code_point = (code_point << 6) | (continuation & 0x3F);
+				}
+				const bool base = (code_point >= 0xC0 and code_point <= 0xD6)
+								  or (code_point >= 0xD8 and code_point <= 0xF6)
+								  or (code_point >= 0xF8 and code_point <= 0x2FF)
+								  or (code_point >= 0x370 and code_point <= 0x37D)
+								  or (code_point >= 0x37F and code_point <= 0x1FFF)
+								  or (code_point >= 0x200C and code_point <= 0x200D)
+								  or (code_point >= 0x2070 and code_point <= 0x218F)
+								  or (code_point >= 0x2C00 and code_point <= 0x2FEF)
+								  or (code_point >= 0x3001 and code_point <= 0xD7FF)
+								  or (code_point >= 0xF900 and code_point <= 0xFDCF)
+								  or (code_point >= 0xFDF0 and code_point <= 0xFFFD)
+								  or (code_point >= 0x10000 and code_point <= 0xEFFFF);
+				const bool combining = code_point == 0xB7
+									   or (code_point >= 0x300 and code_point <= 0x36F)
+									   or (code_point >= 0x203F and code_point <= 0x2040);
+				if (not(base or (not first and combining)))
+					fail("invalid character in blank node label");
+				pos += length;
+				return true;
+			}
+
+			Term literal() {
+				expect('"');
+				std::string value{};
+				while (peek() != '"') {
+					if (done())
+						fail("unterminated literal");
+					if (line[pos] == '\\') {
+						++pos;
+						const char escape = peek();
+						++pos;
+						switch (escape) {
+							case 't':
+								value += '\t';
+								break;
+							case 'b':
+								value += '\b';
+								break;
+							case 'n':
+								value += '\n';
+								break;
+							case 'r':
+								value += '\r';
+								break;
+							case 'f':
+								value += '\f';
+								break;
+							case '"':
+								value += '"';
+								break;
+							case '\'':
+								value += '\'';
+								break;
+							case '\\':
+								value += '\\';
+								break;
+							case 'u':
+								appendUtf8(value, hex(4));
+								break;
+							case 'U':
+								appendUtf8(value, hex(8));
+								break;
+							default:
+								fail("invalid escape sequence in literal");
+						}
+					} else {
+						const std::size_t end = line.find_first_of("\"\\", pos);
+						const std::size_t until = (end == std::string_view::npos) ? line.size() : end;
+						value.append(line.substr(pos, until - pos));
+						pos = until;
+					}
+				}
+				++pos;
+				if (peek() == '@') {
+					++pos;
+					const std::size_t begin = pos;
+					while (not done() and (std::isalnum(static_cast<unsigned char>(line[pos])) or line[pos] == '-'))
+						++pos;
+					if (pos == begin)
+						fail("empty language tag");
+					return Literal(std::move(value), std::string{line.substr(begin, pos - begin)}, std::nullopt);
+				} else if (peek() == '^') {
+					expect('^');
+					expect('^');
+					URIRef datatype = iri();
+					return Literal(std::move(value), std::nullopt, std::string{datatype.value()});
+				} else {
+					return Literal(std::move(value), std::nullopt, std::nullopt);
+				}
+			}
+
+			std::uint32_t hex(std::size_t digits) {
+				if (pos + digits > line.size())
+					fail("truncated escape sequence");
+				std::uint32_t code_point = 0;
+				for (std::size_t i = 0; i < digits; ++i) {
+					const char c = line[pos++];
+					code_point <<= 4;
+					if (c >= '0' and c <= '9')
+						code_point |= std::uint32_t(c - '0');
+					else if (c >= 'a' and c <= 'f')
+						code_point |= std::uint32_t(c - 'a' + 10);
+					else if (c >= 'A' and c <= 'F')
+						code_point |= std::uint32_t(c - 'A' + 10);
+					else
+						fail("invalid hex digit in escape sequence");
+				}
+				return code_point;
+			}
+
+			static void appendUtf8(std::string &out, std::uint32_t code_point) {
+				if (code_point < 0x80) {
+					out += char(code_point);
+				} else if (code_point < 0x800) {
+					out += char(0xC0 | (code_point >> 6));
+					out += char(0x80 | (code_point & 0x3F));
+				} else if (code_point < 0x10000) {
+					out += char(0xE0 | (code_point >> 12));
+					out += char(0x80 | ((code_point >> 6) & 0x3F));
+					out += char(0x80 | (code_point & 0x3F));
+				} else if (code_point < 0x110000) {
+					out += char(0xF0 | (code_point >> 18));
+					out += char(0x80 | ((code_point >> 12) & 0x3F));
+					out += char(0x80 | ((code_point >> 6) & 0x3F));
+					out += char(0x80 | (code_point & 0x3F));
+				} else {
+					fail("code point out of range");
+				}
+			}
+		};
+	};
+}
+
+#endif //TENTRIS_NTRIPLESPARSER_HPP
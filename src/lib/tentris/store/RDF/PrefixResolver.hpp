@@ -0,0 +1,69 @@
+#ifndef TENTRIS_PREFIXRESOLVER_HPP
+#define TENTRIS_PREFIXRESOLVER_HPP
+
+#include <functional>
+#include <string>
+#include <string_view>
+
+#include <absl/hash/hash.h>
+#include <tsl/hopscotch_map.h>
+
+namespace tentris::store::rdf {
+
+	/**
+	 * Expands prefixed names (CURIEs) like foaf:name to full IRIs. Lookups work on string_views and do not allocate.
+	 */
+	class PrefixResolver {
+		struct Hash {
+			using is_transparent = void;
+
+			std::size_t operator()(std::string_view str) const {
+				return absl::Hash<std::string_view>()(str);
+			}
+		};
+
+		using map_type = tsl::hopscotch_map<std::string, std::string, Hash, std::equal_to<>>;
+		map_type prefixes{};
+
+	public:
+		/**
+		 * Defines or redefines a prefix.
+		 * @param prefix the prefix name without the colon. The empty prefix is used for the base.
+		 * @param iri the namespace IRI
+		 */
+		void set(std::string_view prefix, std::string_view iri) {
+			if (auto found = prefixes.find(prefix); found != prefixes.end())
+				found.value() = std::string{iri};
+			else
+				prefixes.emplace(std::string{prefix}, std::string{iri});
+		}
+
+		/**
+		 * Expands a prefixed name. The prefix ends at the first colon. Later colons belong to the local name.
+		 * @param curie the prefixed name, e.g. ex:a:b
+		 * @param iri output. It is overwritten with the expanded IRI. Its capacity is reused, so there is no allocation
+		 * if it is large enough.
+		 * @return false if the name has no colon or the prefix is not defined. iri is unchanged then.
+		 */
+		bool expand(std::string_view curie, std::string &iri) const {
+			const auto colon = curie.find(':');
+			if (colon == std::string_view::npos)
+				return false;
+			const auto found = prefixes.find(curie.substr(0, colon));
+			if (found == prefixes.end())
+				return false;
+			const std::string_view local_name = curie.substr(colon + 1);
+			iri.clear();
+			iri.reserve(found->second.size() + local_name.size());
+			iri.append(found->second);
+			iri.append(local_name);
+			return true;
+		}
+
+		[[nodiscard]] std::size_t size() const {
+			return prefixes.size();
+		}
+	};
+}
+
+#endif //TENTRIS_PREFIXRESOLVER_HPP
@@ -5,39 +5,75 @@
 #include <fmt/core.h>
 #include <Dice/rdf_parser/RDF/Triple.hpp>
 #include <Dice/rdf_parser/RDF/Term.hpp>
-#include <boost/lockfree/spsc_queue.hpp>
 #include <serd-0/serd/serd.h>
-#include <boost/algorithm/string.hpp>
-#include <tsl/hopscotch_map.h>
 #include <atomic>
 #include <memory>
+#include <optional>
 #include <thread>
+#include <vector>
+
+#include "tentris/store/RDF/PrefixResolver.hpp"
+#include "tentris/util/BlockingQueue.hpp"
+#include "tentris/util/DecompressingReader.hpp"
 
 namespace tentris::store::rdf {
 
 	class BulkLoad {
 		using Triple = rdf_parser::store::rdf::Triple;
-		using prefixes_map_type = tsl::hopscotch_map<std::string, std::string, absl::Hash<std::string>>;
-		prefixes_map_type prefixes{};
+		PrefixResolver prefixes{};
 
 	public:
-        boost::lockfree::spsc_queue<Triple> result_queue{100000};
-		bool parsing_done;
+		using TripleBatch = std::vector<Triple>;
+		using queue_type = util::sync::BlockingQueue<TripleBatch>;
+
+		constexpr static std::size_t batch_size = 4096;
+		constexpr static std::size_t queue_capacity = 16;
+
+		/**
+		 * Batches of parsed triples. The queue is closed when parsing is done or failed.
+		 * Closing it from the consumer side stops the parser.
+		 */
+		queue_type result_queue{queue_capacity};
+		/**
+		 * Final status of serd. Valid after result_queue was closed by the parser.
+		 */
+		SerdStatus status = SERD_SUCCESS;
+		/**
+		 * Error of reading or decompressing the input. Valid after result_queue was closed by the parser.
+		 */
+		std::optional<std::string> input_error{};
+
+	private:
+		TripleBatch batch{};
 
 	public:
+		BulkLoad() {
+			batch.reserve(batch_size);
+		}
+
+		/**
+		 * Starts parsing in the background.
+		 * @param file_path RDF file. Files ending with .gz, .bz2 or .zst are decompressed on the fly, "-" reads
+		 * stdin (see util::DecompressingReader).
+		 * @return the bulk load. Its result_queue delivers the triples.
+		 */
 		static std::shared_ptr<BulkLoad> parse(const std::string &file_path) {
 
 			auto bulk_load = std::make_shared<BulkLoad>();
-
-			SerdReader *sr = serd_reader_new(SERD_TURTLE, (void *) bulk_load.get(), nullptr, &serd_base_callback,
-											 &serd_prefix_callback,
-											 &serd_callback,
-											 nullptr);
+			SerdReader *sr = bulk_load->newReader();
 
 			std::thread t([=]() {
-				SerdStatus status = serd_reader_read_file(sr, (uint8_t *) (file_path.data()));
-				bulk_load->parsing_done = true;
-				serd_reader_free(sr);
+				SerdStatus status;
+				if (util::DecompressingReader::needsReader(file_path)) {
+					util::DecompressingReader reader{file_path};
+					status = serd_reader_read_source(sr, &util::DecompressingReader::freadSource,
+													 &util::DecompressingReader::ferrorSource, &reader,
+													 (const uint8_t *) (file_path.c_str()), 4096);
+					bulk_load->input_error = reader.error();
+				} else {
+					status = serd_reader_read_file(sr, (uint8_t *) (file_path.data()));
+				}
+				bulk_load->finish(sr, status);
 			});
 			t.detach();
 
@@ -45,8 +81,43 @@ namespace tentris::store::rdf {
 
 		}
 
+		/**
+		 * Starts parsing a Turtle document from memory in the background.
+		 * @param turtle the document
+		 * @param blank_prefix prepended to all blank node labels, e.g. to keep the blank nodes of different documents
+		 * apart
+		 * @return the bulk load. Its result_queue delivers the triples.
+		 */
+		static std::shared_ptr<BulkLoad> parseString(std::string turtle, const std::string &blank_prefix = "") {
+			auto bulk_load = std::make_shared<BulkLoad>();
+			SerdReader *sr = bulk_load->newReader();
+			if (not blank_prefix.empty())
+				serd_reader_add_blank_prefix(sr, (const uint8_t *) (blank_prefix.c_str()));
+
+			std::thread t([=, turtle = std::move(turtle)]() {
+				bulk_load->finish(sr, serd_reader_read_string(sr, (const uint8_t *) (turtle.c_str())));
+			});
+			t.detach();
+
+			return bulk_load;
+		}
 
 	private:
+		SerdReader *newReader() {
+			return serd_reader_new(SERD_TURTLE, (void *) this, nullptr, &serd_base_callback, &serd_prefix_callback,
+								   &serd_callback, nullptr);
+		}
+
+		/**
+		 * Hands over the last batch, publishes the status and closes the queue.
+		 */
+		void finish(SerdReader *sr, SerdStatus final_status) {
+			if (not batch.empty())
+				result_queue.push(std::move(batch));
+			status = final_status;
+			result_queue.close();
+			serd_reader_free(sr);
+		}
 
 		auto getBNode(const SerdNode *node) const -> Term {
 			return BNode(std::string(std::string_view{(char *) (node->buf), size_t(node->n_bytes)}));
@@ -56,23 +127,27 @@ namespace tentris::store::rdf {
 			return URIRef(std::string(std::string_view{(char *) (node->buf), size_t(node->n_bytes)}));
 		}
 
-		auto getPrefixedUri(const SerdNode *node) const -> Term {
-			std::string_view uri_node_view{(char *) (node->buf), size_t(node->n_bytes)};
-
-			std::vector<std::string> prefix_and_suffix{};
-			boost::split(prefix_and_suffix, uri_node_view, [](char c) { return c == ':'; });
-
-			assert(prefix_and_suffix.size() == 2);
-			assert(prefixes.count(std::string{prefix_and_suffix[0]}));
-			return URIRef(fmt::format("{}{}", prefixes.find(prefix_and_suffix[0])->second, prefix_and_suffix[1]));
+		auto getPrefixedUri(const SerdNode *node) const -> std::optional<Term> {
+			std::string iri{};
+			if (not prefixes.expand({(char *) (node->buf), size_t(node->n_bytes)}, iri))
+				return std::nullopt;
+			return URIRef(std::move(iri));
 		}
 
-		auto getLiteral(const SerdNode *literal, const SerdNode *type_node, const SerdNode *lang_node) const -> Term {
+		/**
+		 * @return the literal or nothing if its datatype is a prefixed name with an unknown prefix
+		 */
+		auto getLiteral(const SerdNode *literal, const SerdNode *type_node,
+						const SerdNode *lang_node) const -> std::optional<Term> {
 			std::string literal_value = std::string{(char *) (literal->buf), size_t(literal->n_bytes)};
-			if (type_node != nullptr)
-				return Literal(literal_value, std::nullopt,
-							   std::string{(char *) (type_node->buf), size_t(type_node->n_bytes)});
-			else if (lang_node != nullptr)
+			if (type_node != nullptr) {
+				std::string datatype{};
+				if (type_node->type != SERD_CURIE)
+					datatype = std::string{(char *) (type_node->buf), size_t(type_node->n_bytes)};
+				else if (not prefixes.expand({(char *) (type_node->buf), size_t(type_node->n_bytes)}, datatype))
+					return std::nullopt;
+				return Literal(literal_value, std::nullopt, std::move(datatype));
+			} else if (lang_node != nullptr)
 				return Literal(literal_value, std::string{(char *) (lang_node->buf), size_t(lang_node->n_bytes)},
 							   std::nullopt);
 			else
@@ -81,14 +156,13 @@ namespace tentris::store::rdf {
 
 		static auto serd_base_callback(void *handle, const SerdNode *uri) -> SerdStatus {
 			auto &load = *((BulkLoad *) handle);
-			load.prefixes[""] = std::string((char *) (uri->buf), uri->n_bytes);
+			load.prefixes.set("", {(char *) (uri->buf), uri->n_bytes});
 			return SERD_SUCCESS;
 		}
 
 		static auto serd_prefix_callback(void *handle, const SerdNode *name, const SerdNode *uri) -> SerdStatus {
 			auto &load = *((BulkLoad *) handle);
-			load.prefixes[std::string((char *) (name->buf), name->n_bytes)]
-					= std::string((char *) (uri->buf), uri->n_bytes);
+			load.prefixes.set({(char *) (name->buf), name->n_bytes}, {(char *) (uri->buf), uri->n_bytes});
 			return SERD_SUCCESS;
 		}
 
@@ -104,7 +178,10 @@ namespace tentris::store::rdf {
 
 			switch (subject->type) {
 				case SERD_CURIE:
-					subject_term = bulk_load.getPrefixedUri(subject);
+					if (auto iri = bulk_load.getPrefixedUri(subject); iri)
+						subject_term = std::move(*iri);
+					else
+						return SERD_ERR_BAD_CURIE;
 					break;
 				case SERD_URI:
 					subject_term = bulk_load.getURI(subject);
@@ -119,7 +196,10 @@ namespace tentris::store::rdf {
 
 			switch (predicate->type) {
 				case SERD_CURIE:
-					predicate_term = bulk_load.getPrefixedUri(predicate);
+					if (auto iri = bulk_load.getPrefixedUri(predicate); iri)
+						predicate_term = std::move(*iri);
+					else
+						return SERD_ERR_BAD_CURIE;
 					break;
 				case SERD_URI:
 					predicate_term = bulk_load.getURI(predicate);
@@ -130,10 +210,16 @@ namespace tentris::store::rdf {
 
 			switch (object->type) {
 				case SERD_CURIE:
-					object_term = bulk_load.getPrefixedUri(object);
+					if (auto iri = bulk_load.getPrefixedUri(object); iri)
+						object_term = std::move(*iri);
+					else
+						return SERD_ERR_BAD_CURIE;
 					break;
 				case SERD_LITERAL:
-					object_term = bulk_load.getLiteral(object, object_datatype, object_lang);
+					if (auto literal = bulk_load.getLiteral(object, object_datatype, object_lang); literal)
+						object_term = std::move(*literal);
+					else
+						return SERD_ERR_BAD_CURIE;
 					break;
 				case SERD_BLANK:
 					object_term = bulk_load.getBNode(object);
@@ -144,12 +230,14 @@ namespace tentris::store::rdf {
 				default:
 					return SERD_ERR_BAD_SYNTAX;
 			}
-			while (bulk_load.result_queue.write_available() == 0) {
-				using namespace std::this_thread; // sleep_for, sleep_until
-				using namespace std::chrono; // nanoseconds, steady_clock, seconds
-				sleep_for(milliseconds(5));
+			bulk_load.batch.push_back({std::move(subject_term), std::move(predicate_term), std::move(object_term)});
+			if (bulk_load.batch.size() == batch_size) {
+				// blocks while the consumer is behind; fails if the consumer closed the queue
+				if (not bulk_load.result_queue.push(std::move(bulk_load.batch)))
+					return SERD_FAILURE;
+				bulk_load.batch = TripleBatch{};
+				bulk_load.batch.reserve(batch_size);
 			}
-			bulk_load.result_queue.push({std::move(subject_term), std::move(predicate_term), std::move(object_term)});
 			return SERD_SUCCESS;
 		}
 	};
@@ -168,36 +256,52 @@ namespace tentris::store::rdf {
 
 			bool done_;
 			std::shared_ptr<BulkLoad> bulk_load;
-			Triple result;
+			BulkLoad::TripleBatch batch{};
+			std::size_t pos = 0;
 
 		public:
 			explicit Iterator(const std::string &file_name) : done_(false), bulk_load(BulkLoad::parse(file_name)) {
-				while (not bulk_load->result_queue.pop(result)) {
-					if (bulk_load->parsing_done) {
-						if (not bulk_load->result_queue.pop(result)) {
-							done_ = true;
-							return;
-						}
-					}
-				}
+				nextBatch();
 			};
 
+			Iterator(const Iterator &) = delete;
+
+			Iterator(Iterator &&) = default;
+
+			~Iterator() {
+				// stops the parser if iteration is aborted early
+				if (bulk_load)
+					bulk_load->result_queue.close();
+			}
+
 			void operator++() {
-				while (not bulk_load->result_queue.pop(result)) {
-					if (bulk_load->parsing_done) {
-						if (not bulk_load->result_queue.pop(result)) {
-							done_ = true;
-						}
-						return;
-					}
-				}
+				if (++pos == batch.size())
+					nextBatch();
 			}
 
 			void operator++(int) { operator++(); }
 
 			operator bool() { return not done_; }
 
-			const Triple &operator*() { return result; }
+			const Triple &operator*() { return batch[pos]; }
+
+			/**
+			 * @return how often the parser waited for the consumer and vice versa
+			 */
+			[[nodiscard]] util::sync::QueueStalls stalls() const {
+				return bulk_load->result_queue.stalls();
+			}
+
+		private:
+			void nextBatch() {
+				pos = 0;
+				if (auto next = bulk_load->result_queue.pop(); next) {
+					batch = std::move(*next);
+				} else {
+					batch.clear();
+					done_ = true;
+				}
+			}
 		};
 
 
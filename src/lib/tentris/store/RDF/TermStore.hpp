@@ -2,94 +2,646 @@
 #define TENTRIS_STORE_RDFTERMINDEX
 
 #include <tsl/sparse_set.h>
+#include <tsl/hopscotch_map.h>
+#include <absl/hash/hash.h>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
 #include <tuple>
+#include <vector>
 
 #include "tentris/util/All.hpp"
+#include "tentris/util/container/ConcurrentBlockArena.hpp"
+#include "tentris/util/container/StringArena.hpp"
+#include "tentris/store/RDF/InlineLiteral.hpp"
 #include <Dice/rdf_parser/RDF/Term.hpp>
 
 namespace tentris::store::rdf {
 
+	namespace {
+		using namespace fmt::literals;
+	}
 
+	/**
+	 * Dictionary of RDF terms. Every term gets a dense id assigned in order of insertion. The id 0 is reserved and
+	 * stands for "no term".
+	 *
+	 * Terms are not kept as Term objects. IRIs are split into a namespace (everything up to the last '/' or '#') and
+	 * a local name. The namespaces are interned in a prefix table and only the local name is stored per IRI. Other
+	 * terms are stored with their full N-Triples identifier. The string data lives in StringArenas, the per-term
+	 * entries in a ConcurrentBlockArena, and the hash sets only hold the ids. Lookups by Term compare the stored pieces
+	 * directly and do not reconstruct any strings.
+	 *
+	 * The index is partitioned by term hash into shard_count shards with a lock each, so insert() may be called from
+	 * many threads at once. The lookups (contains, get, find) take the lock of their shard shared, so they may run
+	 * concurrently with insert(), e.g. queries while an update adds terms. identifier()/decode() do not lock; they
+	 * are safe for every id that was returned before.
+	 *
+	 * Literals that can be encoded by inline_literal (small xsd:integer, xsd:boolean, xsd:date and xsd:double values)
+	 * are not stored at all. Their ids are tagged with the highest bit and are computed from the literal directly.
+	 */
 	class TermStore {
 	    using Term = rdf_parser::store::rdf::Term;
         using BNode = rdf_parser::store::rdf::BNode;
         using Literal = rdf_parser::store::rdf::Literal;
         using URIRef = rdf_parser::store::rdf::URIRef;
 	public:
-		using set_type = tsl::sparse_set<std::unique_ptr<Term>,
-				TermHash,
-				std::equal_to<>,
-				std::allocator<std::unique_ptr<Term>>,
+		using id_type = inline_literal::id_type;
+		using prefix_id_type = std::uint32_t;
+
+		/**
+		 * The id that does not belong to any term.
+		 */
+		constexpr static id_type no_id = 0;
+
+		/**
+		 * Prefix id of entries that are not IRIs.
+		 */
+		constexpr static prefix_id_type no_prefix = std::numeric_limits<prefix_id_type>::max();
+
+		/**
+		 * Prefix id of the empty namespace. It is always present.
+		 */
+		constexpr static prefix_id_type empty_prefix = 0;
+
+		/**
+		 * Namespaces beyond this number are not interned. IRIs with such namespaces are stored as a whole under the
+		 * empty namespace.
+		 */
+		constexpr static std::size_t max_prefixes = std::size_t(1) << 20;
+
+		/**
+		 * The index is split into 2^shard_bits shards. The shard of a term is selected by the highest bits of its
+		 * hash; the lower bits are used by the hash sets.
+		 */
+		constexpr static std::size_t shard_bits = 6;
+		constexpr static std::size_t shard_count = std::size_t(1) << shard_bits;
+
+		/**
+		 * Compact representation of a stored term.
+		 */
+		struct Entry {
+			/**
+			 * TermStore::hash of the term, computed once on insertion
+			 */
+			std::size_t hash;
+			/**
+			 * local name for IRIs, full identifier otherwise
+			 */
+			const char *data;
+			std::uint32_t length;
+			prefix_id_type prefix;
+
+			[[nodiscard]] std::string_view view() const {
+				return {data, length};
+			}
+
+			[[nodiscard]] bool isIRI() const {
+				return prefix != no_prefix;
+			}
+		};
+
+		// 2^31 entries: dictionary ids must not reach into the tagged range of inline literals
+		using entry_arena_type = util::container::ConcurrentBlockArena<Entry, 16, 15>;
+		using prefix_arena_type = util::container::ConcurrentBlockArena<std::string_view, 12, 8>;
+
+		/**
+		 * Read access to entries and prefixes that is shared by all shards and the hash functors.
+		 */
+		struct Storage {
+			entry_arena_type entries{};
+			prefix_arena_type prefixes{};
+
+			[[nodiscard]] const Entry &entry(id_type id) const {
+				return entries[id - 1];
+			}
+
+			/**
+			 * Checks if the entry of id represents the term with the given N-Triples identifier.
+			 */
+			[[nodiscard]] bool matches(id_type id, std::string_view identifier) const {
+				const Entry &stored = entry(id);
+				if (stored.isIRI()) {
+					const std::string_view prefix = prefixes[stored.prefix];
+					return identifier.size() == prefix.size() + stored.length + 2
+						   and identifier.front() == '<' and identifier.back() == '>'
+						   and identifier.substr(1, prefix.size()) == prefix
+						   and identifier.substr(1 + prefix.size(), stored.length) == stored.view();
+				} else {
+					return identifier == stored.view();
+				}
+			}
+
+			[[nodiscard]] std::string identifier(id_type id) const {
+				const Entry &stored = entry(id);
+				if (stored.isIRI()) {
+					const std::string_view prefix = prefixes[stored.prefix];
+					std::string result{};
+					result.reserve(prefix.size() + stored.length + 2);
+					result += '<';
+					result += prefix;
+					result += stored.view();
+					result += '>';
+					return result;
+				} else {
+					return std::string{stored.view()};
+				}
+			}
+
+			/**
+			 * Length of the N-Triples identifier of id.
+			 */
+			[[nodiscard]] std::size_t identifierLength(id_type id) const {
+				const Entry &stored = entry(id);
+				return stored.length + (stored.isIRI() ? prefixes[stored.prefix].size() + 2 : 0);
+			}
+		};
+
+		/**
+		 * Hash of a term. It hashes the N-Triples identifier with absl::Hash, which is considerably faster than
+		 * std::hash on long strings. The value is not stable across processes, so it must never be persisted.
+		 */
+		static std::size_t hash(const Term &term) {
+			return absl::Hash<std::string_view>()(term.getIdentifier());
+		}
+
+		/**
+		 * The N-Triples identifier of a term together with its precomputed hash. This is the lookup key of the hash
+		 * sets.
+		 */
+		struct HashedTerm {
+			std::string_view identifier;
+			std::size_t hash;
+		};
+
+		/**
+		 * Hashes ids by the stored hash of their term, so growing a hash set never touches the strings.
+		 */
+		struct IdHash {
+			using is_transparent = void;
+			const Storage *storage = nullptr;
+
+			std::size_t operator()(const id_type &id) const {
+				return storage->entry(id).hash;
+			}
+
+			std::size_t operator()(const HashedTerm &key) const {
+				return key.hash;
+			}
+		};
+
+		/**
+		 * Compares ids with ids or terms. The stored hashes are compared before the strings, so probing past other
+		 * terms rarely compares strings.
+		 */
+		struct IdEqual {
+			using is_transparent = void;
+			const Storage *storage = nullptr;
+
+			bool operator()(const id_type &lhs, const id_type &rhs) const {
+				return lhs == rhs;
+			}
+
+			bool operator()(const id_type &lhs, const HashedTerm &rhs) const {
+				return storage->entry(lhs).hash == rhs.hash and storage->matches(lhs, rhs.identifier);
+			}
+
+			bool operator()(const HashedTerm &lhs, const id_type &rhs) const {
+				return operator()(rhs, lhs);
+			}
+		};
+
+		using set_type = tsl::sparse_set<id_type,
+				IdHash,
+				IdEqual,
+				std::allocator<id_type>,
 				tsl::sh::power_of_two_growth_policy<2>,
 				tsl::sh::exception_safety::basic>;
-		using const_iterator = set_type::const_iterator;
+
+		/**
+		 * The parts of a term as they are needed to serialize it, e.g. as SPARQL JSON result.
+		 */
+		struct TermParts {
+			Term::NodeType type = Term::NodeType::None;
+			/**
+			 * namespace of an IRI, empty otherwise. The IRI is value_prefix followed by value.
+			 */
+			std::string_view value_prefix{};
+			/**
+			 * local name of an IRI, label of a blank node or lexical form of a literal
+			 */
+			std::string_view value{};
+			std::string_view datatype{};
+			std::string_view lang{};
+		};
+
+		/**
+		 * Estimated memory footprint of a TermStore.
+		 */
+		struct MemoryUsage {
+			std::size_t terms = 0;
+			/**
+			 * bytes of the per-term entries
+			 */
+			std::size_t entry_bytes = 0;
+			/**
+			 * bytes of the string arenas
+			 */
+			std::size_t string_bytes = 0;
+			/**
+			 * bytes of the prefix table
+			 */
+			std::size_t prefix_bytes = 0;
+			/**
+			 * bytes of the hash sets
+			 */
+			std::size_t index_bytes = 0;
+			/**
+			 * bytes of all identifiers if they were stored uncompressed
+			 */
+			std::size_t uncompressed_string_bytes = 0;
+			/**
+			 * estimated bytes of the same terms when every Term is allocated on its own and the index holds
+			 * std::unique_ptr<Term> plus id
+			 */
+			std::size_t node_based_bytes = 0;
+
+			[[nodiscard]] std::size_t total() const {
+				return entry_bytes + string_bytes + prefix_bytes + index_bytes;
+			}
+
+			[[nodiscard]] double bytesPerTerm() const {
+				return (terms) ? double(total()) / terms : 0.0;
+			}
+
+			[[nodiscard]] double nodeBasedBytesPerTerm() const {
+				return (terms) ? double(node_based_bytes) / terms : 0.0;
+			}
+		};
 
 	private:
+		struct StringHash {
+			using is_transparent = void;
+
+			std::size_t operator()(std::string_view str) const {
+				return absl::Hash<std::string_view>()(str);
+			}
+		};
+
+		using prefix_map_type = tsl::hopscotch_map<std::string, prefix_id_type, StringHash, std::equal_to<>>;
+
+		/**
+		 * A partition of the index. Everything in it is guarded by its lock.
+		 */
+		struct alignas(64) Shard {
+			mutable std::shared_mutex lock{};
+			set_type terms;
+			util::container::StringArena strings{};
+			/**
+			 * namespaces this shard has seen, so that the global prefix table is only locked for new namespaces
+			 */
+			prefix_map_type prefix_cache{};
+
+			explicit Shard(const Storage *storage) : terms{0, IdHash{storage}, IdEqual{storage}} {}
+		};
+
+		std::unique_ptr<Storage> storage = std::make_unique<Storage>();
+		std::vector<std::unique_ptr<Shard>> shards{};
+		std::atomic<id_type> next_id{1};
+
+		mutable std::mutex prefix_lock{};
+		prefix_map_type prefix_ids{};
+		util::container::StringArena prefix_strings{std::size_t(1) << 16};
+		std::atomic<std::size_t> prefix_count{0};
+
+		static std::size_t shardOf(std::size_t term_hash) {
+			return term_hash >> (std::numeric_limits<std::size_t>::digits - shard_bits);
+		}
+
+		[[nodiscard]] const Shard &shardFor(std::size_t term_hash) const {
+			return *shards[shardOf(term_hash)];
+		}
 
-		set_type terms{};
 	public:
-		using ptr_type = Term const *;
+
+		TermStore() {
+			shards.reserve(shard_count);
+			for (std::size_t i = 0; i < shard_count; ++i)
+				shards.push_back(std::make_unique<Shard>(storage.get()));
+			std::lock_guard<std::mutex> g{prefix_lock};
+			addPrefix({});
+		}
+
+		TermStore(const TermStore &) = delete;
+
+		TermStore &operator=(const TermStore &) = delete;
 
 		bool contains(const Term &term) const {
-			auto term_hash = std::hash<Term>()(term);
+			auto term_hash = hash(term);
 			return contains(term, term_hash);
 		}
 
 		[[nodiscard]] bool contains(const Term &term, const std::size_t &term_hash) const {
-			auto found = terms.find(term, term_hash);
-			return found != terms.end();
+			if (inline_literal::encode(term))
+				return true;
+			const Shard &shard = shardFor(term_hash);
+			std::shared_lock<std::shared_mutex> g{shard.lock};
+			return shard.terms.find(HashedTerm{term.getIdentifier(), term_hash}, term_hash) != shard.terms.end();
 		}
 
-		[[nodiscard]] bool valid(ptr_type term) const {
-			auto term_hash = std::hash<Term *>()(term);
-			auto found = terms.find(term, term_hash);
-			return found != terms.end();
+		[[nodiscard]] bool valid(id_type id) const {
+			return inline_literal::isInline(id) or (id != no_id and id <= size());
 		}
 
-		[[nodiscard]] ptr_type get(const Term &term) const {
-			auto term_hash = std::hash<Term>()(term);
+		[[nodiscard]] id_type get(const Term &term) const {
+			auto term_hash = hash(term);
 			return get(term, term_hash);
 		}
 
-		[[nodiscard]] ptr_type get(const Term &term, const std::size_t &term_hash) const {
-			auto found = terms.find(term, term_hash);
-			if (found != terms.end())
-				return (*found).get();
-			else {
-				throw std::out_of_range{"Term {} not in TermStore."};
-			}
+		[[nodiscard]] id_type get(const Term &term, const std::size_t &term_hash) const {
+			if (auto found = find(term, term_hash); found != no_id)
+				return found;
+			else
+				throw std::out_of_range{"Term {} not in TermStore."_format(term.getIdentifier())};
 		}
 
-		[[nodiscard]] ptr_type find(const Term &term, const std::size_t &term_hash) const {
-			if (auto found = terms.find(term, term_hash); found != terms.end()) {
-				return (*found).get();
+		[[nodiscard]] id_type find(const Term &term, const std::size_t &term_hash) const {
+			if (auto inline_id = inline_literal::encode(term))
+				return *inline_id;
+			const Shard &shard = shardFor(term_hash);
+			std::shared_lock<std::shared_mutex> g{shard.lock};
+			const auto &terms = shard.terms;
+			if (auto found = terms.find(HashedTerm{term.getIdentifier(), term_hash}, term_hash); found != terms.end()) {
+				return *found;
 			} else {
-				return nullptr;
+				return no_id;
 			}
 		}
 
-		[[nodiscard]] ptr_type find(const Term &term) const {
-			auto term_hash = std::hash<Term>()(term);
+		[[nodiscard]] id_type find(const Term &term) const {
+			auto term_hash = hash(term);
 			return find(term, term_hash);
 		}
 
-		ptr_type operator[](const Term &term) {
-			auto term_hash = std::hash<Term>()(term);
-			auto found = terms.find(term, term_hash);
-			if (found != terms.end())
-				return (*found).get();
-			else {
-				const auto &[iter, success] = terms.emplace(std::make_unique<Term>(term));
-				assert(success);
-				return (*iter).get();
+		id_type operator[](const Term &term) {
+			auto term_hash = hash(term);
+			return insert(term, term_hash);
+		}
+
+		/**
+		 * Returns the id of term and adds the term first if it is not yet contained. Terms that are encoded inline are
+		 * not added. Thread-safe with respect to other calls of insert().
+		 * @param term the term
+		 * @param term_hash precomputed TermStore::hash of term
+		 * @return id of the term
+		 */
+		id_type insert(const Term &term, const std::size_t &term_hash) {
+			if (auto inline_id = inline_literal::encode(term))
+				return *inline_id;
+			Shard &shard = *shards[shardOf(term_hash)];
+			std::lock_guard<std::shared_mutex> g{shard.lock};
+			if (auto found = shard.terms.find(HashedTerm{term.getIdentifier(), term_hash}, term_hash); found != shard.terms.end())
+				return *found;
+
+			std::string_view identifier = term.getIdentifier();
+			Entry entry{term_hash, nullptr, 0, no_prefix};
+			std::string_view stored_part = identifier;
+			if (term.isURIRef()) {
+				std::string_view iri = identifier.substr(1, identifier.size() - 2);
+				const auto split = iri.find_last_of("/#");
+				std::string_view namespace_part = (split == std::string_view::npos)
+												  ? std::string_view{}
+												  : iri.substr(0, split + 1);
+				entry.prefix = internPrefix(shard, namespace_part);
+				if (entry.prefix == empty_prefix)
+					namespace_part = {}; // also if the prefix table is full: the whole IRI is stored
+				stored_part = iri.substr(namespace_part.size());
 			}
+			return store(shard, entry, stored_part);
+		}
+
+		/**
+		 * Reconstructs the N-Triples identifier of a term.
+		 * @param id a valid id
+		 */
+		[[nodiscard]] std::string identifier(id_type id) const {
+			assert(valid(id));
+			if (inline_literal::isInline(id))
+				return inline_literal::identifier(id);
+			return storage->identifier(id);
 		}
 
-		friend class fmt::formatter<TermStore>;
+		/**
+		 * Resolves an id.
+		 * @param id a valid id
+		 * @return the term
+		 */
+		[[nodiscard]] Term decode(id_type id) const {
+			return Term::make_term(identifier(id));
+		}
+
+		/**
+		 * Splits a term into its parts. Unlike decode(), no Term is constructed and nothing is parsed: the parts view
+		 * the stored strings and stay valid as long as the TermStore lives.
+		 * @param id a valid id
+		 * @param inline_buffer receives the lexical form of an inline literal, which is not stored. value views it.
+		 */
+		[[nodiscard]] TermParts parts(id_type id, std::string &inline_buffer) const {
+			assert(valid(id));
+			if (inline_literal::isInline(id)) {
+				inline_buffer = inline_literal::lexicalForm(id);
+				return TermParts{Term::NodeType::Literal_, {}, inline_buffer, inline_literal::datatype(id), {}};
+			}
+			const Entry &stored = storage->entry(id);
+			const std::string_view view = stored.view();
+			if (stored.isIRI())
+				return TermParts{Term::NodeType::URIRef_, storage->prefixes[stored.prefix], view};
+			if (view.substr(0, 2) == "_:")
+				return TermParts{Term::NodeType::BNode_, {}, view.substr(2)};
+			// "lexical form", "lexical form"@lang or "lexical form"^^<datatype>. Neither lang nor datatype contain '"'.
+			const auto closing_quote = view.rfind('"');
+			TermParts parts{Term::NodeType::Literal_, {}, view.substr(1, closing_quote - 1)};
+			const std::string_view suffix = view.substr(closing_quote + 1);
+			if (suffix.size() > 1 and suffix.front() == '@')
+				parts.lang = suffix.substr(1);
+			else if (suffix.size() > 4 and suffix.substr(0, 3) == "^^<")
+				parts.datatype = suffix.substr(3, suffix.size() - 4);
+			return parts;
+		}
 
+		/**
+		 * @return number of stored terms. The ids of the stored terms are 1 ... size(). Inline literals are not counted.
+		 */
 		std::size_t size() const {
-			return terms.size();
+			return std::min<std::size_t>(next_id.load() - 1, entry_arena_type::capacity);
+		}
+
+		/**
+		 * @return number of interned IRI namespaces, including the empty namespace
+		 */
+		[[nodiscard]] std::size_t prefixCount() const {
+			return prefix_count.load();
+		}
+
+		/**
+		 * @param id a valid id that is not inline
+		 * @return the stored representation of the term
+		 */
+		[[nodiscard]] const Entry &entry(id_type id) const {
+			assert(valid(id) and not inline_literal::isInline(id));
+			return storage->entry(id);
+		}
+
+		/**
+		 * @param prefix_id an id below prefixCount()
+		 * @return the interned namespace
+		 */
+		[[nodiscard]] std::string_view prefix(prefix_id_type prefix_id) const {
+			assert(prefix_id < prefixCount());
+			return storage->prefixes[prefix_id];
+		}
+
+		/**
+		 * Appends a namespace to the prefix table, e.g. when a snapshot is read. The namespaces must be restored in
+		 * the order of their ids before any term is added.
+		 * @param namespace_part the namespace
+		 * @return the id of the namespace. It is the id it had before if the namespace was known already.
+		 * @throw std::overflow_error the prefix table is full
+		 */
+		prefix_id_type restorePrefix(std::string_view namespace_part) {
+			std::lock_guard<std::mutex> g{prefix_lock};
+			if (auto found = prefix_ids.find(namespace_part); found != prefix_ids.end())
+				return found->second;
+			if (prefix_count.load() >= max_prefixes)
+				throw std::overflow_error{"Prefix table of the TermStore is full."};
+			return addPrefix(namespace_part);
+		}
+
+		/**
+		 * Adds a term from its stored representation (see Entry) without parsing it, e.g. when a snapshot is read.
+		 * The representation is not validated. Thread-safe with respect to other calls of insert() and restore().
+		 * @param prefix_id namespace of an IRI, or no_prefix for other terms
+		 * @param stored_part local name of an IRI, full N-Triples identifier otherwise
+		 * @return id of the term. If the term was stored already, its existing id.
+		 * @throw std::invalid_argument prefix_id is unknown
+		 */
+		id_type restore(prefix_id_type prefix_id, std::string_view stored_part) {
+			std::string_view identifier = stored_part;
+			std::string iri_identifier{};
+			if (prefix_id != no_prefix) {
+				if (prefix_id >= prefixCount())
+					throw std::invalid_argument{"Unknown prefix id."};
+				const std::string_view namespace_part = storage->prefixes[prefix_id];
+				iri_identifier.reserve(namespace_part.size() + stored_part.size() + 2);
+				iri_identifier += '<';
+				iri_identifier += namespace_part;
+				iri_identifier += stored_part;
+				iri_identifier += '>';
+				identifier = iri_identifier;
+			}
+			const std::size_t term_hash = absl::Hash<std::string_view>()(identifier);
+			Shard &shard = *shards[shardOf(term_hash)];
+			std::lock_guard<std::shared_mutex> g{shard.lock};
+			if (auto found = shard.terms.find(HashedTerm{identifier, term_hash}, term_hash); found != shard.terms.end())
+				return *found;
+			return store(shard, Entry{term_hash, nullptr, 0, prefix_id}, stored_part);
+		}
+
+		/**
+		 * Estimates the memory used by the stored terms. Runs in O(size()). Must not run concurrently with insert().
+		 */
+		[[nodiscard]] MemoryUsage memoryUsage() const {
+			// strings up to this length are stored inside of std::string (small string optimization)
+			constexpr std::size_t sso_capacity = 15;
+			// bookkeeping of the allocator per allocation
+			constexpr std::size_t malloc_overhead = 16;
+			MemoryUsage usage{};
+			usage.terms = size();
+			usage.entry_bytes = storage->entries.reservedBytes();
+			usage.prefix_bytes = storage->prefixes.reservedBytes() + prefix_strings.reservedBytes()
+								 + prefix_ids.bucket_count() * sizeof(std::pair<std::string, prefix_id_type>);
+			std::size_t bucket_count = 0;
+			for (const auto &shard : shards) {
+				usage.string_bytes += shard->strings.reservedBytes();
+				usage.prefix_bytes += shard->prefix_cache.bucket_count() * sizeof(std::pair<std::string, prefix_id_type>);
+				usage.index_bytes += sizeof(Shard) + shard->terms.size() * sizeof(id_type) + shard->terms.bucket_count() / 8;
+				bucket_count += shard->terms.bucket_count();
+			}
+
+			std::size_t node_string_bytes = 0;
+			for (id_type id = 1; id <= usage.terms; ++id) {
+				const std::size_t length = storage->identifierLength(id);
+				usage.uncompressed_string_bytes += length;
+				if (length > sso_capacity)
+					node_string_bytes += length + 1 + malloc_overhead;
+			}
+			usage.node_based_bytes = node_string_bytes
+									 + usage.terms * (sizeof(Term) + malloc_overhead)
+									 + usage.terms * (sizeof(std::unique_ptr<Term>) + sizeof(id_type) + 4)
+									 + bucket_count / 8;
+			return usage;
+		}
+
+	private:
+		/**
+		 * Assigns the next id to a term that is not in the index yet. Requires the lock of shard.
+		 * @param entry entry of the term without data and length
+		 * @param stored_part the string data of the entry
+		 */
+		id_type store(Shard &shard, Entry entry, std::string_view stored_part) {
+			const id_type id = next_id.fetch_add(1);
+			if (id > entry_arena_type::capacity or inline_literal::isInline(id))
+				throw std::overflow_error{"TermStore is full."};
+			auto stored = shard.strings.append(stored_part);
+			entry.data = stored.data();
+			entry.length = std::uint32_t(stored.size());
+			storage->entries.set(id - 1, entry);
+			const auto &[iter, success] = shard.terms.insert(id);
+			assert(success);
+			return id;
+		}
+
+		/**
+		 * Looks the namespace up in the cache of the shard first and in the global prefix table second.
+		 * Requires the lock of shard.
+		 */
+		prefix_id_type internPrefix(Shard &shard, std::string_view namespace_part) {
+			if (namespace_part.empty())
+				return empty_prefix;
+			if (auto found = shard.prefix_cache.find(namespace_part); found != shard.prefix_cache.end())
+				return found->second;
+			prefix_id_type prefix_id;
+			{
+				std::lock_guard<std::mutex> g{prefix_lock};
+				if (auto found = prefix_ids.find(namespace_part); found != prefix_ids.end())
+					prefix_id = found->second;
+				else if (prefix_count.load() >= max_prefixes)
+					return empty_prefix; // not cached, a later namespace could still be known globally
+				else
+					prefix_id = addPrefix(namespace_part);
+			}
+			shard.prefix_cache.emplace(std::string{namespace_part}, prefix_id);
+			return prefix_id;
+		}
+
+		/**
+		 * Requires prefix_lock.
+		 */
+		prefix_id_type addPrefix(std::string_view namespace_part) {
+			const auto prefix_id = prefix_id_type(prefix_count.load());
+			storage->prefixes.set(prefix_id, prefix_strings.append(namespace_part));
+			prefix_ids.emplace(std::string{namespace_part}, prefix_id);
+			prefix_count.store(prefix_id + 1);
+			return prefix_id;
 		}
 
 	};
@@ -102,13 +654,20 @@ struct fmt::formatter<tentris::store::rdf::TermStore> {
 
 	template<typename FormatContext>
 	auto format(const tentris::store::rdf::TermStore &p, FormatContext &ctx) {
-		return format_to(ctx.begin(),
-						 " Entries:\n"
-						 "   {}\n",
-						 join(p.terms.begin(), p.terms.end(), "\n   "));
+		const auto usage = p.memoryUsage();
+		return format_to(ctx.out(),
+						 " terms:          {}\n"
+						 " namespaces:     {}\n"
+						 " entries:        {} bytes\n"
+						 " strings:        {} bytes (uncompressed: {} bytes)\n"
+						 " prefixes:       {} bytes\n"
+						 " index:          {} bytes\n"
+						 " bytes per term: {:.1f} (node-based layout: {:.1f})\n",
+						 usage.terms, p.prefixCount(), usage.entry_bytes, usage.string_bytes,
+						 usage.uncompressed_string_bytes, usage.prefix_bytes, usage.index_bytes,
+						 usage.bytesPerTerm(), usage.nodeBasedBytesPerTerm());
 	}
 };
 
 
 #endif //TENTRIS_STORE_RDFTERMINDEX
-
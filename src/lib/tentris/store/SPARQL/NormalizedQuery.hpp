@@ -0,0 +1,435 @@
+#ifndef TENTRIS_NORMALIZEDQUERY_HPP
+#define TENTRIS_NORMALIZEDQUERY_HPP
+
+#include <cctype>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fmt/format.h>
+#include <Dice/rdf_parser/RDF/Term.hpp>
+
+namespace tentris::store::sparql {
+
+	namespace {
+		using namespace fmt::literals;
+	}
+
+	/**
+	 * Splits a SPARQL query into its shape and its parameters without parsing it. Queries that differ only in
+	 * whitespace, comments, the case of keywords, prefix names or the constants of their triple patterns have the
+	 * same shape:
+	 *  - PREFIX declarations are dropped and prefixed names are expanded to full IRIs,
+	 *  - tokens are separated by a single space,
+	 *  - IRIs, "double quoted" literals, numbers and booleans inside the WHERE clause (but not inside parentheses, e.g.
+	 *  of a FILTER) are replaced by the variables ?__param0, ?__param1, ... Equal constants get the same parameter.
+	 *
+	 * The shape is a valid query that is parsed once per shape (see QueryShape). If the query uses a variable with the
+	 * parameter prefix itself, no constants are lifted.
+	 *
+	 * A prepared query may have named parameters: variables written as $name in its triple patterns. They get the
+	 * parameter numbers after the constants and are bound when the query is executed (see PreparedQuery).
+	 */
+	class NormalizedQuery {
+		using Term = rdf_parser::store::rdf::Term;
+		using URIRef = rdf_parser::store::rdf::URIRef;
+		using Literal = rdf_parser::store::rdf::Literal;
+
+	public:
+		constexpr static std::string_view parameter_prefix = "__param";
+
+	private:
+		struct Token {
+			std::string text;
+			/**
+			 * Set for constants that are lifted into a parameter.
+			 */
+			std::optional<Term> constant{};
+			/**
+			 * Set for named parameters of prepared queries.
+			 */
+			std::optional<std::string> parameter_name{};
+		};
+
+		std::string_view input;
+		std::size_t pos = 0;
+		std::map<std::string, std::string> prefixes{};
+		std::size_t brace_depth = 0;
+		std::size_t paren_depth = 0;
+		bool uses_parameter_prefix = false;
+		bool named_parameters_allowed;
+
+		std::string shape{};
+		std::vector<Term> parameters{};
+		std::map<std::string, std::size_t> named_parameters{};
+
+	public:
+		/**
+		 * @param query a SPARQL query
+		 * @param named_parameters if variables written as $name are named parameters
+		 * @throw std::invalid_argument the query uses an undefined prefix, contains an unterminated token or uses a
+		 * named parameter outside of a triple pattern
+		 */
+		explicit NormalizedQuery(std::string_view query, bool named_parameters = false)
+				: input(query), named_parameters_allowed(named_parameters) {
+			std::vector<Token> tokens{};
+			while (auto token = nextToken())
+				tokens.push_back(std::move(*token));
+			if (uses_parameter_prefix and not this->named_parameters.empty())
+				throw std::invalid_argument{"Variables must not start with {}."_format(parameter_prefix)};
+
+			std::map<std::string, std::size_t> parameter_ids{};
+			for (const auto &token : tokens)
+				if (token.constant and not uses_parameter_prefix)
+					if (auto [parameter, inserted] = parameter_ids.emplace(
+								std::string{token.constant->getIdentifier()}, parameters.size()); inserted)
+						parameters.push_back(*token.constant);
+			// named parameters are numbered after the constants
+			for (auto &[name, id] : this->named_parameters)
+				id += parameters.size();
+
+			for (const auto &token : tokens) {
+				if (not shape.empty())
+					shape += ' ';
+				if (token.parameter_name)
+					shape += "?{}{}"_format(parameter_prefix, this->named_parameters.at(*token.parameter_name));
+				else if (token.constant and not uses_parameter_prefix)
+					shape += "?{}{}"_format(parameter_prefix, parameter_ids.at(
+							std::string{token.constant->getIdentifier()}));
+				else
+					shape += token.text;
+			}
+		}
+
+		/**
+		 * @return the query with parameters instead of constants
+		 */
+		[[nodiscard]] const std::string &getShape() const {
+			return shape;
+		}
+
+		/**
+		 * @return the lifted constants, the i-th is bound to ?__param<i>
+		 */
+		[[nodiscard]] const std::vector<Term> &getParameters() const {
+			return parameters;
+		}
+
+		/**
+		 * @return the parameter number of each named parameter
+		 */
+		[[nodiscard]] const std::map<std::string, std::size_t> &getNamedParameters() const {
+			return named_parameters;
+		}
+
+		/**
+		 * @return the index of the parameter if variable_name names one
+		 */
+		static std::optional<std::size_t> parameterIndex(std::string_view variable_name) {
+			if (variable_name.substr(0, parameter_prefix.size()) != parameter_prefix or
+				variable_name.size() == parameter_prefix.size())
+				return std::nullopt;
+			std::size_t index = 0;
+			for (const char c : variable_name.substr(parameter_prefix.size())) {
+				if (not std::isdigit((unsigned char) c))
+					return std::nullopt;
+				index = index * 10 + std::size_t(c - '0');
+			}
+			return index;
+		}
+
+	private:
+		[[nodiscard]] bool liftConstants() const {
+			return brace_depth > 0 and paren_depth == 0;
+		}
+
+		void skipWhitespace() {
+			while (pos < input.size()) {
+				if (std::isspace((unsigned char) input[pos]))
+					++pos;
+				else if (input[pos] == '#')
+					while (pos < input.size() and input[pos] != '\n')
+						++pos;
+				else
+					break;
+			}
+		}
+
+		[[nodiscard]] static bool isNameChar(char c) {
+			return std::isalnum((unsigned char) c) or c == '_' or c == '-' or (unsigned char) c >= 0x80;
+		}
+
+		[[nodiscard]] bool startsWithDigit(std::size_t at) const {
+			return at < input.size() and std::isdigit((unsigned char) input[at]);
+		}
+
+		std::optional<Token> nextToken() {
+			while (true) {
+				skipWhitespace();
+				if (pos == input.size())
+					return std::nullopt;
+				const char c = input[pos];
+				if (c == '<') {
+					if (auto iri = readIri())
+						return Token{"<{}>"_format(*iri), iriConstant(*iri)};
+					return readPunctuation();
+				} else if (c == '?' or c == '$') {
+					const std::size_t start = ++pos;
+					while (pos < input.size() and isNameChar(input[pos]))
+						++pos;
+					const std::string_view name = input.substr(start, pos - start);
+					if (name.substr(0, parameter_prefix.size()) == parameter_prefix)
+						uses_parameter_prefix = true;
+					if (c == '$' and named_parameters_allowed) {
+						if (not liftConstants())
+							throw std::invalid_argument{"Parameter ${} is used outside of a triple pattern."_format(name)};
+						// numbered in order of appearance, shifted by the number of constants later
+						named_parameters.emplace(name, named_parameters.size());
+						return Token{"?{}"_format(name), std::nullopt, std::string{name}};
+					}
+					return Token{"?{}"_format(name)};
+				} else if (c == '"' or c == '\'') {
+					return readLiteral();
+				} else if (startsNumber()) {
+					return readNumber();
+				} else if (c == '_' and input.substr(pos, 2) == "_:") {
+					const std::size_t start = pos;
+					pos += 2;
+					while (pos < input.size() and (isNameChar(input[pos]) or input[pos] == '.'))
+						++pos;
+					while (input[pos - 1] == '.')
+						--pos;
+					return Token{std::string{input.substr(start, pos - start)}};
+				} else if (std::isalpha((unsigned char) c) or c == ':' or (unsigned char) c >= 0x80) {
+					if (auto token = readWord())
+						return token;
+				} else {
+					return readPunctuation();
+				}
+			}
+		}
+
+		/**
+		 * Reads an IRI reference <...> if one starts at pos.
+		 * @return the IRI without angle brackets
+		 */
+		std::optional<std::string> readIri() {
+			std::size_t end = pos + 1;
+			while (end < input.size() and input[end] != '>') {
+				const char c = input[end];
+				if ((unsigned char) c <= 0x20 or c == '<' or c == '"' or c == '{' or c == '}' or c == '|' or
+					c == '^' or c == '`' or c == '\\')
+					return std::nullopt;
+				++end;
+			}
+			if (end == input.size())
+				return std::nullopt;
+			std::string iri{input.substr(pos + 1, end - pos - 1)};
+			pos = end + 1;
+			return iri;
+		}
+
+		Token readPunctuation() {
+			for (const std::string_view op : {"&&", "||", "!=", "<=", ">=", "^^"})
+				if (input.substr(pos, op.size()) == op) {
+					pos += op.size();
+					return Token{std::string{op}};
+				}
+			const char c = input[pos++];
+			switch (c) {
+				case '{':
+					++brace_depth;
+					break;
+				case '}':
+					if (brace_depth > 0)
+						--brace_depth;
+					break;
+				case '(':
+					++paren_depth;
+					break;
+				case ')':
+					if (paren_depth > 0)
+						--paren_depth;
+					break;
+				default:
+					break;
+			}
+			return Token{std::string(1, c)};
+		}
+
+		/**
+		 * Reads a keyword, a prefixed name or a PREFIX declaration.
+		 * @return nothing for PREFIX declarations
+		 */
+		std::optional<Token> readWord() {
+			const std::size_t start = pos;
+			while (pos < input.size() and (isNameChar(input[pos]) or input[pos] == ':' or input[pos] == '.'))
+				++pos;
+			// a word never ends with '.', it is the end of a triple pattern
+			while (input[pos - 1] == '.')
+				--pos;
+			const std::string_view word = input.substr(start, pos - start);
+
+			if (const std::size_t colon = word.find(':'); colon != std::string_view::npos) {
+				const std::string prefix{word.substr(0, colon + 1)};
+				const auto found = prefixes.find(prefix);
+				if (found == prefixes.end())
+					throw std::invalid_argument{"Undefined prefix {} used."_format(prefix)};
+				const std::string iri = found->second + std::string{word.substr(colon + 1)};
+				return Token{"<{}>"_format(iri), iriConstant(iri)};
+			}
+
+			std::string upper{word};
+			for (auto &c : upper)
+				c = char(std::toupper((unsigned char) c));
+			if (upper == "PREFIX") {
+				readPrefixDeclaration();
+				return std::nullopt;
+			}
+			if (word == "true" or word == "false")
+				return Token{std::string{word}, constant(Literal{std::string{word}, std::nullopt,
+																 "http://www.w3.org/2001/XMLSchema#boolean"})};
+			for (const std::string_view keyword : {"SELECT", "DISTINCT", "REDUCED", "WHERE", "BASE", "FROM", "NAMED",
+												   "FILTER", "OPTIONAL", "UNION", "GRAPH", "ORDER", "BY", "ASC",
+												   "DESC", "LIMIT", "OFFSET"})
+				if (upper == keyword)
+					return Token{std::move(upper)};
+			return Token{std::string{word}};
+		}
+
+		void readPrefixDeclaration() {
+			skipWhitespace();
+			const std::size_t start = pos;
+			while (pos < input.size() and input[pos] != ':' and not std::isspace((unsigned char) input[pos]))
+				++pos;
+			if (pos == input.size() or input[pos] != ':')
+				throw std::invalid_argument{"Malformed PREFIX declaration at position {}."_format(start)};
+			std::string name{input.substr(start, ++pos - start)};
+			skipWhitespace();
+			if (pos == input.size() or input[pos] != '<')
+				throw std::invalid_argument{"Malformed PREFIX declaration at position {}."_format(start)};
+			auto iri = readIri();
+			if (not iri)
+				throw std::invalid_argument{"Malformed PREFIX declaration at position {}."_format(start)};
+			prefixes[std::move(name)] = std::move(*iri);
+		}
+
+		Token readLiteral() {
+			const char quote = input[pos];
+			const std::size_t start = pos;
+			const bool is_long = input.substr(pos, 3) == std::string(3, quote);
+			pos += is_long ? 3 : 1;
+			const std::size_t content_start = pos;
+			std::size_t content_end = std::string_view::npos;
+			while (pos < input.size()) {
+				if (input[pos] == '\\') {
+					pos += 2;
+				} else if (input[pos] == quote and (not is_long or input.substr(pos, 3) == std::string(3, quote))) {
+					content_end = pos;
+					pos += is_long ? 3 : 1;
+					break;
+				} else {
+					++pos;
+				}
+			}
+			if (content_end == std::string_view::npos)
+				throw std::invalid_argument{"Unterminated string at position {}."_format(start)};
+			std::string text{input.substr(start, pos - start)};
+			std::optional<std::string> lang{};
+			std::optional<std::string> datatype{};
+
+			if (pos < input.size() and input[pos] == '@') {
+				const std::size_t lang_start = ++pos;
+				while (pos < input.size() and (std::isalnum((unsigned char) input[pos]) or input[pos] == '-'))
+					++pos;
+				lang = std::string{input.substr(lang_start, pos - lang_start)};
+				text += "@{}"_format(*lang);
+			} else if (input.substr(pos, 2) == "^^") {
+				pos += 2;
+				if (pos < input.size() and input[pos] == '<') {
+					datatype = readIri();
+				} else if (auto word = readWord(); word and word->text.front() == '<') {
+					// an expanded prefixed name
+					datatype = word->text.substr(1, word->text.size() - 2);
+				}
+				if (not datatype)
+					throw std::invalid_argument{"Malformed datatype of the literal at position {}."_format(start)};
+				text += "^^<{}>"_format(*datatype);
+			}
+
+			// single quoted and long literals are left to the parser
+			if (quote != '"' or is_long)
+				return Token{std::move(text)};
+			return Token{std::move(text),
+						 constant(Literal{std::string{input.substr(content_start, content_end - content_start)},
+										  std::move(lang), std::move(datatype)})};
+		}
+
+		Token readNumber() {
+			const std::size_t start = pos;
+			if (input[pos] == '+' or input[pos] == '-')
+				++pos;
+			bool is_decimal = false;
+			bool is_double = false;
+			while (startsWithDigit(pos))
+				++pos;
+			if (pos < input.size() and input[pos] == '.' and
+				(startsWithDigit(pos + 1) or hasExponent(pos + 1))) {
+				is_decimal = true;
+				++pos;
+				while (startsWithDigit(pos))
+					++pos;
+			}
+			if (hasExponent(pos)) {
+				is_double = true;
+				pos += (input[pos + 1] == '+' or input[pos + 1] == '-') ? 2 : 1;
+				while (startsWithDigit(pos))
+					++pos;
+			}
+			std::string text{input.substr(start, pos - start)};
+			const char *datatype = is_double ? "http://www.w3.org/2001/XMLSchema#double"
+											 : is_decimal ? "http://www.w3.org/2001/XMLSchema#decimal"
+														  : "http://www.w3.org/2001/XMLSchema#integer";
+			auto number = constant(Literal{text, std::nullopt, datatype});
+			return Token{std::move(text), std::move(number)};
+		}
+
+		/**
+		 * @return if a numeric literal starts at pos. Signs belong to the number only outside of expressions.
+		 */
+		[[nodiscard]] bool startsNumber() const {
+			std::size_t at = pos;
+			if (paren_depth == 0 and (input[at] == '+' or input[at] == '-'))
+				++at;
+			if (at < input.size() and input[at] == '.')
+				++at;
+			return startsWithDigit(at);
+		}
+
+		/**
+		 * @return if an exponent like e5, E-3 starts at at
+		 */
+		[[nodiscard]] bool hasExponent(std::size_t at) const {
+			if (at >= input.size() or (input[at] != 'e' and input[at] != 'E'))
+				return false;
+			if (at + 1 < input.size() and (input[at + 1] == '+' or input[at + 1] == '-'))
+				++at;
+			return startsWithDigit(at + 1);
+		}
+
+		[[nodiscard]] std::optional<Term> iriConstant(const std::string &iri) const {
+			return constant(URIRef{iri});
+		}
+
+		[[nodiscard]] std::optional<Term> constant(Term term) const {
+			if (liftConstants())
+				return std::move(term);
+			return std::nullopt;
+		}
+	};
+}
+
+#endif //TENTRIS_NORMALIZEDQUERY_HPP
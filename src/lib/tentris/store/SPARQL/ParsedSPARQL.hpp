@@ -9,7 +9,7 @@
 #include <exception>
 #include <memory>
 #include <tuple>
-#include <regex>
+#include <string_view>
 
 #include <Sparql/SparqlParser.h>
 #include <Sparql/SparqlLexer.h>
@@ -75,6 +75,8 @@ namespace tentris::store::sparql {
 		using ANTLRInputStream =antlr4::ANTLRInputStream;
 		using CommonTokenStream = antlr4::CommonTokenStream;
 		using QueryContext = SparqlParser::QueryContext;
+		using Literal = rdf_parser::store::rdf::Literal;
+		using URIRef = rdf_parser::store::rdf::URIRef;
 		std::string sparql_str;
 
 		SelectModifier select_modifier = NONE;
@@ -86,113 +88,44 @@ namespace tentris::store::sparql {
 		std::set<TriplePattern> bgps;
 		uint next_anon_var_id = 0;
 		std::shared_ptr<Subscript> subscript;
+		bool parsed_by_subset_parser = false;
 
 	public:
 
 		ParsedSPARQL() = default;
 
 
-		explicit ParsedSPARQL(std::string sparqlstr) :
+		/**
+		 * @param sparqlstr a SPARQL query
+		 * @param use_subset_parser if the query is first parsed with the SubsetParser. Queries it does not support are
+		 * always parsed with ANTLR.
+		 * @throw std::invalid_argument the query was not parsable
+		 */
+		explicit ParsedSPARQL(std::string sparqlstr, bool use_subset_parser = true) :
 				sparql_str{std::move(sparqlstr)} {
-			std::istringstream str_stream{sparql_str};
-			ANTLRInputStream input{str_stream};
-			SparqlLexer lexer{&input};
-			CommonTokenStream tokens{&lexer};
-			SparqlParser parser{&tokens};
-			// replace the error handler
-			auto lexerErrorListener = LexerErrorListener{};
-			lexer.removeErrorListeners();
-			lexer.addErrorListener(&lexerErrorListener);
-
-			auto parserErrorListener = ParserErrorListener{};
-			parser.removeParseListeners();
-			parser.removeErrorListeners();
-			parser.addErrorListener(&parserErrorListener);
-			// check that _query is present
-			QueryContext *_query = parser.query();
-			if (_query == nullptr)
-				throw std::invalid_argument("The query was not parsable");
-			else {
-				const std::vector<SparqlParser::PrefixDeclContext *> &prefixDecl = _query->prologue()->prefixDecl();
-				for (auto &prefix : prefixDecl)
-					// remove < and > from <...>
-					prefixes[prefix->PNAME_NS()->getText()] = std::string(prefix->IRI_REF()->getText(), 1,
-																		  prefix->IRI_REF()->getText().size() - 2);
-
-
-				SparqlParser::SelectQueryContext *select = _query->selectQuery();
-				select_modifier = getSelectModifier(select);
-				bool all_vars = false;
-				if (std::vector<SparqlParser::VarContext *> vars = select->var(); not vars.empty())
-					for (auto &var : vars)
-						query_variables.push_back(extractVariable(var));
-				else
-					all_vars = true;
-
-				std::queue<SparqlParser::TriplesBlockContext *> tripleBlocks;
-				for (auto &block : select->whereClause()->groupGraphPattern()->triplesBlock())
-					tripleBlocks.push(block);
-				while (not tripleBlocks.empty()) {
-					auto block = tripleBlocks.front();
-					tripleBlocks.pop();
-					SparqlParser::TriplesSameSubjectContext *triplesSameSubject = block->triplesSameSubject();
-
-					VarOrTerm subj = parseVarOrTerm(triplesSameSubject->varOrTerm());
-					registerVariable(subj);
-					SparqlParser::PropertyListNotEmptyContext *propertyListNotEmpty = triplesSameSubject->propertyListNotEmpty();
-					for (auto[pred_node, obj_nodes] : iter::zip(propertyListNotEmpty->verb(),
-																propertyListNotEmpty->objectList())) {
-						VarOrTerm pred = parseVerb(pred_node);
-						registerVariable(pred);
-
-						for (auto &obj_node : obj_nodes->object()) {
-							VarOrTerm obj = parseObject(obj_node);
-							registerVariable(obj);
-
-							bgps.insert(TriplePattern{subj, pred, obj});
-						}
-					}
-					if (auto *next_block = block->triplesBlock(); next_block)
-						tripleBlocks.push(next_block);
-				}
-				for (const auto &variable : query_variables)
-					variables.insert(variable);
-				if (all_vars)
-					for (const auto &variable : variables)
-						query_variables.push_back(variable);
-
-				if (query_variables.empty())
-					throw std::invalid_argument{"Empty query variables is not allowed."};
-
-
-
-				using Label = Subscript::Label;
-				// generate subscript
-				std::map<Variable, Label> var_to_label{};
-				Label next_label = 'a';
-				for (const auto &var : variables) {
-					var_to_label[var] = next_label++;
-				}
-				std::vector<std::vector<Label>> ops_labels{};
-				for (const auto &bgp : bgps) {
-					std::vector<Label> op_labels{};
-					int count = 0;
-					for (const std::variant<Variable, Term> &res : bgp)
-						if (std::holds_alternative<Variable>(res)) {
-							op_labels.push_back(var_to_label[std::get<Variable>(res)]);
-							++count;
-						}
-					if (count) // removes operands without labels/variables
-						ops_labels.push_back(op_labels);
-				}
-
-				std::vector<Label> result_labels{};
-				for (const auto &query_variable : query_variables) {
-					result_labels.push_back(var_to_label[query_variable]);
-				}
+			bool all_vars = false;
+			if (use_subset_parser)
+				parsed_by_subset_parser = SubsetParser{*this}.parse(all_vars);
+			if (not parsed_by_subset_parser)
+				all_vars = parseWithAntlr();
+
+			for (const auto &variable : query_variables)
+				variables.insert(variable);
+			if (all_vars)
+				for (const auto &variable : variables)
+					query_variables.push_back(variable);
+
+			if (query_variables.empty())
+				throw std::invalid_argument{"Empty query variables is not allowed."};
+
+			subscript = makeSubscript(bgps, variables, query_variables);
+		}
 
-				subscript = std::make_shared<Subscript>(ops_labels, result_labels);
-			}
+		/**
+		 * @return if the query was parsed by the SubsetParser instead of ANTLR
+		 */
+		bool isParsedBySubsetParser() const {
+			return parsed_by_subset_parser;
 		}
 
 		SelectModifier getSelectModifier() const {
@@ -223,8 +156,114 @@ namespace tentris::store::sparql {
 			return bgps;
 		}
 
+		/**
+		 * Generates the subscript of a basic graph pattern. Every variable gets a label. Other entries of the triple
+		 * patterns, including variables that are not in variables, are treated as constants. Triple patterns without
+		 * labels are not part of the subscript.
+		 * @param bgps the triple patterns in the order of the operands
+		 * @param variables the variables that get labels
+		 * @param query_variables the variables that are projected to the result
+		 * @return the subscript
+		 */
+		template<typename TriplePatterns>
+		static std::shared_ptr<Subscript> makeSubscript(const TriplePatterns &bgps, const std::set<Variable> &variables,
+														const std::vector<Variable> &query_variables) {
+			using Label = Subscript::Label;
+			std::map<Variable, Label> var_to_label{};
+			Label next_label = 'a';
+			for (const auto &var : variables) {
+				var_to_label[var] = next_label++;
+			}
+			std::vector<std::vector<Label>> ops_labels{};
+			for (const TriplePattern &bgp : bgps) {
+				std::vector<Label> op_labels{};
+				for (const VarOrTerm &res : bgp)
+					if (std::holds_alternative<Variable>(res))
+						if (auto label = var_to_label.find(std::get<Variable>(res)); label != var_to_label.end())
+							op_labels.push_back(label->second);
+				if (not op_labels.empty()) // removes operands without labels/variables
+					ops_labels.push_back(op_labels);
+			}
+
+			std::vector<Label> result_labels{};
+			for (const auto &query_variable : query_variables) {
+				result_labels.push_back(var_to_label.at(query_variable));
+			}
+
+			return std::make_shared<Subscript>(ops_labels, result_labels);
+		}
+
 	private:
 
+		/**
+		 * Parses the query with the ANTLR parser.
+		 * @return if all variables are selected (SELECT *)
+		 */
+		bool parseWithAntlr() {
+			std::istringstream str_stream{sparql_str};
+			ANTLRInputStream input{str_stream};
+			SparqlLexer lexer{&input};
+			CommonTokenStream tokens{&lexer};
+			SparqlParser parser{&tokens};
+			// replace the error handler
+			auto lexerErrorListener = LexerErrorListener{};
+			lexer.removeErrorListeners();
+			lexer.addErrorListener(&lexerErrorListener);
+
+			auto parserErrorListener = ParserErrorListener{};
+			parser.removeParseListeners();
+			parser.removeErrorListeners();
+			parser.addErrorListener(&parserErrorListener);
+			// check that _query is present
+			QueryContext *_query = parser.query();
+			if (_query == nullptr)
+				throw std::invalid_argument("The query was not parsable");
+
+			const std::vector<SparqlParser::PrefixDeclContext *> &prefixDecl = _query->prologue()->prefixDecl();
+			for (auto &prefix : prefixDecl)
+				// remove < and > from <...>
+				prefixes[prefix->PNAME_NS()->getText()] = std::string(prefix->IRI_REF()->getText(), 1,
+																	  prefix->IRI_REF()->getText().size() - 2);
+
+
+			SparqlParser::SelectQueryContext *select = _query->selectQuery();
+			select_modifier = getSelectModifier(select);
+			bool all_vars = false;
+			if (std::vector<SparqlParser::VarContext *> vars = select->var(); not vars.empty())
+				for (auto &var : vars)
+					query_variables.push_back(extractVariable(var));
+			else
+				all_vars = true;
+
+			std::queue<SparqlParser::TriplesBlockContext *> tripleBlocks;
+			for (auto &block : select->whereClause()->groupGraphPattern()->triplesBlock())
+				tripleBlocks.push(block);
+			while (not tripleBlocks.empty()) {
+				auto block = tripleBlocks.front();
+				tripleBlocks.pop();
+				SparqlParser::TriplesSameSubjectContext *triplesSameSubject = block->triplesSameSubject();
+
+				VarOrTerm subj = parseVarOrTerm(triplesSameSubject->varOrTerm());
+				registerVariable(subj);
+				SparqlParser::PropertyListNotEmptyContext *propertyListNotEmpty = triplesSameSubject->propertyListNotEmpty();
+				for (auto[pred_node, obj_nodes] : iter::zip(propertyListNotEmpty->verb(),
+															propertyListNotEmpty->objectList())) {
+					VarOrTerm pred = parseVerb(pred_node);
+					registerVariable(pred);
+
+					for (auto &obj_node : obj_nodes->object()) {
+						VarOrTerm obj = parseObject(obj_node);
+						registerVariable(obj);
+
+						bgps.insert(TriplePattern{subj, pred, obj});
+					}
+				}
+				if (auto *next_block = block->triplesBlock(); next_block)
+					tripleBlocks.push(next_block);
+			}
+			return all_vars;
+		}
+
 		void registerVariable(VarOrTerm &variant) {
 			if (std::holds_alternative<Variable>(variant)) {
 				auto &var = std::get<Variable>(variant);
@@ -246,17 +285,7 @@ namespace tentris::store::sparql {
 				std::string literal_string;
 				if (auto *stringLiteral1 = string_node->STRING_LITERAL1(); stringLiteral1) {
 					auto literal1 = stringLiteral1->getText();
-
-					static std::regex double_quote{"\"", std::regex::optimize};
-					static std::regex single_quote("\\'", std::regex::optimize);
-
-					std::string temp;
-
-					std::regex_replace(std::back_inserter(temp), literal1.begin() + 1, literal1.end() - 1,
-									   double_quote,
-									   "\\\"");
-					std::regex_replace(std::back_inserter(literal_string), temp.begin() + 1, temp.end() - 1,
-									   single_quote, "'");
+					literal_string = singleQuotedContent(std::string_view{literal1}.substr(1, literal1.size() - 2));
 				} else {
 					auto literal2 = string_node->STRING_LITERAL2()->getText();
 					literal_string = std::string{literal2, 1, literal2.size() - 2};
@@ -377,7 +406,7 @@ namespace tentris::store::sparql {
 			auto *modifier = select->selectModifier();
 			if (!modifier->children.empty()) {
 				const std::string &modifier_str = modifier->children[0]->toString();
-				if (modifier_str == "DISTINCT") {
+				if (boost::iequals(modifier_str, "DISTINCT")) {
 					return DISTINCT;
 				} else {
 					return REDUCE;
@@ -393,6 +422,364 @@ namespace tentris::store::sparql {
 			return Variable{std::string{data, 1, data.length() - 1}};
 		}
 
+		/**
+		 * Converts the content of a 'single quoted' literal to the content of the equal "double quoted" literal.
+		 */
+		static std::string singleQuotedContent(std::string_view content) {
+			std::string converted;
+			converted.reserve(content.size());
+			for (std::size_t i = 0; i < content.size(); ++i) {
+				if (content[i] == '"') {
+					converted += "\\\"";
+				} else if (content[i] == '\\' and i + 1 < content.size()) {
+					if (content[i + 1] != '\'')
+						converted += '\\';
+					converted += content[++i];
+				} else {
+					converted += content[i];
+				}
+			}
+			return converted;
+		}
+
+		/**
+		 * Recursive descent parser for the queries Tentris supports: PREFIX declarations, SELECT [DISTINCT|REDUCED]
+		 * and a WHERE clause that is a basic graph pattern. It produces the same result as the ANTLR parser without
+		 * building a parse tree. Everything else (e.g. BASE, FROM, FILTER, OPTIONAL, nested groups, collections, long
+		 * literals, solution modifiers) and all syntax errors are left to the ANTLR parser.
+		 */
+		class SubsetParser {
+			/**
+			 * Thrown if the query is not in the supported subset.
+			 */
+			struct Unsupported {};
+
+			ParsedSPARQL &parsed;
+			std::string_view input;
+			std::size_t pos = 0;
+
+		public:
+			explicit SubsetParser(ParsedSPARQL &parsed) : parsed(parsed), input(parsed.sparql_str) {}
+
+			/**
+			 * @param all_vars set to true if all variables are selected (SELECT *)
+			 * @return if the query was parsed. If not, parsed is left unchanged.
+			 */
+			bool parse(bool &all_vars) {
+				try {
+					all_vars = parseQuery();
+					return true;
+				} catch (const Unsupported &) {
+					parsed.prefixes.clear();
+					parsed.select_modifier = NONE;
+					parsed.query_variables.clear();
+					parsed.variables.clear();
+					parsed.anonym_variables.clear();
+					parsed.bgps.clear();
+					parsed.next_anon_var_id = 0;
+					return false;
+				}
+			}
+
+		private:
+			bool parseQuery() {
+				while (keyword("PREFIX")) {
+					skipWhitespace();
+					std::string prefix = prefixedName();
+					if (prefix.back() != ':' or prefix.find(':') != prefix.size() - 1)
+						throw Unsupported{};
+					skipWhitespace();
+					parsed.prefixes[std::move(prefix)] = iriRef();
+				}
+
+				if (not keyword("SELECT"))
+					throw Unsupported{};
+				if (keyword("DISTINCT"))
+					parsed.select_modifier = DISTINCT;
+				else if (keyword("REDUCED"))
+					parsed.select_modifier = REDUCE;
+				bool all_vars = false;
+				if (accept('*')) {
+					all_vars = true;
+				} else {
+					do
+						parsed.query_variables.push_back(variable());
+					while (startsVariable());
+				}
+
+				keyword("WHERE");
+				expect('{');
+				while (not accept('}')) {
+					triplesSameSubject();
+					if (not accept('.')) {
+						expect('}');
+						break;
+					}
+				}
+				skipWhitespace();
+				if (pos != input.size())
+					throw Unsupported{};
+				return all_vars;
+			}
+
+			void triplesSameSubject() {
+				VarOrTerm subj = varOrTerm();
+				parsed.registerVariable(subj);
+				do {
+					skipWhitespace();
+					if (peek() == '.' or peek() == '}')
+						break; // the property list may end with ';'
+					VarOrTerm pred = verb();
+					parsed.registerVariable(pred);
+					do {
+						VarOrTerm obj = varOrTerm();
+						parsed.registerVariable(obj);
+						parsed.bgps.insert(TriplePattern{subj, pred, obj});
+					} while (accept(','));
+				} while (accept(';'));
+			}
+
+			VarOrTerm verb() {
+				skipWhitespace();
+				if (startsVariable())
+					return variable();
+				if (peek() == '<')
+					return URIRef{iriRef()};
+				if (keyword("a"))
+					return URIRef{"http://www.w3.org/1999/02/22-rdf-syntax-ns#type"};
+				return URIRef{resolve(prefixedName())};
+			}
+
+			VarOrTerm varOrTerm() {
+				skipWhitespace();
+				const char c = peek();
+				if (startsVariable())
+					return variable();
+				if (c == '<')
+					return URIRef{iriRef()};
+				if (c == '"' or c == '\'')
+					return literal();
+				if (std::isdigit((unsigned char) c) or c == '+' or c == '-' or c == '.')
+					return number();
+				if (c == '[') {
+					++pos;
+					expect(']');
+					return Variable{"__:" + std::to_string(parsed.next_anon_var_id++)};
+				}
+				if (input.substr(pos, 2) == "_:") {
+					pos += 2;
+					return Variable{"_:" + name(true)};
+				}
+				if (keyword("true"))
+					return Literal{"true", std::nullopt, "http://www.w3.org/2001/XMLSchema#boolean"};
+				if (keyword("false"))
+					return Literal{"false", std::nullopt, "http://www.w3.org/2001/XMLSchema#boolean"};
+				return URIRef{resolve(prefixedName())};
+			}
+
+			Variable variable() {
+				skipWhitespace();
+				if (not startsVariable())
+					throw Unsupported{};
+				++pos;
+				return Variable{name(false)};
+			}
+
+			Literal literal() {
+				const char quote = input[pos];
+				if (input.substr(pos, 3) == std::string(3, quote))
+					throw Unsupported{};
+				const std::size_t start = ++pos;
+				while (pos < input.size() and input[pos] != quote) {
+					const char c = input[pos];
+					if (c == '\n' or c == '\r')
+						throw Unsupported{};
+					if (c == '\\') {
+						if (pos + 1 == input.size() or
+							std::string_view{"tbnrf\"'\\"}.find(input[pos + 1]) == std::string_view::npos)
+							throw Unsupported{};
+						++pos;
+					}
+					++pos;
+				}
+				if (pos == input.size())
+					throw Unsupported{};
+				const std::string_view content = input.substr(start, pos++ - start);
+				std::string literal_string = (quote == '"') ? std::string{content} : singleQuotedContent(content);
+
+				if (accept('@', false)) {
+					const std::size_t lang_start = pos;
+					while (pos < input.size() and std::isalpha((unsigned char) input[pos]))
+						++pos;
+					if (pos == lang_start)
+						throw Unsupported{};
+					while (input.substr(pos, 1) == "-" and pos + 1 < input.size() and
+						   std::isalnum((unsigned char) input[pos + 1])) {
+						++pos;
+						while (pos < input.size() and std::isalnum((unsigned char) input[pos]))
+							++pos;
+					}
+					return Literal{std::move(literal_string), std::string{input.substr(lang_start, pos - lang_start)},
+								   std::nullopt};
+				} else if (input.substr(pos, 2) == "^^") {
+					pos += 2;
+					std::string datatype = (peek() == '<') ? iriRef() : resolve(prefixedName());
+					return Literal{std::move(literal_string), std::nullopt, std::move(datatype)};
+				}
+				return Literal{std::move(literal_string), std::nullopt, std::nullopt};
+			}
+
+			Literal number() {
+				const std::size_t start = pos;
+				if (input[pos] == '+' or input[pos] == '-')
+					++pos;
+				const std::size_t integer_digits = digits();
+				bool is_decimal = false;
+				bool is_double = false;
+				if (pos < input.size() and input[pos] == '.') {
+					++pos;
+					// "1." is a decimal for ANTLR, but usually meant as the end of a triple pattern
+					if (digits() == 0)
+						throw Unsupported{};
+					is_decimal = true;
+				} else if (integer_digits == 0) {
+					throw Unsupported{};
+				}
+				if (pos < input.size() and (input[pos] == 'e' or input[pos] == 'E')) {
+					++pos;
+					if (pos < input.size() and (input[pos] == '+' or input[pos] == '-'))
+						++pos;
+					if (digits() == 0)
+						throw Unsupported{};
+					is_double = true;
+				}
+				if (pos < input.size() and isNameChar(input[pos]))
+					throw Unsupported{};
+				return Literal{std::string{input.substr(start, pos - start)}, std::nullopt,
+							   is_double ? "http://www.w3.org/2001/XMLSchema#double"
+										 : is_decimal ? "http://www.w3.org/2001/XMLSchema#decimal"
+													  : "http://www.w3.org/2001/XMLSchema#integer"};
+			}
+
+			std::size_t digits() {
+				const std::size_t start = pos;
+				while (pos < input.size() and std::isdigit((unsigned char) input[pos]))
+					++pos;
+				return pos - start;
+			}
+
+			/**
+			 * @return the IRI of an IRI reference without < and >
+			 */
+			std::string iriRef() {
+				if (peek() != '<')
+					throw Unsupported{};
+				const std::size_t start = ++pos;
+				while (pos < input.size() and input[pos] != '>') {
+					const char c = input[pos];
+					if ((unsigned char) c <= 0x20 or c == '<' or c == '"' or c == '{' or c == '}' or c == '|' or
+						c == '^' or c == '`' or c == '\\')
+						throw Unsupported{};
+					++pos;
+				}
+				if (pos == input.size())
+					throw Unsupported{};
+				return std::string{input.substr(start, pos++ - start)};
+			}
+
+			/**
+			 * @return a prefixed name as written, e.g. rdf:type or rdf:
+			 */
+			std::string prefixedName() {
+				const std::size_t start = pos;
+				if (peek() != ':') {
+					if (not std::isalpha((unsigned char) peek()))
+						throw Unsupported{};
+					name(true);
+				}
+				if (not accept(':', false))
+					throw Unsupported{};
+				if (pos < input.size() and (isNameChar(input[pos])))
+					name(true);
+				return std::string{input.substr(start, pos - start)};
+			}
+
+			std::string resolve(const std::string &prefixed_name) const {
+				const std::size_t colon = prefixed_name.find(':');
+				const auto prefix = parsed.prefixes.find(prefixed_name.substr(0, colon + 1));
+				if (colon == std::string::npos or prefix == parsed.prefixes.end())
+					throw Unsupported{};
+				return prefix->second + prefixed_name.substr(colon + 1);
+			}
+
+			/**
+			 * Reads a name. Names of prefixes, local names and blank node labels may contain '.' but not end with it.
+			 */
+			std::string name(bool with_dots) {
+				const std::size_t start = pos;
+				while (pos < input.size() and (isNameChar(input[pos]) or (with_dots and input[pos] == '.')))
+					++pos;
+				while (pos > start and input[pos - 1] == '.')
+					--pos;
+				if (pos == start)
+					throw Unsupported{};
+				return std::string{input.substr(start, pos - start)};
+			}
+
+			[[nodiscard]] static bool isNameChar(char c) {
+				return std::isalnum((unsigned char) c) or c == '_' or c == '-' or (unsigned char) c >= 0x80;
+			}
+
+			[[nodiscard]] bool startsVariable() {
+				skipWhitespace();
+				return (peek() == '?' or peek() == '$') and pos + 1 < input.size() and isNameChar(input[pos + 1]);
+			}
+
+			/**
+			 * Consumes a case-insensitive keyword if it is next.
+			 */
+			bool keyword(std::string_view word) {
+				skipWhitespace();
+				if (input.size() - pos < word.size() or
+					not boost::iequals(input.substr(pos, word.size()), word) or
+					(pos + word.size() < input.size() and
+					 (isNameChar(input[pos + word.size()]) or input[pos + word.size()] == ':')))
+					return false;
+				pos += word.size();
+				return true;
+			}
+
+			bool accept(char c, bool skip_whitespace = true) {
+				if (skip_whitespace)
+					skipWhitespace();
+				if (peek() != c)
+					return false;
+				++pos;
+				return true;
+			}
+
+			void expect(char c) {
+				if (not accept(c))
+					throw Unsupported{};
+			}
+
+			[[nodiscard]] char peek() const {
+				return pos < input.size() ? input[pos] : '\0';
+			}
+
+			void skipWhitespace() {
+				while (pos < input.size()) {
+					if (std::isspace((unsigned char) input[pos]))
+						++pos;
+					else if (input[pos] == '#')
+						while (pos < input.size() and input[pos] != '\n')
+							++pos;
+					else
+						break;
+				}
+			}
+		};
+
 	public:
 		friend struct fmt::formatter<tentris::store::sparql::ParsedSPARQL>;
 	};
@@ -0,0 +1,241 @@
+#ifndef TENTRIS_PARSEDUPDATE_HPP
+#define TENTRIS_PARSEDUPDATE_HPP
+
+#include <atomic>
+#include <cctype>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+#include <Dice/rdf_parser/RDF/Triple.hpp>
+
+#include "tentris/store/RDF/SerdParser.hpp"
+
+namespace tentris::store::sparql {
+
+	namespace {
+		using namespace fmt::literals;
+	}
+
+	/**
+	 * A parsed SPARQL 1.1 Update request. Only the ground data operations INSERT DATA and DELETE DATA are supported,
+	 * optionally preceded by PREFIX declarations and separated by ';'. The data blocks have Turtle syntax, so they are
+	 * rewritten into a Turtle document and parsed with serd. GRAPH blocks and BASE are rejected because the store has a
+	 * single default graph and no base IRI.
+	 *
+	 * Blank nodes of INSERT DATA are fresh per request: their labels are prefixed with a counter that is unique within
+	 * the process.
+	 */
+	class ParsedUpdate {
+		using Triple = rdf_parser::store::rdf::Triple;
+		using Term = rdf_parser::store::rdf::Term;
+
+	public:
+		enum class OperationType {
+			INSERT_DATA,
+			DELETE_DATA
+		};
+
+		struct Operation {
+			OperationType type;
+			std::vector<Triple> triples;
+		};
+
+	private:
+		inline static std::atomic<std::size_t> request_count{0};
+
+		std::string_view input;
+		std::size_t pos = 0;
+		std::string turtle_prefixes{};
+		std::vector<Operation> operations{};
+
+	public:
+		/**
+		 * @param update_string the update request
+		 * @throw std::invalid_argument the request is no valid INSERT DATA / DELETE DATA request
+		 */
+		explicit ParsedUpdate(std::string_view update_string) : input(update_string) {
+			const std::string blank_prefix = "u{}_"_format(request_count.fetch_add(1, std::memory_order_relaxed));
+			while (true) {
+				parsePrologue();
+				if (atEnd())
+					break;
+				OperationType type;
+				if (consumeKeyword("INSERT"))
+					type = OperationType::INSERT_DATA;
+				else if (consumeKeyword("DELETE"))
+					type = OperationType::DELETE_DATA;
+				else
+					throw std::invalid_argument{"Only INSERT DATA and DELETE DATA updates are supported."};
+				if (not consumeKeyword("DATA"))
+					throw std::invalid_argument{"Only INSERT DATA and DELETE DATA updates are supported."};
+				auto triples = parseTriples(readDataBlock(), type == OperationType::INSERT_DATA ? blank_prefix : "");
+				if (type == OperationType::DELETE_DATA)
+					for (const auto &triple : triples)
+						if (triple.subject().type() == Term::NodeType::BNode_ or
+							triple.object().type() == Term::NodeType::BNode_)
+							throw std::invalid_argument{"DELETE DATA must not contain blank nodes."};
+				operations.push_back({type, std::move(triples)});
+				if (atEnd())
+					break;
+				if (input[pos] != ';')
+					throw std::invalid_argument{"Expected ';' or the end of the update at position {}."_format(pos)};
+				++pos;
+			}
+		}
+
+		[[nodiscard]] const std::vector<Operation> &getOperations() const {
+			return operations;
+		}
+
+	private:
+		[[nodiscard]] bool atEnd() {
+			skipWhitespace();
+			return pos == input.size();
+		}
+
+		void skipWhitespace() {
+			while (pos < input.size()) {
+				if (std::isspace((unsigned char) input[pos]))
+					++pos;
+				else if (input[pos] == '#')
+					while (pos < input.size() and input[pos] != '\n')
+						++pos;
+				else
+					break;
+			}
+		}
+
+		/**
+		 * Consumes keyword case-insensitively if it is the next token.
+		 */
+		bool consumeKeyword(std::string_view keyword) {
+			skipWhitespace();
+			if (input.size() - pos < keyword.size())
+				return false;
+			for (std::size_t i = 0; i < keyword.size(); ++i)
+				if (std::toupper((unsigned char) input[pos + i]) != keyword[i])
+					return false;
+			const std::size_t end = pos + keyword.size();
+			if (end < input.size() and (std::isalnum((unsigned char) input[end]) or input[end] == '_'))
+				return false;
+			pos = end;
+			return true;
+		}
+
+		/**
+		 * Reads PREFIX declarations and keeps them as Turtle @prefix directives.
+		 */
+		void parsePrologue() {
+			while (true) {
+				if (consumeKeyword("BASE"))
+					throw std::invalid_argument{"BASE is not supported in updates."};
+				if (not consumeKeyword("PREFIX"))
+					return;
+				skipWhitespace();
+				const std::size_t name_start = pos;
+				while (pos < input.size() and input[pos] != ':' and not std::isspace((unsigned char) input[pos]))
+					++pos;
+				if (pos == input.size() or input[pos] != ':')
+					throw std::invalid_argument{"Malformed PREFIX declaration at position {}."_format(name_start)};
+				const std::string_view name = input.substr(name_start, pos - name_start);
+				++pos;
+				skipWhitespace();
+				const std::size_t iri_start = pos;
+				if (pos == input.size() or input[pos] != '<')
+					throw std::invalid_argument{"Malformed PREFIX declaration at position {}."_format(name_start)};
+				while (pos < input.size() and input[pos] != '>')
+					++pos;
+				if (pos == input.size())
+					throw std::invalid_argument{"Unterminated IRI at position {}."_format(iri_start)};
+				++pos;
+				turtle_prefixes += "@prefix {}: {} .\n"_format(name, input.substr(iri_start, pos - iri_start));
+			}
+		}
+
+		/**
+		 * Reads a { ... } block. Comments are dropped, strings and IRIs are copied verbatim.
+		 * @return the content of the block
+		 */
+		std::string readDataBlock() {
+			skipWhitespace();
+			if (pos == input.size() or input[pos] != '{')
+				throw std::invalid_argument{"Expected '{{' at position {}."_format(pos)};
+			const std::size_t block_start = pos++;
+			std::string data{};
+			while (pos < input.size()) {
+				const char c = input[pos];
+				if (c == '}') {
+					++pos;
+					return data;
+				} else if (c == '{') {
+					throw std::invalid_argument{"GRAPH blocks are not supported."};
+				} else if (c == '#') {
+					while (pos < input.size() and input[pos] != '\n')
+						++pos;
+					data += '\n';
+				} else if (c == '<') {
+					const std::size_t end = input.find('>', pos);
+					if (end == std::string_view::npos)
+						throw std::invalid_argument{"Unterminated IRI at position {}."_format(pos)};
+					data += input.substr(pos, end + 1 - pos);
+					pos = end + 1;
+				} else if (c == '"' or c == '\'') {
+					copyString(data);
+				} else {
+					data += c;
+					++pos;
+				}
+			}
+			throw std::invalid_argument{"Unterminated data block starting at position {}."_format(block_start)};
+		}
+
+		/**
+		 * Copies a short or long string literal starting at pos, including its quotes and escapes.
+		 */
+		void copyString(std::string &data) {
+			const char quote = input[pos];
+			const std::size_t start = pos;
+			const bool is_long = input.substr(pos, 3) == std::string(3, quote);
+			pos += is_long ? 3 : 1;
+			while (pos < input.size()) {
+				if (input[pos] == '\\') {
+					pos += 2;
+				} else if (input[pos] == quote and
+						   (not is_long or input.substr(pos, 3) == std::string(3, quote))) {
+					pos += is_long ? 3 : 1;
+					data += input.substr(start, pos - start);
+					return;
+				} else if (not is_long and (input[pos] == '\n' or input[pos] == '\r')) {
+					break;
+				} else {
+					++pos;
+				}
+			}
+			throw std::invalid_argument{"Unterminated string at position {}."_format(start)};
+		}
+
+		std::vector<Triple> parseTriples(std::string data, const std::string &blank_prefix) const {
+			// the last triple of a SPARQL data block may omit the '.' that Turtle requires
+			std::string turtle = turtle_prefixes + data;
+			while (not turtle.empty() and std::isspace((unsigned char) turtle.back()))
+				turtle.pop_back();
+			if (turtle.size() > turtle_prefixes.size() and turtle.back() != '.')
+				turtle += " .";
+
+			auto bulk_load = rdf::BulkLoad::parseString(std::move(turtle), blank_prefix);
+			std::vector<Triple> triples{};
+			while (auto batch = bulk_load->result_queue.pop())
+				triples.insert(triples.end(), std::make_move_iterator(batch->begin()),
+							   std::make_move_iterator(batch->end()));
+			if (bulk_load->status != SERD_SUCCESS)
+				throw std::invalid_argument{"The data block is no valid list of triples."};
+			return triples;
+		}
+	};
+}
+
+#endif //TENTRIS_PARSEDUPDATE_HPP
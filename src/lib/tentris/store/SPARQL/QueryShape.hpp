@@ -0,0 +1,145 @@
+#ifndef TENTRIS_QUERYSHAPE_HPP
+#define TENTRIS_QUERYSHAPE_HPP
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <optional>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "tentris/store/SPARQL/NormalizedQuery.hpp"
+#include "tentris/store/SPARQL/ParsedSPARQL.hpp"
+
+namespace tentris::store::sparql {
+
+	/**
+	 * The parsed form of a query shape (see NormalizedQuery). It is independent of the stored data, so it stays valid
+	 * when the store is updated or reloaded. bind() turns it into the triple patterns of a concrete query.
+	 */
+	class QueryShape {
+		using Term = rdf_parser::store::rdf::Term;
+
+		/**
+		 * A triple pattern whose entries may be parameters.
+		 */
+		struct PatternTemplate {
+			TriplePattern pattern;
+			std::array<std::optional<std::size_t>, 3> parameters;
+		};
+
+		std::string shape_string;
+		std::shared_ptr<Subscript> subscript;
+		SelectModifier select_modifier;
+		std::vector<Variable> query_variables{};
+		/**
+		 * In the order of the operands of the subscript.
+		 */
+		std::vector<PatternTemplate> patterns{};
+		std::size_t parameter_count = 0;
+		std::size_t memory_usage = 0;
+
+		/**
+		 * Rough size of the einsum plan data that a Subscript keeps per label.
+		 */
+		constexpr static std::size_t subscript_bytes_per_label = 64;
+
+	public:
+		QueryShape() = delete;
+
+		/**
+		 * @param shape_string a query shape as produced by NormalizedQuery
+		 * @throw std::invalid_argument the shape was not parsable
+		 */
+		explicit QueryShape(const std::string &shape_string) : shape_string(shape_string) {
+			ParsedSPARQL parsed_sparql{shape_string};
+			select_modifier = parsed_sparql.getSelectModifier();
+
+			auto is_parameter = [](const Variable &variable) {
+				return NormalizedQuery::parameterIndex(variable.name).has_value();
+			};
+			std::set<Variable> variables{};
+			for (const auto &variable : parsed_sparql.getVariables())
+				if (not is_parameter(variable))
+					variables.insert(variable);
+			for (const auto &variable : parsed_sparql.getQueryVariables())
+				if (not is_parameter(variable))
+					query_variables.push_back(variable);
+			if (query_variables.empty())
+				throw std::invalid_argument{"Empty query variables is not allowed."};
+
+			std::vector<TriplePattern> bgps{parsed_sparql.getBgps().begin(), parsed_sparql.getBgps().end()};
+			for (const auto &tp : bgps) {
+				PatternTemplate pattern{tp, {}};
+				for (std::size_t pos = 0; pos < 3; ++pos)
+					if (std::holds_alternative<Variable>(tp[pos]))
+						if (auto index = NormalizedQuery::parameterIndex(std::get<Variable>(tp[pos]).name); index) {
+							pattern.parameters[pos] = *index;
+							parameter_count = std::max(parameter_count, *index + 1);
+						}
+				patterns.push_back(std::move(pattern));
+			}
+			subscript = ParsedSPARQL::makeSubscript(bgps, variables, query_variables);
+
+			memory_usage = sizeof(QueryShape) + this->shape_string.capacity()
+						   + query_variables.capacity() * sizeof(Variable)
+						   + patterns.capacity() * sizeof(PatternTemplate)
+						   + sizeof(Subscript)
+						   + subscript_bytes_per_label * (3 * patterns.size() + query_variables.size());
+			for (const auto &variable : query_variables)
+				memory_usage += variable.name.capacity();
+		}
+
+		/**
+		 * Replaces the parameters of the triple patterns.
+		 * @param parameters the constants of a query with this shape, see NormalizedQuery::getParameters()
+		 * @return the triple patterns in the order of the operands of the subscript
+		 * @throw std::invalid_argument the number of parameters does not match
+		 */
+		[[nodiscard]] std::vector<TriplePattern> bind(const std::vector<Term> &parameters) const {
+			if (parameters.size() < parameter_count)
+				throw std::invalid_argument{"The query shape has {} parameters but {} were given."_format(
+						parameter_count, parameters.size())};
+			std::vector<TriplePattern> bgps{};
+			bgps.reserve(patterns.size());
+			for (const auto &pattern : patterns) {
+				TriplePattern &tp = bgps.emplace_back(pattern.pattern);
+				for (std::size_t pos = 0; pos < 3; ++pos)
+					if (pattern.parameters[pos])
+						tp[pos] = parameters[*pattern.parameters[pos]];
+			}
+			return bgps;
+		}
+
+		/**
+		 * Estimated bytes owned by this shape.
+		 */
+		[[nodiscard]] std::size_t memoryUsage() const {
+			return memory_usage;
+		}
+
+		[[nodiscard]] const std::string &getShapeStr() const {
+			return shape_string;
+		}
+
+		[[nodiscard]] std::size_t getParameterCount() const {
+			return parameter_count;
+		}
+
+		[[nodiscard]] const std::shared_ptr<Subscript> &getSubscript() const {
+			return subscript;
+		}
+
+		[[nodiscard]] SelectModifier getSelectModifier() const {
+			return select_modifier;
+		}
+
+		[[nodiscard]] const std::vector<Variable> &getQueryVariables() const {
+			return query_variables;
+		}
+	};
+}
+
+#endif //TENTRIS_QUERYSHAPE_HPP
@@ -0,0 +1,204 @@
+#ifndef TENTRIS_SNAPSHOT_HPP
+#define TENTRIS_SNAPSHOT_HPP
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <boost/crc.hpp>
+#include <tbb/parallel_sort.h>
+
+#include "tentris/store/RDF/TermStore.hpp"
+#include "tentris/tensor/BoolHypertrie.hpp"
+#include "tentris/util/LogHelper.hpp"
+#include "tentris/util/MMapFile.hpp"
+
+namespace tentris::store::snapshot {
+
+	namespace {
+		using namespace ::tentris::logging;
+		using namespace fmt::literals;
+	}
+
+	/**
+	 * Binary snapshot of a TermStore and the BoolHypertrie that is keyed by it.
+	 *
+	 * Layout (host byte order):
+	 * <pre>
+	 * Header
+	 * prefixes: prefix_count x (uint32 length, namespace bytes)
+	 * terms:    term_count   x (uint32 prefix id, uint32 length, stored bytes)
+	 * triples:  triple_count x (uint32 subject, uint32 predicate, uint32 object)
+	 * </pre>
+	 * The prefixes and terms are stored as the TermStore keeps them (see rdf::TermStore::Entry): the namespaces of the
+	 * prefix table without the empty one, which is always present, and per term its prefix id and its local name or
+	 * full identifier. Both are stored in the order of their ids, so reading them back needs no parsing and the
+	 * triples are stored with their ids as they are, sorted by key. The body (everything after the header) is protected
+	 * by a CRC-32.
+	 * Inline literals (see rdf::inline_literal) are not part of the terms, their ids are self-contained.
+	 */
+	struct Header {
+		constexpr static std::array<char, 8> expected_magic{'T', 'N', 'T', 'R', 'S', 'N', 'A', 'P'};
+		constexpr static std::uint32_t current_version = 4;
+
+		std::array<char, 8> magic = expected_magic;
+		std::uint32_t version = current_version;
+		std::uint32_t reserved = 0;
+		std::uint64_t prefix_count = 0;
+		std::uint64_t term_count = 0;
+		std::uint64_t triple_count = 0;
+		std::uint64_t body_size = 0;
+		std::uint32_t body_crc32 = 0;
+		std::uint32_t padding = 0;
+	};
+
+	/**
+	 * Writes a snapshot.
+	 * @param term_store dictionary of the store
+	 * @param trie hypertrie of the store
+	 * @param file_path destination file. It is overwritten if it exists.
+	 * @throw std::runtime_error the file could not be written
+	 */
+	inline void write(const rdf::TermStore &term_store, const tensor::const_BoolHypertrie &trie,
+					  const std::string &file_path) {
+		using key_part_type = tensor::key_part_type;
+		std::vector<char> buffer(std::size_t(1) << 20);
+		std::ofstream out{};
+		out.rdbuf()->pubsetbuf(buffer.data(), buffer.size());
+		out.open(file_path, std::ios::binary | std::ios::trunc);
+		if (not out)
+			throw std::runtime_error{"Could not open {} for writing."_format(file_path)};
+
+		Header header{};
+		out.write(reinterpret_cast<const char *>(&header), sizeof(Header)); // filled in at the end
+
+		boost::crc_32_type crc{};
+		auto write_bytes = [&](const void *data, std::size_t size) {
+			out.write(static_cast<const char *>(data), size);
+			crc.process_bytes(data, size);
+			header.body_size += size;
+		};
+
+		for (std::size_t prefix_id = 1; prefix_id < term_store.prefixCount(); ++prefix_id) {
+			const std::string_view namespace_part = term_store.prefix(rdf::TermStore::prefix_id_type(prefix_id));
+			const auto length = std::uint32_t(namespace_part.size());
+			write_bytes(&length, sizeof(length));
+			write_bytes(namespace_part.data(), namespace_part.size());
+			++header.prefix_count;
+		}
+
+		for (std::size_t id = 1; id <= term_store.size(); ++id) {
+			const auto &entry = term_store.entry(rdf::TermStore::id_type(id));
+			write_bytes(&entry.prefix, sizeof(entry.prefix));
+			write_bytes(&entry.length, sizeof(entry.length));
+			write_bytes(entry.data, entry.length);
+			++header.term_count;
+		}
+
+		// the hypertrie iterates in hash order, the triples are sorted so that read() inserts them in key order
+		std::vector<std::array<key_part_type, 3>> keys{};
+		keys.reserve(trie.size());
+		for (const auto &key : trie)
+			keys.push_back({key[0], key[1], key[2]});
+		tbb::parallel_sort(keys.begin(), keys.end());
+		write_bytes(keys.data(), keys.size() * sizeof(std::array<key_part_type, 3>));
+		header.triple_count = keys.size();
+
+		header.body_crc32 = crc.checksum();
+		out.seekp(0);
+		out.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+		out.flush();
+		if (not out)
+			throw std::runtime_error{"Writing the snapshot {} failed."_format(file_path)};
+		log("Snapshot with {} terms and {} triples written to {}."_format(
+				header.term_count, header.triple_count, file_path));
+	}
+
+	/**
+	 * Reads a snapshot into an empty TermStore and BoolHypertrie. The file is memory-mapped. The terms get the same
+	 * ids as when the snapshot was written, so the triples are read without translation.
+	 * The terms are restored from their stored parts without parsing; only their hashes are recomputed because they
+	 * are not stable across processes. The hypertrie offers no bulk construction, so each triple is still inserted
+	 * with set(), but in the key order of the file: consecutive insertions go below the same subject, whose nodes stay
+	 * in cache.
+	 * @param term_store dictionary to fill
+	 * @param trie hypertrie to fill
+	 * @param file_path snapshot file
+	 * @throw std::invalid_argument the file is no snapshot, has an unsupported version or is corrupted
+	 */
+	inline void read(rdf::TermStore &term_store, tensor::BoolHypertrie &trie, const std::string &file_path) {
+		using TermStore = rdf::TermStore;
+		using key_part_type = tensor::key_part_type;
+
+		util::MMapFile file{file_path};
+		if (file.size() < sizeof(Header))
+			throw std::invalid_argument{"{} is too small to be a snapshot."_format(file_path)};
+		Header header{};
+		std::memcpy(&header, file.data(), sizeof(Header));
+		if (header.magic != Header::expected_magic)
+			throw std::invalid_argument{"{} is not a snapshot."_format(file_path)};
+		if (header.version != Header::current_version)
+			throw std::invalid_argument{"Snapshot {} has version {}, but only version {} is supported."_format(
+					file_path, header.version, Header::current_version)};
+		if (header.body_size != file.size() - sizeof(Header))
+			throw std::invalid_argument{"Snapshot {} is truncated."_format(file_path)};
+
+		const char *pos = file.data() + sizeof(Header);
+		const char *const end = pos + header.body_size;
+		boost::crc_32_type crc{};
+		crc.process_block(pos, end);
+		if (crc.checksum() != header.body_crc32)
+			throw std::invalid_argument{"Checksum of snapshot {} does not match."_format(file_path)};
+
+		auto read_bytes = [&](void *dest, std::size_t size) {
+			if (std::size_t(end - pos) < size)
+				throw std::invalid_argument{"Snapshot {} is corrupted."_format(file_path)};
+			std::memcpy(dest, pos, size);
+			pos += size;
+		};
+
+		// the stored strings are copied into the TermStore, so they are only viewed in the mapped file
+		auto read_string = [&]() {
+			std::uint32_t length;
+			read_bytes(&length, sizeof(length));
+			if (std::size_t(end - pos) < length)
+				throw std::invalid_argument{"Snapshot {} is corrupted."_format(file_path)};
+			std::string_view str{pos, length};
+			pos += length;
+			return str;
+		};
+
+		for (std::uint64_t i = 1; i <= header.prefix_count; ++i)
+			if (term_store.restorePrefix(read_string()) != i)
+				throw std::invalid_argument{"Snapshot {} contains a namespace twice."_format(file_path)};
+
+		for (std::uint64_t i = 1; i <= header.term_count; ++i) {
+			TermStore::prefix_id_type prefix_id;
+			read_bytes(&prefix_id, sizeof(prefix_id));
+			if (prefix_id != TermStore::no_prefix and prefix_id >= term_store.prefixCount())
+				throw std::invalid_argument{"Snapshot {} is corrupted."_format(file_path)};
+			if (term_store.restore(prefix_id, read_string()) != i)
+				throw std::invalid_argument{"Snapshot {} contains a term twice."_format(file_path)};
+		}
+
+		for (std::uint64_t i = 0; i < header.triple_count; ++i) {
+			std::array<key_part_type, 3> ids;
+			read_bytes(ids.data(), sizeof(ids));
+			for (auto id : ids)
+				if (not term_store.valid(id))
+					throw std::invalid_argument{"Snapshot {} is corrupted."_format(file_path)};
+			trie.set({ids[0], ids[1], ids[2]}, true);
+		}
+		if (pos != end)
+			throw std::invalid_argument{"Snapshot {} is corrupted."_format(file_path)};
+		log("Snapshot with {} terms and {} triples read from {}."_format(
+				header.term_count, header.triple_count, file_path));
+	}
+}
+
+#endif //TENTRIS_SNAPSHOT_HPP
@@ -2,6 +2,7 @@
 #define TENTRIS_STORE_TRIPLESTORE
 
 
+#include <memory>
 #include <string>
 #include <optional>
 #include <vector>
@@ -10,7 +11,10 @@
 
 #include "tentris/store/RDF/TermStore.hpp"
 #include "tentris/store/RDF/SerdParser.hpp"
+#include "tentris/store/LoadPipeline.hpp"
+#include "tentris/store/Snapshot.hpp"
 #include "tentris/store/SPARQL/ParsedSPARQL.hpp"
+#include "tentris/store/SPARQL/ParsedUpdate.hpp"
 #include "tentris/util/LogHelper.hpp"
 #include "tentris/tensor/BoolHypertrie.hpp"
 #include "tentris/store/SPARQL/TriplePattern.hpp"
@@ -25,47 +29,133 @@ namespace {
 
 namespace tentris::store {
 
+	/**
+	 * Number of triples that an update changed.
+	 */
+	struct UpdateStats {
+		std::size_t inserted = 0;
+		std::size_t deleted = 0;
+	};
+
+	/**
+	 * A triple that an update inserted or deleted.
+	 */
+	struct TripleChange {
+		Key key;
+		bool inserted;
+	};
+
+	/**
+	 * A version of the data: a hypertrie and the dictionary of its terms. The hypertrie changes its nodes in place and
+	 * the operands of a query are slices that share these nodes, so a version that queries may read is not changed.
+	 * Updates are applied to another version instead (see copy() and AtomicTripleStore::update()). Versions of the
+	 * same data share their TermStore, which only grows: an update adds its terms while queries look terms up.
+	 */
 	class TripleStore {
 		using TermStore = tentris::store::rdf::TermStore;
-		TermStore termIndex{};
+		std::shared_ptr<TermStore> termIndex;
 
 		BoolHypertrie trie{3};
 
 	public:
+		TripleStore() : termIndex(std::make_shared<TermStore>()) {}
+
+		/**
+		 * An empty version that shares the dictionary of another one.
+		 */
+		explicit TripleStore(std::shared_ptr<TermStore> term_index) : termIndex(std::move(term_index)) {}
 
 		TermStore &getTermIndex() {
-			return termIndex;
+			return *termIndex;
 		}
 
 		const TermStore &getTermIndex() const {
-			return termIndex;
+			return *termIndex;
 		}
 
 		const_BoolHypertrie getBoolHypertrie() const {
 			return trie;
 		}
 
-		void loadRDF(const std::string &file_path) {
-			using namespace rdf_parser::Turtle;
-
+		/**
+		 * Loads an RDF file into the store.
+		 * @param file_path RDF file
+		 * @param encode_threads number of threads used for dictionary encoding
+		 * @return statistics about the load
+		 * @throw std::invalid_argument the file could not be parsed or contains invalid triples
+		 */
+		LoadStats loadRDF(const std::string &file_path, std::size_t encode_threads = 1) {
 			try {
-				// TurtleParser<FileParser> parser{file_path};
-				unsigned int count = 0;
-				unsigned int _1mios = 0;
-				for (const Triple &triple : rdf::SerdParser{file_path}) {
-					add(triple.subject(), triple.predicate(), triple.object());
-					++count;
-					if (count == 1000000) {
-						count = 0;
-						++_1mios;
-						logDebug("{:d} mio triples loaded."_format(_1mios));
-					}
-				}
-			} catch (...) {
-				throw std::invalid_argument{"A parsing error occurred while parsing {}"_format(file_path)};
+				return LoadPipeline{*termIndex, trie, encode_threads}.run(file_path);
+			} catch (const std::exception &e) {
+				throw std::invalid_argument{"A parsing error occurred while parsing {}: {}"_format(file_path, e.what())};
 			}
 		}
 
+		/**
+		 * Writes the dictionary and the hypertrie to a binary snapshot file.
+		 * @param file_path destination file
+		 * @throw std::runtime_error the file could not be written
+		 */
+		void writeSnapshot(const std::string &file_path) const {
+			snapshot::write(*termIndex, trie, file_path);
+		}
+
+		/**
+		 * Restores the store from a snapshot written by writeSnapshot. The store must be empty.
+		 * @param file_path snapshot file
+		 * @throw std::invalid_argument the file is no valid snapshot
+		 */
+		void loadSnapshot(const std::string &file_path) {
+			if (termIndex->size() != 0 or trie.size() != 0)
+				throw std::logic_error{"A snapshot can only be loaded into an empty TripleStore."};
+			snapshot::read(*termIndex, trie, file_path);
+		}
+
+		/**
+		 * Copies the hypertrie into a new version that shares the TermStore. Runs in O(size()).
+		 */
+		[[nodiscard]] std::shared_ptr<TripleStore> copy() const {
+			auto copy = std::make_shared<TripleStore>(termIndex);
+			for (const auto &key : trie)
+				copy->trie.set(key, true);
+			return copy;
+		}
+
+		/**
+		 * Applies the operations of an update in order. No query may read this version meanwhile. Terms that are no
+		 * longer used by any triple stay in the TermStore.
+		 * @param update parsed INSERT DATA / DELETE DATA operations
+		 * @param changes if given, the triples that were actually inserted or deleted are appended
+		 * @return number of triples that were actually inserted or deleted
+		 */
+		UpdateStats update(const ParsedUpdate &update, std::vector<TripleChange> *changes = nullptr) {
+			UpdateStats stats{};
+			for (const auto &operation : update.getOperations())
+				for (const auto &triple : operation.triples) {
+					const bool insert = operation.type == ParsedUpdate::OperationType::INSERT_DATA;
+					const auto key = (insert) ? insertKey(triple.subject(), triple.predicate(), triple.object())
+											  : removeKey(triple.subject(), triple.predicate(), triple.object());
+					if (not key)
+						continue;
+					if (insert)
+						++stats.inserted;
+					else
+						++stats.deleted;
+					if (changes != nullptr)
+						changes->push_back({*key, insert});
+				}
+			return stats;
+		}
+
+		/**
+		 * Replays the changes of an update on this version. No query may read this version meanwhile.
+		 */
+		void apply(const std::vector<TripleChange> &changes) {
+			for (const auto &change : changes)
+				trie.set(change.key, change.inserted);
+		}
+
 		void add(const std::tuple<std::string, std::string, std::string> &triple) {
 			add(Term::make_term(std::get<0>(triple)),
 				Term::make_term(std::get<1>(triple)),
@@ -80,37 +170,39 @@ namespace tentris::store {
 
 			SliceKey slice_key(3, std::nullopt);
 			for (const auto &[pos, entry] : iter::enumerate(tp)) {
-				if (std::holds_alternative<Term>(entry))
-					try {
-						auto term = termIndex.get(std::get<Term>(entry));
-						slice_key[pos] = term;
-					} catch ([[maybe_unused]] std::out_of_range &exc) {
+				if (std::holds_alternative<Term>(entry)) {
+					auto term = termIndex->find(std::get<Term>(entry));
+					if (term == TermStore::no_id)
 						// a keypart was not in the index so the result is zero anyways.
 						return (slice_count > 0)
 							   ? std::variant<std::optional<const_BoolHypertrie>, bool>{
 										std::optional<const_BoolHypertrie>()}
 							   : std::variant<std::optional<const_BoolHypertrie>, bool>{false};
-					}
+					slice_key[pos] = term;
+				}
 			}
 			return trie[slice_key];
 		}
 
-		inline void
+		/**
+		 * @return if the triple was not contained before
+		 */
+		inline bool
 		add(Term subject, Term predicate, Term object) {
-			if (not subject.isLiteral() and predicate.isURIRef()) {
-				auto subject_id = termIndex[std::move(subject)];
-				auto predicate_id = termIndex[std::move(predicate)];
-				auto object_id = termIndex[std::move(object)];
-				trie.set({subject_id, predicate_id, object_id}, true);
-			} else
-				throw std::invalid_argument{
-						"Subject or predicate of the triple have a term type that is not allowed there."};
+			return insertKey(subject, predicate, object).has_value();
+		}
+
+		/**
+		 * @return if the triple was contained
+		 */
+		bool remove(const Term &subject, const Term &predicate, const Term &object) {
+			return removeKey(subject, predicate, object).has_value();
 		}
 
 		bool contains(std::tuple<std::string, std::string, std::string> triple) {
-			auto subject = termIndex.find(Term::make_term(std::get<0>(triple)));
-			auto predicate = termIndex.find(Term::make_term(std::get<1>(triple)));
-			auto object = termIndex.find(Term::make_term(std::get<2>(triple)));
+			auto subject = termIndex->find(Term::make_term(std::get<0>(triple)));
+			auto predicate = termIndex->find(Term::make_term(std::get<1>(triple)));
+			auto object = termIndex->find(Term::make_term(std::get<2>(triple)));
 			if (subject and predicate and object) {
 				Key key{subject, predicate, object};
 				return trie[key];
@@ -122,6 +214,39 @@ namespace tentris::store {
 			return trie.size();
 		}
 
+	private:
+		/**
+		 * @return the key of the triple if it was not contained before
+		 */
+		std::optional<Key> insertKey(const Term &subject, const Term &predicate, const Term &object) {
+			if (subject.isLiteral() or not predicate.isURIRef())
+				throw std::invalid_argument{
+						"Subject or predicate of the triple have a term type that is not allowed there."};
+			auto subject_id = (*termIndex)[subject];
+			auto predicate_id = (*termIndex)[predicate];
+			auto object_id = (*termIndex)[object];
+			Key key{subject_id, predicate_id, object_id};
+			if (trie[key])
+				return std::nullopt;
+			trie.set(key, true);
+			return key;
+		}
+
+		/**
+		 * @return the key of the triple if it was contained
+		 */
+		std::optional<Key> removeKey(const Term &subject, const Term &predicate, const Term &object) {
+			auto subject_id = termIndex->find(subject);
+			auto predicate_id = termIndex->find(predicate);
+			auto object_id = termIndex->find(object);
+			if (subject_id == TermStore::no_id or predicate_id == TermStore::no_id or object_id == TermStore::no_id)
+				return std::nullopt;
+			Key key{subject_id, predicate_id, object_id};
+			if (not trie[key])
+				return std::nullopt;
+			trie.set(key, false);
+			return key;
+		}
 
 	};
 };
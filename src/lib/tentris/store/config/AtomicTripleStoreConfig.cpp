@@ -6,6 +6,7 @@
 #include <chrono>
 
 #include <tentris/util/SingletonFactory.hpp>
+#include <tentris/util/FrequencySketch.hpp>
 
 
 namespace tentris::store::config {
@@ -31,10 +32,40 @@ namespace tentris::store::config {
 		 * The timeout for query processing of single queries.
 		 */
 		std::chrono::steady_clock::duration timeout = std::chrono::seconds(180);
+		/**
+		 * How long an update waits for queries that read the version of the store before the last update, so that it
+		 * can reuse that version. After that, the current version is copied instead. See AtomicTripleStore::update.
+		 */
+		std::chrono::steady_clock::duration update_wait = std::chrono::seconds(1);
 		/**
 		 * Max number queries that may be cached.
 		 */
 		size_t cache_size = 500;
+		/**
+		 * Max estimated bytes of all cached queries. 0 means no limit.
+		 */
+		size_t cache_bytes = 0;
+		/**
+		 * Decides which queries are cached when the cache is full.
+		 */
+		util::sync::AdmissionPolicy cache_admission = util::sync::AdmissionPolicy::ALWAYS;
+		/**
+		 * Max number of prepared queries. The least recently used one is dropped when a further one is prepared.
+		 */
+		size_t prepared_queries = 1000;
+		/**
+		 * Choose the join order heuristic of queries without sort and weight parameters from the execution times of
+		 * earlier queries with the same shape.
+		 */
+		bool adaptive_planner = false;
+		/**
+		 * Probability that the adaptive planner tries another heuristic than the fastest one.
+		 */
+		double planner_exploration = 0.05;
+		/**
+		 * Number of threads that encode terms when the RDF file is (re)loaded.
+		 */
+		size_t load_threads = 1;
 	};
 
 
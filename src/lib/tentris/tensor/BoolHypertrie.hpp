@@ -5,7 +5,7 @@
 #include "tentris/store/RDF/TermStore.hpp"
 
 namespace tentris::tensor {
-	using key_part_type = store::rdf::TermStore::ptr_type;
+	using key_part_type = store::rdf::TermStore::id_type;
 	using ht = typename hypertrie::template boolhypertrie<key_part_type, hypertrie::internal::container::tsl_sparse_map,
 			hypertrie::internal::container::tsl_sparse_set>;
 
@@ -0,0 +1,88 @@
+#ifndef TENTRIS_PLANNEROPTIONS_HPP
+#define TENTRIS_PLANNEROPTIONS_HPP
+
+#include <optional>
+#include <string_view>
+#include <tuple>
+
+#include <fmt/format.h>
+
+#include "tentris/tensor/BoolHypertrie.hpp"
+
+namespace tentris::tensor {
+
+	/**
+	 * The join order heuristic of a single query. hypertrie/0.5.4 reads it from the process-global
+	 * einsum::internal::sort_order and weight_func, so the Einsum of a query is built and iterated under a
+	 * PlannerOptionsLock::Guard for its heuristic.
+	 */
+	struct PlannerOptions {
+		using SORT = ::einsum::internal::SORT;
+		using WEIGHT = ::einsum::internal::WEIGHT;
+
+		/**
+		 * Which label is resolved next, the one with the minimal, maximal or a random weight.
+		 */
+		SORT sort_order = SORT::MINIMUM;
+		/**
+		 * How the weight of a label is computed.
+		 */
+		WEIGHT weight_func = WEIGHT::CARDINALITY;
+
+		/**
+		 * @param sort_string MINIMUM, MAXIMUM or RANDOM
+		 * @return the sort order or nothing if sort_string names none
+		 */
+		static std::optional<SORT> parseSortOrder(std::string_view sort_string) {
+			if (sort_string == "MINIMUM")
+				return SORT::MINIMUM;
+			else if (sort_string == "MAXIMUM")
+				return SORT::MAXIMUM;
+			else if (sort_string == "RANDOM")
+				return SORT::RANDOM;
+			return std::nullopt;
+		}
+
+		/**
+		 * @param weight_string CARDINALITY or NORMAL
+		 * @return the weight function or nothing if weight_string names none
+		 */
+		static std::optional<WEIGHT> parseWeightFunc(std::string_view weight_string) {
+			if (weight_string == "CARDINALITY")
+				return WEIGHT::CARDINALITY;
+			else if (weight_string == "NORMAL")
+				return WEIGHT::NORMAL;
+			return std::nullopt;
+		}
+
+		bool operator==(const PlannerOptions &other) const {
+			return sort_order == other.sort_order and weight_func == other.weight_func;
+		}
+
+		bool operator!=(const PlannerOptions &other) const {
+			return not(*this == other);
+		}
+
+		bool operator<(const PlannerOptions &other) const {
+			return std::make_tuple(sort_order, weight_func) < std::make_tuple(other.sort_order, other.weight_func);
+		}
+	};
+}
+
+template<>
+struct fmt::formatter<tentris::tensor::PlannerOptions> {
+	template<typename ParseContext>
+	constexpr auto parse(ParseContext &ctx) { return ctx.begin(); }
+
+	template<typename FormatContext>
+	auto format(const tentris::tensor::PlannerOptions &p, FormatContext &ctx) {
+		using SORT = tentris::tensor::PlannerOptions::SORT;
+		using WEIGHT = tentris::tensor::PlannerOptions::WEIGHT;
+		const char *sort_order = (p.sort_order == SORT::MINIMUM) ? "MINIMUM"
+								 : (p.sort_order == SORT::MAXIMUM) ? "MAXIMUM" : "RANDOM";
+		const char *weight_func = (p.weight_func == WEIGHT::CARDINALITY) ? "CARDINALITY" : "NORMAL";
+		return format_to(ctx.out(), "{}/{}", sort_order, weight_func);
+	}
+};
+
+#endif //TENTRIS_PLANNEROPTIONS_HPP
@@ -0,0 +1,164 @@
+#ifndef TENTRIS_PLANNEROPTIONSLOCK_HPP
+#define TENTRIS_PLANNEROPTIONSLOCK_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+#include "tentris/tensor/PlannerOptions.hpp"
+
+namespace tentris::tensor {
+
+	/**
+	 * Hands the process-global einsum::internal::sort_order and weight_func to one join order heuristic at a time.
+	 * hypertrie/0.5.4 reads them when an Einsum is built and whenever it chooses the next label while it is iterated,
+	 * so a query holds a Guard from building its Einsum until it stops iterating it.
+	 *
+	 * Queries with the heuristic that is set run concurrently. A query with another heuristic waits until they are
+	 * done; queries that arrive meanwhile wait behind it. When no query runs, the globals are switched to the next
+	 * waiting heuristic in the order of PlannerOptions::operator<, so every waiting heuristic gets its turn.
+	 */
+	class PlannerOptionsLock {
+		using time_point_t = std::chrono::steady_clock::time_point;
+
+		std::mutex mutex;
+		std::condition_variable switched;
+		/**
+		 * The heuristic in the globals. Only changed while no query holds a guard.
+		 */
+		PlannerOptions current{};
+		/**
+		 * Number of guards.
+		 */
+		std::size_t active = 0;
+		/**
+		 * Number of queries that wait, per heuristic.
+		 */
+		std::map<PlannerOptions, std::size_t> waiting{};
+		/**
+		 * If the globals were switched to current and the queries that wait for it are let in.
+		 */
+		bool admitting = false;
+
+	public:
+		/**
+		 * Releases the heuristic when it is destroyed.
+		 */
+		class Guard {
+			PlannerOptionsLock *lock_ = nullptr;
+
+		public:
+			Guard() = default;
+
+			explicit Guard(PlannerOptionsLock &lock) : lock_(&lock) {}
+
+			Guard(Guard &&other) noexcept : lock_(std::exchange(other.lock_, nullptr)) {}
+
+			Guard &operator=(Guard &&other) noexcept {
+				if (this != &other) {
+					release();
+					lock_ = std::exchange(other.lock_, nullptr);
+				}
+				return *this;
+			}
+
+			Guard(const Guard &) = delete;
+
+			Guard &operator=(const Guard &) = delete;
+
+			~Guard() {
+				release();
+			}
+
+		private:
+			void release() {
+				if (lock_ != nullptr)
+					lock_->release();
+				lock_ = nullptr;
+			}
+		};
+
+		/**
+		 * @return the lock of the globals of this process
+		 */
+		static PlannerOptionsLock &getInstance() {
+			static PlannerOptionsLock instance{};
+			return instance;
+		}
+
+		/**
+		 * Waits until planner_options may be set in the globals and sets them.
+		 * @param planner_options the heuristic of the query
+		 * @param deadline time at which waiting is given up
+		 * @return the guard or nothing if the deadline passed before the heuristic got its turn
+		 */
+		std::optional<Guard> acquire(const PlannerOptions &planner_options,
+									 const time_point_t &deadline = time_point_t::max()) {
+			std::unique_lock<std::mutex> lock(mutex);
+			if (active == 0 and waiting.empty()) {
+				set(planner_options);
+			} else if (not(planner_options == current and (admitting or waiting.empty()))) {
+				++waiting[planner_options];
+				switchIfIdle();
+				const auto turn = [&]() { return admitting and current == planner_options; };
+				bool got_turn = true;
+				if (deadline == time_point_t::max())
+					switched.wait(lock, turn);
+				else
+					got_turn = switched.wait_until(lock, deadline, turn);
+				leave(planner_options);
+				if (not got_turn) {
+					switchIfIdle();
+					return std::nullopt;
+				}
+			}
+			++active;
+			return Guard{*this};
+		}
+
+	private:
+		void release() {
+			std::lock_guard<std::mutex> lock(mutex);
+			--active;
+			switchIfIdle();
+		}
+
+		/**
+		 * Removes a waiting query. If it was the last one waiting for current, the next heuristic may take over.
+		 */
+		void leave(const PlannerOptions &planner_options) {
+			auto found = waiting.find(planner_options);
+			if (--found->second == 0) {
+				waiting.erase(found);
+				if (planner_options == current)
+					admitting = false;
+			}
+		}
+
+		/**
+		 * Switches the globals to the next waiting heuristic after current if no query runs or is about to.
+		 */
+		void switchIfIdle() {
+			if (active != 0 or admitting or waiting.empty())
+				return;
+			auto next = waiting.upper_bound(current);
+			if (next == waiting.end())
+				next = waiting.begin();
+			set(next->first);
+			admitting = true;
+			switched.notify_all();
+		}
+
+		void set(const PlannerOptions &planner_options) {
+			current = planner_options;
+			::einsum::internal::sort_order = planner_options.sort_order;
+			::einsum::internal::weight_func = planner_options.weight_func;
+		}
+	};
+}
+
+#endif //TENTRIS_PLANNEROPTIONSLOCK_HPP
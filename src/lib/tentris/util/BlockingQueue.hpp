@@ -0,0 +1,122 @@
+#ifndef TENTRIS_BLOCKINGQUEUE_HPP
+#define TENTRIS_BLOCKINGQUEUE_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+namespace tentris::util::sync {
+
+	/**
+	 * Counts how often producers and consumers of a BlockingQueue had to wait.
+	 */
+	struct QueueStalls {
+		/**
+		 * Number of push calls that blocked because the queue was full.
+		 */
+		std::size_t producer_stalls = 0;
+		/**
+		 * Number of pop calls that blocked because the queue was empty.
+		 */
+		std::size_t consumer_stalls = 0;
+	};
+
+	/**
+	 * A bounded multi-producer/multi-consumer queue. push blocks while the queue is full and pop blocks while it is
+	 * empty. After close() was called, push fails and pop drains the remaining elements before it returns std::nullopt.
+	 * Waiting threads sleep on condition variables, so neither side spins. To keep the locking overhead low for small
+	 * elements, hand over batches (e.g. std::vector<T>) instead of single elements.
+	 * @tparam T element type
+	 */
+	template<typename T>
+	class BlockingQueue {
+		using Lock = std::mutex;
+		using UniqueLock = std::unique_lock<Lock>;
+		using Guard = std::lock_guard<Lock>;
+
+		mutable Lock lock_;
+		std::condition_variable not_full_;
+		std::condition_variable not_empty_;
+		std::deque<T> queue_;
+		std::size_t capacity_;
+		bool closed_ = false;
+		std::atomic<std::size_t> producer_stalls_{0};
+		std::atomic<std::size_t> consumer_stalls_{0};
+
+	public:
+		explicit BlockingQueue(std::size_t capacity) : capacity_((capacity == 0) ? 1 : capacity) {}
+
+		BlockingQueue(const BlockingQueue &) = delete;
+
+		BlockingQueue &operator=(const BlockingQueue &) = delete;
+
+		/**
+		 * Adds an element. Blocks while the queue is full.
+		 * @return false if the queue was closed before the element could be added.
+		 */
+		bool push(T value) {
+			UniqueLock lock{lock_};
+			if (not closed_ and queue_.size() >= capacity_) {
+				producer_stalls_.fetch_add(1, std::memory_order_relaxed);
+				not_full_.wait(lock, [this]() { return closed_ or queue_.size() < capacity_; });
+			}
+			if (closed_)
+				return false;
+			queue_.push_back(std::move(value));
+			lock.unlock();
+			not_empty_.notify_one();
+			return true;
+		}
+
+		/**
+		 * Removes the first element. Blocks while the queue is empty and open.
+		 * @return the element or std::nullopt if the queue is closed and empty.
+		 */
+		std::optional<T> pop() {
+			UniqueLock lock{lock_};
+			if (not closed_ and queue_.empty()) {
+				consumer_stalls_.fetch_add(1, std::memory_order_relaxed);
+				not_empty_.wait(lock, [this]() { return closed_ or not queue_.empty(); });
+			}
+			if (queue_.empty())
+				return std::nullopt;
+			std::optional<T> value{std::move(queue_.front())};
+			queue_.pop_front();
+			lock.unlock();
+			not_full_.notify_one();
+			return value;
+		}
+
+		/**
+		 * Closes the queue. Waiting producers and consumers are woken up.
+		 */
+		void close() {
+			{
+				Guard g{lock_};
+				closed_ = true;
+			}
+			not_full_.notify_all();
+			not_empty_.notify_all();
+		}
+
+		[[nodiscard]] bool closed() const {
+			Guard g{lock_};
+			return closed_;
+		}
+
+		[[nodiscard]] std::size_t size() const {
+			Guard g{lock_};
+			return queue_.size();
+		}
+
+		[[nodiscard]] QueueStalls stalls() const {
+			return {producer_stalls_.load(std::memory_order_relaxed),
+					consumer_stalls_.load(std::memory_order_relaxed)};
+		}
+	};
+}
+
+#endif //TENTRIS_BLOCKINGQUEUE_HPP
@@ -0,0 +1,65 @@
+#ifndef TENTRIS_CACHESTATS_HPP
+#define TENTRIS_CACHESTATS_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include <fmt/format.h>
+
+namespace tentris::util::sync {
+
+	/**
+	 * Counters of a query cache. Lock hold times are measured for every exclusive acquisition of a cache mutex.
+	 */
+	struct CacheStats {
+		std::size_t hits = 0;
+		std::size_t misses = 0;
+		/**
+		 * Misses that waited for a construction of the same key that was already running.
+		 */
+		std::size_t coalesced = 0;
+		std::size_t evictions = 0;
+		/**
+		 * Constructed values that the admission policy did not cache.
+		 */
+		std::size_t rejections = 0;
+		/**
+		 * Estimated bytes of all cached entries. 0 if the cache does not estimate memory.
+		 */
+		std::size_t bytes = 0;
+		std::size_t lock_acquisitions = 0;
+		std::chrono::nanoseconds total_lock_hold{0};
+		std::chrono::nanoseconds max_lock_hold{0};
+
+		/**
+		 * @return hits / lookups, 0 without lookups
+		 */
+		[[nodiscard]] double hitRate() const {
+			return (hits + misses == 0) ? 0.0 : double(hits) / double(hits + misses);
+		}
+
+		[[nodiscard]] std::chrono::nanoseconds meanLockHold() const {
+			return (lock_acquisitions == 0) ? std::chrono::nanoseconds{0}
+											: total_lock_hold / std::int64_t(lock_acquisitions);
+		}
+	};
+}
+
+template<>
+struct fmt::formatter<tentris::util::sync::CacheStats> {
+	template<typename ParseContext>
+	constexpr auto parse(ParseContext &ctx) { return ctx.begin(); }
+
+	template<typename FormatContext>
+	auto format(const tentris::util::sync::CacheStats &stats, FormatContext &ctx) {
+		return format_to(ctx.begin(),
+						 "hits: {}, misses: {} ({} coalesced), hit rate: {:.3f}, evictions: {}, rejections: {}, "
+						 "bytes: {}, lock held {} times, mean {} ns, max {} ns",
+						 stats.hits, stats.misses, stats.coalesced, stats.hitRate(), stats.evictions, stats.rejections,
+						 stats.bytes, stats.lock_acquisitions,
+						 stats.meanLockHold().count(), stats.max_lock_hold.count());
+	}
+};
+
+#endif //TENTRIS_CACHESTATS_HPP
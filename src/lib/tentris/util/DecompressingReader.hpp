@@ -0,0 +1,235 @@
+#ifndef TENTRIS_DECOMPRESSINGREADER_HPP
+#define TENTRIS_DECOMPRESSINGREADER_HPP
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filter/bzip2.hpp>
+#include <fmt/format.h>
+#include <zstd.h>
+
+#include "tentris/util/BlockingQueue.hpp"
+
+namespace tentris::util {
+
+	/**
+	 * Reads a file or stdin and decompresses it on a separate thread. The decompressed data is handed over in chunks
+	 * through a bounded queue, so reading, decompressing and parsing overlap and nothing is written to disk.
+	 *
+	 * The compression is chosen by the file extension: .gz (gzip), .bz2 (bzip2), .zst (zstd). Other files are read as
+	 * they are. The path "-" stands for stdin; stdin is not decompressed.
+	 */
+	class DecompressingReader {
+	public:
+		enum struct Compression {
+			none, gzip, bzip2, zstd
+		};
+
+		constexpr static std::size_t chunk_size = std::size_t(1) << 20;
+		constexpr static std::size_t queue_capacity = 8;
+
+		static bool isStdin(const std::string &file_path) {
+			return file_path == "-";
+		}
+
+		static Compression compressionOf(const std::string &file_path) {
+			auto ends_with = [&](std::string_view extension) {
+				return file_path.size() >= extension.size()
+					   and std::string_view{file_path}.substr(file_path.size() - extension.size()) == extension;
+			};
+			if (ends_with(".gz"))
+				return Compression::gzip;
+			if (ends_with(".bz2"))
+				return Compression::bzip2;
+			if (ends_with(".zst"))
+				return Compression::zstd;
+			return Compression::none;
+		}
+
+		/**
+		 * @return if the input can not be read directly as a regular file
+		 */
+		static bool needsReader(const std::string &file_path) {
+			return isStdin(file_path) or compressionOf(file_path) != Compression::none;
+		}
+
+	private:
+		/**
+		 * State shared with the decompression thread. The thread keeps it alive, so the reader can be destroyed while
+		 * the thread is still blocked on its input.
+		 */
+		struct State {
+			sync::BlockingQueue<std::string> chunks{queue_capacity};
+			std::mutex error_lock{};
+			std::optional<std::string> error{};
+
+			void fail(std::string message) {
+				{
+					std::lock_guard<std::mutex> g{error_lock};
+					if (not error)
+						error = std::move(message);
+				}
+				chunks.close();
+			}
+		};
+
+		std::shared_ptr<State> state = std::make_shared<State>();
+		std::string file_path_;
+		std::string current{};
+		std::size_t current_pos = 0;
+
+	public:
+		/**
+		 * Starts reading.
+		 * @param file_path path to the input or "-" for stdin
+		 */
+		explicit DecompressingReader(std::string file_path) : file_path_(std::move(file_path)) {
+			std::thread t([state = this->state, file_path = this->file_path_]() {
+				try {
+					produce(*state, file_path);
+				} catch (const std::exception &e) {
+					state->fail(fmt::format("Reading {} failed: {}", file_path, e.what()));
+				}
+				state->chunks.close();
+			});
+			t.detach();
+		}
+
+		DecompressingReader(const DecompressingReader &) = delete;
+
+		DecompressingReader &operator=(const DecompressingReader &) = delete;
+
+		~DecompressingReader() {
+			// stops the decompression thread if it is waiting for the consumer
+			state->chunks.close();
+		}
+
+		/**
+		 * Reads up to size decompressed bytes.
+		 * @return number of bytes written to dest. 0 means the input is exhausted or failed (see error()).
+		 */
+		std::size_t read(char *dest, std::size_t size) {
+			std::size_t written = 0;
+			while (written < size) {
+				if (current_pos == current.size()) {
+					auto next = state->chunks.pop();
+					if (not next)
+						break;
+					current = std::move(*next);
+					current_pos = 0;
+				}
+				const std::size_t count = std::min(size - written, current.size() - current_pos);
+				std::memcpy(dest + written, current.data() + current_pos, count);
+				current_pos += count;
+				written += count;
+			}
+			return written;
+		}
+
+		/**
+		 * @return the error that stopped reading, if any
+		 */
+		[[nodiscard]] std::optional<std::string> error() const {
+			std::lock_guard<std::mutex> g{state->error_lock};
+			return state->error;
+		}
+
+		[[nodiscard]] const std::string &path() const {
+			return file_path_;
+		}
+
+		/**
+		 * Read function with the signature of fread, usable as SerdSource.
+		 */
+		static std::size_t freadSource(void *buffer, std::size_t size, std::size_t nmemb, void *stream) {
+			auto &reader = *static_cast<DecompressingReader *>(stream);
+			return reader.read(static_cast<char *>(buffer), size * nmemb) / size;
+		}
+
+		/**
+		 * Error function with the signature of ferror, usable as SerdStreamErrorFunc.
+		 */
+		static int ferrorSource(void *stream) {
+			auto &reader = *static_cast<DecompressingReader *>(stream);
+			return reader.error() ? 1 : 0;
+		}
+
+	private:
+		static void produce(State &state, const std::string &file_path) {
+			std::ifstream file{};
+			std::istream *raw = &std::cin;
+			if (not isStdin(file_path)) {
+				file.open(file_path, std::ios::binary);
+				if (not file)
+					throw std::runtime_error{"could not open the file"};
+				raw = &file;
+			}
+			const Compression compression = isStdin(file_path) ? Compression::none : compressionOf(file_path);
+
+			if (compression == Compression::zstd) {
+				produceZstd(state, *raw);
+				return;
+			}
+
+			boost::iostreams::filtering_istream in{};
+			if (compression == Compression::gzip)
+				in.push(boost::iostreams::gzip_decompressor{});
+			else if (compression == Compression::bzip2)
+				in.push(boost::iostreams::bzip2_decompressor{});
+			in.push(*raw);
+			while (in) {
+				std::string chunk(chunk_size, '\0');
+				in.read(chunk.data(), chunk.size());
+				chunk.resize(std::size_t(in.gcount()));
+				if (chunk.empty())
+					break;
+				if (not state.chunks.push(std::move(chunk)))
+					return;
+			}
+			if (in.bad())
+				throw std::runtime_error{"decompression failed"};
+		}
+
+		static void produceZstd(State &state, std::istream &raw) {
+			std::unique_ptr<ZSTD_DStream, decltype(&ZSTD_freeDStream)> stream{ZSTD_createDStream(),
+																			   &ZSTD_freeDStream};
+			ZSTD_initDStream(stream.get());
+			std::string input(ZSTD_DStreamInSize(), '\0');
+			std::size_t last_result = 0;
+			while (raw) {
+				raw.read(input.data(), input.size());
+				ZSTD_inBuffer in_buffer{input.data(), std::size_t(raw.gcount()), 0};
+				if (in_buffer.size == 0)
+					break;
+				// a full output buffer means the decoder may still hold data even if all input was consumed
+				bool output_full = false;
+				while (in_buffer.pos < in_buffer.size or output_full) {
+					std::string chunk(chunk_size, '\0');
+					ZSTD_outBuffer out_buffer{chunk.data(), chunk.size(), 0};
+					last_result = ZSTD_decompressStream(stream.get(), &out_buffer, &in_buffer);
+					if (ZSTD_isError(last_result))
+						throw std::runtime_error{fmt::format("zstd: {}", ZSTD_getErrorName(last_result))};
+					output_full = out_buffer.pos == out_buffer.size;
+					chunk.resize(out_buffer.pos);
+					if (not chunk.empty() and not state.chunks.push(std::move(chunk)))
+						return;
+				}
+			}
+			if (last_result != 0)
+				throw std::runtime_error{"zstd: the input is truncated"};
+		}
+	};
+}
+
+#endif //TENTRIS_DECOMPRESSINGREADER_HPP
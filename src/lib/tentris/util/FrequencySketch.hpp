@@ -0,0 +1,111 @@
+#ifndef TENTRIS_FREQUENCYSKETCH_HPP
+#define TENTRIS_FREQUENCYSKETCH_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace tentris::util::sync {
+
+	/**
+	 * Decides which constructed values a cache keeps.
+	 */
+	enum class AdmissionPolicy {
+		/**
+		 * Every value is cached, evicting others if needed.
+		 */
+		ALWAYS,
+		/**
+		 * When the cache is full, a value is only cached if its key was requested more often recently than the key of
+		 * the entry it would evict (TinyLFU). One-off keys therefore do not displace frequently used ones.
+		 */
+		TINY_LFU
+	};
+
+	/**
+	 * Approximate access frequencies of recent keys for TinyLFU admission. A count-min sketch with 4 rows of saturating
+	 * counters (max 15). After sample_size recorded accesses, all counters are halved, so old popularity fades.
+	 *
+	 * record() and estimate() may run concurrently; age() must not run concurrently with them.
+	 */
+	class FrequencySketch {
+		constexpr static std::size_t depth = 4;
+		constexpr static std::uint8_t max_count = 15;
+		constexpr static std::array<std::uint64_t, depth> seeds{0x9E3779B97F4A7C15ULL, 0xC2B2AE3D27D4EB4FULL,
+																0x165667B19E3779F9ULL, 0xD6E8FEB86659FD93ULL};
+		constexpr static std::size_t max_width_bits = 16;
+
+		std::size_t width_bits;
+		std::unique_ptr<std::atomic<std::uint8_t>[]> counters;
+		std::size_t sample_size;
+		std::atomic<std::size_t> additions{0};
+
+	public:
+		/**
+		 * @param capacity number of entries of the cache the sketch belongs to
+		 */
+		explicit FrequencySketch(std::size_t capacity) {
+			// each row has about 4 counters per cached entry, so the one-off keys of a sample rarely collide with a hot key
+			width_bits = 4;
+			while (width_bits < max_width_bits and (std::size_t(1) << width_bits) < 4 * capacity)
+				++width_bits;
+			const std::size_t size = depth << width_bits;
+			counters = std::make_unique<std::atomic<std::uint8_t>[]>(size);
+			for (std::size_t i = 0; i < size; ++i)
+				counters[i].store(0, std::memory_order_relaxed);
+			sample_size = 10 * std::max<std::size_t>(capacity, 1);
+		}
+
+		/**
+		 * Counts an access to the key with the given hash.
+		 */
+		void record(std::size_t hash) {
+			for (std::size_t row = 0; row < depth; ++row) {
+				auto &counter = counters[index(row, hash)];
+				auto count = counter.load(std::memory_order_relaxed);
+				// saturated counters of hot keys are not written, so their cache lines are not contended
+				while (count < max_count and
+					   not counter.compare_exchange_weak(count, std::uint8_t(count + 1), std::memory_order_relaxed)) {}
+			}
+			additions.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		/**
+		 * @return estimated number of recent accesses to the key with the given hash
+		 */
+		[[nodiscard]] std::uint8_t estimate(std::size_t hash) const {
+			std::uint8_t count = max_count;
+			for (std::size_t row = 0; row < depth; ++row)
+				count = std::min(count, counters[index(row, hash)].load(std::memory_order_relaxed));
+			return count;
+		}
+
+		/**
+		 * @return if age() is due
+		 */
+		[[nodiscard]] bool needsAging() const {
+			return additions.load(std::memory_order_relaxed) >= sample_size;
+		}
+
+		/**
+		 * Halves all counters.
+		 */
+		void age() {
+			const std::size_t size = depth << width_bits;
+			for (std::size_t i = 0; i < size; ++i)
+				counters[i].store(counters[i].load(std::memory_order_relaxed) / 2, std::memory_order_relaxed);
+			additions.store(0, std::memory_order_relaxed);
+		}
+
+	private:
+		[[nodiscard]] std::size_t index(std::size_t row, std::size_t hash) const {
+			const std::uint64_t mixed = (std::uint64_t(hash) ^ seeds[row]) * seeds[row];
+			return (row << width_bits) + std::size_t(mixed >> (64 - width_bits));
+		}
+	};
+}
+
+#endif //TENTRIS_FREQUENCYSKETCH_HPP
@@ -0,0 +1,77 @@
+#ifndef TENTRIS_MMAPFILE_HPP
+#define TENTRIS_MMAPFILE_HPP
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fmt/format.h>
+
+namespace tentris::util {
+
+	/**
+	 * A file that is memory-mapped read-only for the lifetime of the object.
+	 */
+	class MMapFile {
+		std::string file_path_;
+		const char *data_ = nullptr;
+		std::size_t size_ = 0;
+
+	public:
+		/**
+		 * Maps the file.
+		 * @param file_path path to the file
+		 * @param sequential advise the kernel that the file is read front to back
+		 * @throw std::runtime_error the file could not be opened or mapped
+		 */
+		explicit MMapFile(std::string file_path, bool sequential = true) : file_path_(std::move(file_path)) {
+			int fd = ::open(file_path_.c_str(), O_RDONLY);
+			if (fd == -1)
+				throw std::runtime_error{fmt::format("Could not open {}: {}", file_path_, std::strerror(errno))};
+			struct stat file_stat{};
+			if (::fstat(fd, &file_stat) == -1) {
+				::close(fd);
+				throw std::runtime_error{fmt::format("Could not stat {}: {}", file_path_, std::strerror(errno))};
+			}
+			size_ = std::size_t(file_stat.st_size);
+			if (size_ != 0) {
+				void *mapped = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+				if (mapped == MAP_FAILED) {
+					::close(fd);
+					throw std::runtime_error{fmt::format("Could not mmap {}: {}", file_path_, std::strerror(errno))};
+				}
+				if (sequential)
+					::madvise(mapped, size_, MADV_SEQUENTIAL);
+				data_ = static_cast<const char *>(mapped);
+			}
+			// the mapping stays valid after the descriptor is closed
+			::close(fd);
+		}
+
+		MMapFile(const MMapFile &) = delete;
+
+		MMapFile &operator=(const MMapFile &) = delete;
+
+		~MMapFile() {
+			if (data_ != nullptr)
+				::munmap(const_cast<char *>(data_), size_);
+		}
+
+		[[nodiscard]] const char *data() const { return data_; }
+
+		[[nodiscard]] std::size_t size() const { return size_; }
+
+		[[nodiscard]] std::string_view view() const { return {data_, size_}; }
+
+		[[nodiscard]] const std::string &path() const { return file_path_; }
+	};
+}
+
+#endif //TENTRIS_MMAPFILE_HPP
@@ -0,0 +1,434 @@
+#ifndef TENTRIS_SHARDEDCLOCKCACHE_HPP
+#define TENTRIS_SHARDEDCLOCKCACHE_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <limits>
+#include <shared_mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <absl/hash/hash.h>
+#include <tsl/hopscotch_map.h>
+
+#include "tentris/util/CacheStats.hpp"
+#include "tentris/util/FrequencySketch.hpp"
+
+namespace tentris::util::sync {
+
+	namespace detail {
+		template<typename T, typename = void>
+		struct has_memory_usage : std::false_type {};
+
+		template<typename T>
+		struct has_memory_usage<T, std::void_t<decltype(std::declval<const T &>().memoryUsage())>>
+				: std::true_type {};
+
+		template<typename T, typename = void>
+		struct has_capacity : std::false_type {};
+
+		template<typename T>
+		struct has_capacity<T, std::void_t<decltype(std::declval<const T &>().capacity())>> : std::true_type {};
+	}
+
+	/**
+	 * A concurrent cache that evicts with the CLOCK (second chance) policy. The keys are distributed over shards by
+	 * their hash. A hit takes the shard's lock only shared and marks the entry as referenced with an atomic flag, so
+	 * hits never wait for each other, not even on the same key. Misses, evictions and clear() take the shard's lock
+	 * exclusively. Like SyncedLRUCache, a value is constructed from its key outside of any lock and concurrent misses
+	 * of the same key wait for a single construction.
+	 *
+	 * The cache is bounded by the number of entries and optionally by their estimated memory footprint. Both limits
+	 * apply to the whole cache, not to single shards. An entry's footprint is Value::memoryUsage() if Value provides it
+	 * (sizeof(Value) otherwise) plus the key and bookkeeping. Its cost is the time its construction took. A new entry
+	 * evicts from its own shard first: the hand inspects a few entries, gives referenced ones their second chance and
+	 * evicts the one with the lowest cost per byte, so cheap and large entries go first. If its shard runs empty
+	 * before the cache is within its limits, the other shards evict in turn.
+	 *
+	 * With AdmissionPolicy::TINY_LFU, every shard counts the accesses to its keys in a FrequencySketch. A new value
+	 * that would require an eviction from its shard is only cached if its key was requested more often recently than
+	 * the victim's.
+	 * @tparam Key key type, hashed with absl::Hash
+	 * @tparam Value constructible from const Key &
+	 */
+	template<class Key, class Value>
+	class ShardedClockCache {
+	public:
+		using value_ptr = std::shared_ptr<Value>;
+
+		constexpr static std::size_t shard_bits = 4;
+		constexpr static std::size_t shard_count = std::size_t(1) << shard_bits;
+		/**
+		 * Number of entries the hand inspects to choose a victim.
+		 */
+		constexpr static std::size_t eviction_samples = 8;
+
+	private:
+		struct Entry {
+			Key key;
+			std::size_t hash;
+			value_ptr value;
+			std::size_t bytes;
+			/**
+			 * construction time in nanoseconds per byte
+			 */
+			double cost_per_byte;
+			std::atomic<bool> referenced{false};
+
+			Entry(Key key, std::size_t hash, value_ptr value, std::size_t bytes, std::chrono::nanoseconds cost)
+					: key(std::move(key)), hash(hash), value(std::move(value)), bytes(bytes),
+					  cost_per_byte(double(cost.count()) / double(bytes)) {}
+		};
+
+		struct alignas(64) Shard {
+			mutable std::shared_mutex lock;
+			/**
+			 * key -> position in ring
+			 */
+			tsl::hopscotch_map<Key, std::size_t, absl::Hash<Key>> index{};
+			/**
+			 * The entries in clock order. The hand points to the next eviction candidate.
+			 */
+			std::vector<std::unique_ptr<Entry>> ring{};
+			std::size_t hand = 0;
+			tsl::hopscotch_map<Key, std::shared_future<value_ptr>, absl::Hash<Key>> pending{};
+			std::size_t generation = 0;
+			/**
+			 * Only used with AdmissionPolicy::TINY_LFU.
+			 */
+			std::unique_ptr<FrequencySketch> sketch{};
+
+			mutable std::atomic<std::size_t> hits{0};
+			mutable std::atomic<std::size_t> misses{0};
+			mutable std::atomic<std::size_t> coalesced{0};
+			mutable std::atomic<std::size_t> evictions{0};
+			mutable std::atomic<std::size_t> rejections{0};
+			mutable std::atomic<std::size_t> lock_acquisitions{0};
+			mutable std::atomic<std::int64_t> total_lock_hold_ns{0};
+			mutable std::atomic<std::int64_t> max_lock_hold_ns{0};
+		};
+
+		/**
+		 * Locks a shard exclusively and records how long it was held.
+		 */
+		class Guard {
+			const Shard &shard_;
+			std::unique_lock<std::shared_mutex> lock_;
+			std::chrono::steady_clock::time_point acquired_;
+
+		public:
+			explicit Guard(const Shard &shard)
+					: shard_(shard), lock_(shard.lock), acquired_(std::chrono::steady_clock::now()) {}
+
+			~Guard() {
+				const std::int64_t held_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+						std::chrono::steady_clock::now() - acquired_).count();
+				lock_.unlock();
+				shard_.lock_acquisitions.fetch_add(1, std::memory_order_relaxed);
+				shard_.total_lock_hold_ns.fetch_add(held_ns, std::memory_order_relaxed);
+				auto max = shard_.max_lock_hold_ns.load(std::memory_order_relaxed);
+				while (held_ns > max and
+					   not shard_.max_lock_hold_ns.compare_exchange_weak(max, held_ns, std::memory_order_relaxed)) {}
+			}
+		};
+
+		std::unique_ptr<std::array<Shard, shard_count>> shards_ = std::make_unique<std::array<Shard, shard_count>>();
+		std::size_t max_size_;
+		std::size_t max_bytes_;
+		std::size_t byte_budget_;
+		AdmissionPolicy admission_;
+		/**
+		 * Entries and their bytes in all shards. Changed under the lock of the shard that holds the entry, so they
+		 * may exceed the limits briefly while other shards evict.
+		 */
+		std::atomic<std::size_t> size_{0};
+		std::atomic<std::size_t> bytes_{0};
+		/**
+		 * The next shard that evicts for a shard that ran empty.
+		 */
+		std::atomic<std::size_t> next_evicting_shard_{0};
+
+	public:
+		/**
+		 * @param max_size number of cached values. max_size = 0 disables caching, but concurrent misses are still
+		 * coalesced.
+		 * @param max_bytes estimated bytes of all cached entries. An entry that is larger than that is not cached.
+		 * 0 means no limit.
+		 * @param admission decides if a new value may evict cached ones
+		 */
+		explicit ShardedClockCache(std::size_t max_size = 1000, std::size_t max_bytes = 0,
+								   AdmissionPolicy admission = AdmissionPolicy::ALWAYS)
+				: max_size_(max_size), max_bytes_(max_bytes),
+				  byte_budget_((max_bytes == 0) ? std::numeric_limits<std::size_t>::max() : max_bytes),
+				  admission_(admission) {
+			if (admission == AdmissionPolicy::TINY_LFU)
+				for (auto &shard : *shards_)
+					// sized for the share of the keys a shard sees
+					shard.sketch = std::make_unique<FrequencySketch>((max_size + shard_count - 1) / shard_count);
+		}
+
+		ShardedClockCache(const ShardedClockCache &) = delete;
+
+		ShardedClockCache &operator=(const ShardedClockCache &) = delete;
+
+		/**
+		 * Returns the cached value of key. On a miss, the value is constructed without holding a lock.
+		 * @throw any exception of the value's constructor. It is thrown to all waiting callers and nothing is cached.
+		 */
+		[[nodiscard]] value_ptr operator[](const Key &key) {
+			const std::size_t hash = absl::Hash<Key>()(key);
+			Shard &shard = shardOf(hash);
+			{
+				std::shared_lock<std::shared_mutex> read_lock{shard.lock};
+				if (const auto found = shard.index.find(key, hash); found != shard.index.end()) {
+					Entry &entry = *shard.ring[found->second];
+					// only write the flag if it changes, so hits on a hot entry do not bounce its cache line
+					if (not entry.referenced.load(std::memory_order_relaxed))
+						entry.referenced.store(true, std::memory_order_relaxed);
+					if (shard.sketch)
+						shard.sketch->record(hash);
+					shard.hits.fetch_add(1, std::memory_order_relaxed);
+					return entry.value;
+				}
+			}
+
+			std::shared_future<value_ptr> in_flight;
+			std::promise<value_ptr> promise;
+			std::size_t generation = 0;
+			{
+				Guard g(shard);
+				if (shard.sketch) {
+					if (shard.sketch->needsAging())
+						shard.sketch->age();
+					shard.sketch->record(hash);
+				}
+				if (const auto found = shard.index.find(key, hash); found != shard.index.end()) {
+					// inserted by another thread since the shared lock was released
+					shard.hits.fetch_add(1, std::memory_order_relaxed);
+					return shard.ring[found->second]->value;
+				}
+				shard.misses.fetch_add(1, std::memory_order_relaxed);
+				if (const auto pending = shard.pending.find(key, hash); pending != shard.pending.end()) {
+					shard.coalesced.fetch_add(1, std::memory_order_relaxed);
+					in_flight = pending->second;
+				} else {
+					shard.pending.emplace(key, promise.get_future().share());
+					generation = shard.generation;
+				}
+			}
+			if (in_flight.valid())
+				return in_flight.get();
+
+			value_ptr value;
+			const auto construction_start = std::chrono::steady_clock::now();
+			try {
+				value = std::make_shared<Value>(key);
+			} catch (...) {
+				{
+					Guard g(shard);
+					shard.pending.erase(key, hash);
+				}
+				promise.set_exception(std::current_exception());
+				throw;
+			}
+			const auto cost = std::chrono::duration_cast<std::chrono::nanoseconds>(
+					std::chrono::steady_clock::now() - construction_start);
+			const std::size_t bytes = entryBytes(key, *value);
+			bool inserted = false;
+			{
+				Guard g(shard);
+				shard.pending.erase(key, hash);
+				if (generation == shard.generation and max_size_ != 0 and bytes <= byte_budget_)
+					inserted = insert(shard, key, hash, value, bytes, cost);
+			}
+			if (inserted)
+				evictFromOtherShards(shard);
+			promise.set_value(value);
+			return value;
+		}
+
+		void clear() {
+			for (auto &shard : *shards_) {
+				Guard g(shard);
+				for (const auto &entry : shard.ring) {
+					size_.fetch_sub(1, std::memory_order_relaxed);
+					bytes_.fetch_sub(entry->bytes, std::memory_order_relaxed);
+				}
+				shard.index.clear();
+				shard.ring.clear();
+				shard.hand = 0;
+				++shard.generation;
+			}
+		}
+
+		void erase(const Key &key) {
+			const std::size_t hash = absl::Hash<Key>()(key);
+			Shard &shard = shardOf(hash);
+			Guard g(shard);
+			++shard.generation;
+			if (const auto found = shard.index.find(key, hash); found != shard.index.end())
+				remove(shard, found->second);
+		}
+
+		[[nodiscard]] std::size_t size() const {
+			return size_.load(std::memory_order_relaxed);
+		}
+
+		[[nodiscard]] bool empty() const {
+			return size() == 0;
+		}
+
+		[[nodiscard]] std::size_t getMaxSize() const { return max_size_; }
+
+		/**
+		 * @return the byte budget; 0 means no limit
+		 */
+		[[nodiscard]] std::size_t getMaxBytes() const { return max_bytes_; }
+
+		[[nodiscard]] AdmissionPolicy getAdmissionPolicy() const { return admission_; }
+
+		[[nodiscard]] CacheStats stats() const {
+			CacheStats stats{};
+			std::int64_t total_lock_hold_ns = 0;
+			std::int64_t max_lock_hold_ns = 0;
+			for (const auto &shard : *shards_) {
+				stats.hits += shard.hits.load(std::memory_order_relaxed);
+				stats.misses += shard.misses.load(std::memory_order_relaxed);
+				stats.coalesced += shard.coalesced.load(std::memory_order_relaxed);
+				stats.evictions += shard.evictions.load(std::memory_order_relaxed);
+				stats.rejections += shard.rejections.load(std::memory_order_relaxed);
+				stats.lock_acquisitions += shard.lock_acquisitions.load(std::memory_order_relaxed);
+				total_lock_hold_ns += shard.total_lock_hold_ns.load(std::memory_order_relaxed);
+				max_lock_hold_ns = std::max(max_lock_hold_ns, shard.max_lock_hold_ns.load(std::memory_order_relaxed));
+			}
+			stats.bytes = bytes_.load(std::memory_order_relaxed);
+			stats.total_lock_hold = std::chrono::nanoseconds{total_lock_hold_ns};
+			stats.max_lock_hold = std::chrono::nanoseconds{max_lock_hold_ns};
+			return stats;
+		}
+
+	private:
+		Shard &shardOf(std::size_t hash) const {
+			// the high bits select the shard, the low bits are used by the shard's index
+			return (*shards_)[hash >> (sizeof(std::size_t) * 8 - shard_bits)];
+		}
+
+		static std::size_t entryBytes(const Key &key, const Value &value) {
+			std::size_t bytes = sizeof(Entry) + sizeof(std::unique_ptr<Entry>) + sizeof(Key) + sizeof(std::size_t);
+			if constexpr (detail::has_capacity<Key>::value)
+				bytes += key.capacity();
+			if constexpr (detail::has_memory_usage<Value>::value)
+				bytes += value.memoryUsage();
+			else
+				bytes += sizeof(Value);
+			return bytes;
+		}
+
+		/**
+		 * @return if the cache exceeds a limit after adding entries of bytes
+		 */
+		[[nodiscard]] bool exceedsLimits(std::size_t entries, std::size_t bytes) const {
+			return size_.load(std::memory_order_relaxed) + entries > max_size_ or
+				   bytes_.load(std::memory_order_relaxed) + bytes > byte_budget_;
+		}
+
+		/**
+		 * Inserts into a locked shard and evicts from it until the cache is within its limits or the shard holds no
+		 * other entry. With TinyLFU, the value is rejected instead if its key is not more frequent than the first
+		 * victim's.
+		 * @return if the value was inserted
+		 */
+		bool insert(Shard &shard, const Key &key, std::size_t hash, const value_ptr &value, std::size_t bytes,
+					std::chrono::nanoseconds cost) {
+			bool admitted = (shard.sketch == nullptr);
+			while (not shard.ring.empty() and exceedsLimits(1, bytes)) {
+				const std::size_t victim = selectVictim(shard);
+				if (not admitted) {
+					if (shard.sketch->estimate(hash) <= shard.sketch->estimate(shard.ring[victim]->hash)) {
+						shard.rejections.fetch_add(1, std::memory_order_relaxed);
+						return false;
+					}
+					admitted = true;
+				}
+				remove(shard, victim);
+				shard.evictions.fetch_add(1, std::memory_order_relaxed);
+			}
+			shard.index[key] = shard.ring.size();
+			shard.ring.push_back(std::make_unique<Entry>(key, hash, value, bytes, cost));
+			size_.fetch_add(1, std::memory_order_relaxed);
+			bytes_.fetch_add(bytes, std::memory_order_relaxed);
+			return true;
+		}
+
+		/**
+		 * Evicts from the shards other than inserted_into, one at a time and in turn, until the cache is within its
+		 * limits again. Only has work if inserted_into ran empty in insert(). Holds one shard lock at a time.
+		 */
+		void evictFromOtherShards(const Shard &inserted_into) {
+			for (std::size_t empty_shards = 0; empty_shards < shard_count and exceedsLimits(0, 0);) {
+				Shard &shard = (*shards_)[next_evicting_shard_.fetch_add(1, std::memory_order_relaxed) % shard_count];
+				if (&shard == &inserted_into) {
+					++empty_shards;
+					continue;
+				}
+				Guard g(shard);
+				if (shard.ring.empty()) {
+					++empty_shards;
+					continue;
+				}
+				empty_shards = 0;
+				remove(shard, selectVictim(shard));
+				shard.evictions.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		/**
+		 * Chooses the next victim of a locked, non-empty shard. The hand inspects eviction_samples entries.
+		 * Referenced entries lose their flag and are skipped; of the others, the one with the lowest cost per byte is
+		 * chosen. If all inspected entries were referenced, the hand inspects the next eviction_samples entries.
+		 * @return position of the victim
+		 */
+		std::size_t selectVictim(Shard &shard) {
+			const std::size_t samples = std::min(eviction_samples, shard.ring.size());
+			std::size_t victim = shard.ring.size();
+			double victim_cost = std::numeric_limits<double>::infinity();
+			while (victim == shard.ring.size()) {
+				for (std::size_t inspected = 0; inspected < samples; ++inspected) {
+					Entry &entry = *shard.ring[shard.hand];
+					if (not entry.referenced.exchange(false, std::memory_order_relaxed) and
+						entry.cost_per_byte < victim_cost) {
+						victim = shard.hand;
+						victim_cost = entry.cost_per_byte;
+					}
+					shard.hand = (shard.hand + 1) % shard.ring.size();
+				}
+			}
+			return victim;
+		}
+
+		/**
+		 * Removes the entry at pos of a locked shard. The last entry of the ring moves into the gap.
+		 */
+		void remove(Shard &shard, std::size_t pos) {
+			size_.fetch_sub(1, std::memory_order_relaxed);
+			bytes_.fetch_sub(shard.ring[pos]->bytes, std::memory_order_relaxed);
+			shard.index.erase(shard.ring[pos]->key);
+			if (pos + 1 != shard.ring.size()) {
+				shard.ring[pos] = std::move(shard.ring.back());
+				shard.index[shard.ring[pos]->key] = pos;
+			}
+			shard.ring.pop_back();
+			if (shard.hand >= shard.ring.size())
+				shard.hand = 0;
+		}
+	};
+}
+
+#endif //TENTRIS_SHARDEDCLOCKCACHE_HPP
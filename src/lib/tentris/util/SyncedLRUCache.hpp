@@ -32,13 +32,22 @@
  * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <future>
 #include <list>
+#include <memory>
 #include <mutex>
 #include <stdexcept>
 #include <thread>
 #include <unordered_map>
 
+#include <absl/hash/hash.h>
+#include <tsl/hopscotch_map.h>
+
+#include "tentris/util/CacheStats.hpp"
+
 namespace tentris::util::sync {
 
 	template<typename K, typename V>
@@ -46,7 +55,7 @@ namespace tentris::util::sync {
 		K key;
 		std::shared_ptr<V> value;
 
-		KeyValuePair(K key) : key(std::move(key)), value(std::make_shared<V>(this->key)) {}
+		KeyValuePair(K key, std::shared_ptr<V> value) : key(std::move(key)), value(std::move(value)) {}
 	};
 
 	template<class Key, class Value>
@@ -56,7 +65,6 @@ namespace tentris::util::sync {
 		using node_type =  KeyValuePair<Key, Value>;
 		using list_type = std::list<KeyValuePair<Key, Value>>;
 		using Lock  = std::mutex;
-		using Guard = std::lock_guard<Lock>;
 		using value_ptr = std::shared_ptr<Value>;
 
 		// Dissallow copying.
@@ -65,11 +73,48 @@ namespace tentris::util::sync {
 		SyncedLRUCache &operator=(const SyncedLRUCache &) = delete;
 
 	private:
+		using pending_map_type = tsl::hopscotch_map<Key, std::shared_future<value_ptr>, absl::Hash<Key>>;
+
+		/**
+		 * Locks the cache mutex and records how long it was held.
+		 */
+		class Guard {
+			const SyncedLRUCache &cache_;
+			std::unique_lock<Lock> lock_;
+			std::chrono::steady_clock::time_point acquired_;
+
+		public:
+			explicit Guard(const SyncedLRUCache &cache)
+					: cache_(cache), lock_(cache.lock_), acquired_(std::chrono::steady_clock::now()) {}
+
+			~Guard() {
+				const auto held = std::chrono::steady_clock::now() - acquired_;
+				lock_.unlock();
+				cache_.recordLockHold(std::chrono::duration_cast<std::chrono::nanoseconds>(held));
+			}
+		};
+
 		mutable Lock lock_;
 		map_type cache_;
 		list_type keys_;
+		/**
+		 * Futures of the values that are constructed right now.
+		 */
+		pending_map_type pending_;
+		/**
+		 * Incremented by clear() and erase(). A value whose construction started before is handed out, but not cached.
+		 */
+		std::size_t generation_ = 0;
 		size_t maxSize_;
 		size_t elasticity_;
+
+		mutable std::atomic<std::size_t> hits_{0};
+		mutable std::atomic<std::size_t> misses_{0};
+		mutable std::atomic<std::size_t> coalesced_{0};
+		mutable std::atomic<std::size_t> evictions_{0};
+		mutable std::atomic<std::size_t> lock_acquisitions_{0};
+		mutable std::atomic<std::int64_t> total_lock_hold_ns_{0};
+		mutable std::atomic<std::int64_t> max_lock_hold_ns_{0};
 	public:
 
 		/**
@@ -85,34 +130,94 @@ namespace tentris::util::sync {
 				: maxSize_(maxSize), elasticity_(elasticity) {}
 
 		[[nodiscard]] size_t size() const {
-			Guard g(lock_);
+			Guard g(*this);
 			return cache_.size();
 		}
 
 		[[nodiscard]] bool empty() const {
-			Guard g(lock_);
+			Guard g(*this);
 			return cache_.empty();
 		}
 
 		void clear() {
-			Guard g(lock_);
+			Guard g(*this);
 			cache_.clear();
 			keys_.clear();
+			++generation_;
 		}
 
-		[[nodiscard]] value_ptr &operator[](const Key &key) {
-			Guard g(lock_);
-			const auto iter = cache_.find(key);
-			logTrace("cache size: {} lru size: {}"_format(cache_.size(), keys_.size()));
-			if (iter == cache_.end()) {
-				auto &key_value = keys_.emplace_front(key);
-				cache_[key] = keys_.begin();
-				prune();
-				return key_value.value;
-			} else {
-				keys_.splice(keys_.begin(), keys_, iter->second);
-				return iter->second->value;
+		void erase(const Key &key) {
+			Guard g(*this);
+			if (const auto iter = cache_.find(key); iter != cache_.end()) {
+				keys_.erase(iter->second);
+				cache_.erase(iter);
 			}
+			++generation_;
+		}
+
+		/**
+		 * Returns the cached value of key. On a miss, the value is constructed from the key without holding the cache
+		 * mutex, so other requests are not blocked by the construction. Concurrent misses of the same key wait for a
+		 * single construction.
+		 * @throw any exception of the value's constructor. It is thrown to all waiting callers and nothing is cached.
+		 */
+		[[nodiscard]] value_ptr operator[](const Key &key) {
+			std::shared_future<value_ptr> in_flight;
+			std::promise<value_ptr> promise;
+			std::size_t generation = 0;
+			{
+				Guard g(*this);
+				if (const auto iter = cache_.find(key); iter != cache_.end()) {
+					keys_.splice(keys_.begin(), keys_, iter->second);
+					hits_.fetch_add(1, std::memory_order_relaxed);
+					return iter->second->value;
+				}
+				misses_.fetch_add(1, std::memory_order_relaxed);
+				if (const auto pending = pending_.find(key); pending != pending_.end()) {
+					coalesced_.fetch_add(1, std::memory_order_relaxed);
+					in_flight = pending->second;
+				} else {
+					pending_.emplace(key, promise.get_future().share());
+					generation = generation_;
+				}
+			}
+			if (in_flight.valid())
+				return in_flight.get();
+
+			value_ptr value;
+			try {
+				value = std::make_shared<Value>(key);
+			} catch (...) {
+				{
+					Guard g(*this);
+					pending_.erase(key);
+				}
+				promise.set_exception(std::current_exception());
+				throw;
+			}
+			{
+				Guard g(*this);
+				pending_.erase(key);
+				if (generation == generation_) {
+					keys_.emplace_front(key, value);
+					cache_[key] = keys_.begin();
+					evictions_.fetch_add(prune(), std::memory_order_relaxed);
+				}
+			}
+			promise.set_value(value);
+			return value;
+		}
+
+		[[nodiscard]] CacheStats stats() const {
+			CacheStats stats{};
+			stats.hits = hits_.load(std::memory_order_relaxed);
+			stats.misses = misses_.load(std::memory_order_relaxed);
+			stats.coalesced = coalesced_.load(std::memory_order_relaxed);
+			stats.evictions = evictions_.load(std::memory_order_relaxed);
+			stats.lock_acquisitions = lock_acquisitions_.load(std::memory_order_relaxed);
+			stats.total_lock_hold = std::chrono::nanoseconds{total_lock_hold_ns_.load(std::memory_order_relaxed)};
+			stats.max_lock_hold = std::chrono::nanoseconds{max_lock_hold_ns_.load(std::memory_order_relaxed)};
+			return stats;
 		}
 
 		size_t getMaxSize() const { return maxSize_; }
@@ -122,6 +227,14 @@ namespace tentris::util::sync {
 		size_t getMaxAllowedSize() const { return maxSize_ + elasticity_; }
 
 	private:
+		void recordLockHold(std::chrono::nanoseconds held) const {
+			const std::int64_t held_ns = held.count();
+			lock_acquisitions_.fetch_add(1, std::memory_order_relaxed);
+			total_lock_hold_ns_.fetch_add(held_ns, std::memory_order_relaxed);
+			auto max = max_lock_hold_ns_.load(std::memory_order_relaxed);
+			while (held_ns > max and
+				   not max_lock_hold_ns_.compare_exchange_weak(max, held_ns, std::memory_order_relaxed)) {}
+		}
 
 		size_t prune() {
 			size_t maxAllowed = maxSize_ + elasticity_;
@@ -142,5 +255,4 @@ namespace tentris::util::sync {
 
 }
 
-
 #endif //TENTRIS_SYNCEDLRUCACHE_HPP
@@ -0,0 +1,88 @@
+#ifndef TENTRIS_CONCURRENTBLOCKARENA_HPP
+#define TENTRIS_CONCURRENTBLOCKARENA_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+namespace tentris::util::container {
+
+	/**
+	 * Fixed-capacity storage with blocks that are allocated on first use. The positions are handed out by the caller
+	 * (e.g. from an atomic counter), so several threads can write different positions at the same time. Reading a
+	 * position never locks; the caller must make sure that the write of that position happened before (e.g. through
+	 * the mutex that published the position).
+	 * @tparam T trivially destructible element type
+	 * @tparam block_size_exp every block holds 2^block_size_exp elements
+	 * @tparam max_blocks_exp at most 2^max_blocks_exp blocks
+	 */
+	template<typename T, std::size_t block_size_exp = 16, std::size_t max_blocks_exp = 15>
+	class ConcurrentBlockArena {
+		static_assert(std::is_trivially_destructible_v<T>);
+	public:
+		constexpr static std::size_t block_size = std::size_t(1) << block_size_exp;
+		constexpr static std::size_t max_blocks = std::size_t(1) << max_blocks_exp;
+		constexpr static std::size_t capacity = block_size * max_blocks;
+
+	private:
+		constexpr static std::size_t block_mask = block_size - 1;
+
+		std::unique_ptr<std::array<std::atomic<T *>, max_blocks>> blocks =
+				std::make_unique<std::array<std::atomic<T *>, max_blocks>>();
+		std::atomic<std::size_t> allocated_blocks{0};
+
+	public:
+		ConcurrentBlockArena() {
+			for (auto &block : *blocks)
+				block.store(nullptr, std::memory_order_relaxed);
+		}
+
+		ConcurrentBlockArena(const ConcurrentBlockArena &) = delete;
+
+		ConcurrentBlockArena &operator=(const ConcurrentBlockArena &) = delete;
+
+		~ConcurrentBlockArena() {
+			for (auto &block : *blocks)
+				delete[] block.load(std::memory_order_relaxed);
+		}
+
+		/**
+		 * Writes value to pos. The block of pos is allocated if needed.
+		 * @throw std::out_of_range pos is beyond capacity
+		 */
+		void set(std::size_t pos, const T &value) {
+			if (pos >= capacity)
+				throw std::out_of_range{"ConcurrentBlockArena is full."};
+			auto &block = (*blocks)[pos >> block_size_exp];
+			T *data = block.load(std::memory_order_acquire);
+			if (data == nullptr) {
+				auto *fresh = new T[block_size];
+				if (block.compare_exchange_strong(data, fresh, std::memory_order_acq_rel)) {
+					data = fresh;
+					allocated_blocks.fetch_add(1, std::memory_order_relaxed);
+				} else {
+					// another thread was faster, data holds its block now
+					delete[] fresh;
+				}
+			}
+			data[pos & block_mask] = value;
+		}
+
+		const T &operator[](std::size_t pos) const {
+			return (*blocks)[pos >> block_size_exp].load(std::memory_order_acquire)[pos & block_mask];
+		}
+
+		/**
+		 * @return bytes of the allocated blocks and the block table
+		 */
+		[[nodiscard]] std::size_t reservedBytes() const {
+			return allocated_blocks.load(std::memory_order_relaxed) * block_size * sizeof(T)
+				   + max_blocks * sizeof(std::atomic<T *>);
+		}
+	};
+}
+
+#endif //TENTRIS_CONCURRENTBLOCKARENA_HPP
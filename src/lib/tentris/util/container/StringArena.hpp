@@ -0,0 +1,70 @@
+#ifndef TENTRIS_STRINGARENA_HPP
+#define TENTRIS_STRINGARENA_HPP
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace tentris::util::container {
+
+	/**
+	 * Append-only storage for string data. The bytes are copied into large blocks and never move, so the returned
+	 * string_views stay valid until the arena is destroyed. Strings are not null-terminated.
+	 */
+	class StringArena {
+		constexpr static std::size_t default_block_size = std::size_t(1) << 20;
+
+		std::vector<std::unique_ptr<char[]>> blocks{};
+		std::size_t block_size_;
+		char *current = nullptr;
+		std::size_t remaining = 0;
+		std::size_t used_bytes = 0;
+		std::size_t reserved_bytes = 0;
+
+	public:
+		explicit StringArena(std::size_t block_size = default_block_size) : block_size_(block_size) {}
+
+		StringArena(const StringArena &) = delete;
+
+		StringArena &operator=(const StringArena &) = delete;
+
+		/**
+		 * Copies str into the arena.
+		 * @return view on the copy
+		 */
+		std::string_view append(std::string_view str) {
+			if (str.size() > remaining) {
+				// strings larger than a block get a block of their own and the current block stays in use
+				const std::size_t size = std::max(block_size_, str.size());
+				blocks.emplace_back(new char[size]);
+				reserved_bytes += size;
+				if (size == block_size_) {
+					current = blocks.back().get();
+					remaining = size;
+				} else {
+					std::memcpy(blocks.back().get(), str.data(), str.size());
+					used_bytes += str.size();
+					return {blocks.back().get(), str.size()};
+				}
+			}
+			char *dest = current;
+			std::memcpy(dest, str.data(), str.size());
+			current += str.size();
+			remaining -= str.size();
+			used_bytes += str.size();
+			return {dest, str.size()};
+		}
+
+		[[nodiscard]] std::size_t usedBytes() const {
+			return used_bytes;
+		}
+
+		[[nodiscard]] std::size_t reservedBytes() const {
+			return reserved_bytes;
+		}
+	};
+}
+
+#endif //TENTRIS_STRINGARENA_HPP
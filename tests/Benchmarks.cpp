@@ -0,0 +1,442 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/algorithm/string.hpp>
+#include <fmt/format.h>
+#include <tsl/hopscotch_map.h>
+
+#include <tentris/store/RDF/PrefixResolver.hpp>
+#include <tentris/store/RDF/SerdParser.hpp>
+#include <tentris/store/RDF/TermStore.hpp>
+#include <tentris/store/SPARQL/ParsedSPARQL.hpp>
+#include <tentris/util/ShardedClockCache.hpp>
+#include <tentris/util/SyncedLRUCache.hpp>
+
+// The benchmarks are built as their own executable, because they replace the global operator new to count
+// allocations. Run a single one with e.g. ./benchmarks --gtest_filter='BenchmarkTermStore.*'
+
+namespace {
+	using namespace tentris::store::rdf;
+	using Term = rdf_parser::store::rdf::Term;
+	using namespace std::chrono;
+
+	// number of calls to any global operator new, for benchmarks that count allocations
+	std::atomic<std::size_t> allocations{0};
+
+	void *countedAlloc(std::size_t size, std::size_t alignment = alignof(std::max_align_t)) noexcept {
+		allocations.fetch_add(1, std::memory_order_relaxed);
+		if (size == 0)
+			size = 1;
+		if (alignment <= alignof(std::max_align_t))
+			return std::malloc(size);
+		// aligned_alloc requires a size that is a multiple of the alignment
+		return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+	}
+
+	void *countedAllocOrThrow(std::size_t size, std::size_t alignment = alignof(std::max_align_t)) {
+		if (void *ptr = countedAlloc(size, alignment))
+			return ptr;
+		throw std::bad_alloc{};
+	}
+}
+
+void *operator new(std::size_t size) {
+	return countedAllocOrThrow(size);
+}
+
+void *operator new[](std::size_t size) {
+	return countedAllocOrThrow(size);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+	return countedAllocOrThrow(size, std::size_t(alignment));
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment) {
+	return countedAllocOrThrow(size, std::size_t(alignment));
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+	return countedAlloc(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+	return countedAlloc(size);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+	return countedAlloc(size, std::size_t(alignment));
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+	return countedAlloc(size, std::size_t(alignment));
+}
+
+void operator delete(void *ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+	std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t) noexcept {
+	std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::align_val_t) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept {
+	std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept {
+	std::free(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t, const std::nothrow_t &) noexcept {
+	std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::align_val_t, const std::nothrow_t &) noexcept {
+	std::free(ptr);
+}
+
+TEST(BenchmarkTermStore, lookup_and_memory) {
+	std::vector<Term> terms{};
+	TermStore store{};
+	for (auto iter = SerdParser{"dataset/sp2b.nt"}.begin(); iter; ++iter) {
+		const auto &triple = *iter;
+		for (const auto &term : {triple.subject(), triple.predicate(), triple.object()}) {
+			if (store.find(term) == TermStore::no_id)
+				terms.push_back(term);
+			store[term];
+		}
+	}
+	ASSERT_EQ(store.size(), terms.size());
+
+	constexpr std::size_t rounds = 20;
+	std::size_t found = 0;
+	auto start = steady_clock::now();
+	for (std::size_t round = 0; round < rounds; ++round)
+		for (const auto &term : terms)
+			found += (store.find(term) != TermStore::no_id);
+	auto lookup_duration = steady_clock::now() - start;
+	ASSERT_EQ(found, rounds * terms.size());
+
+	start = steady_clock::now();
+	std::size_t identifier_bytes = 0;
+	for (TermStore::id_type id = 1; id <= store.size(); ++id)
+		identifier_bytes += store.identifier(id).size();
+	auto decode_duration = steady_clock::now() - start;
+
+	const auto usage = store.memoryUsage();
+	fmt::print("terms: {}, namespaces: {}\n", store.size(), store.prefixCount());
+	fmt::print("find:       {:.1f} ns/lookup\n",
+			   double(duration_cast<nanoseconds>(lookup_duration).count()) / (rounds * terms.size()));
+	fmt::print("identifier: {:.1f} ns/term ({} bytes)\n",
+			   double(duration_cast<nanoseconds>(decode_duration).count()) / store.size(), identifier_bytes);
+	fmt::print("memory:     {} bytes, {:.1f} bytes/term (node-based layout: {} bytes, {:.1f} bytes/term)\n",
+			   usage.total(), usage.bytesPerTerm(), usage.node_based_bytes, usage.nodeBasedBytesPerTerm());
+	fmt::print("strings:    {} bytes (uncompressed: {} bytes)\n", usage.string_bytes, usage.uncompressed_string_bytes);
+}
+
+TEST(BenchmarkPrefixResolver, curie_expansion) {
+	const std::vector<std::pair<std::string, std::string>> prefix_definitions{
+			{"rdf", "http://www.w3.org/1999/02/22-rdf-syntax-ns#"},
+			{"foaf", "http://xmlns.com/foaf/0.1/"},
+			{"dc", "http://purl.org/dc/elements/1.1/"},
+			{"bench", "http://localhost/vocabulary/bench/"}};
+	const std::vector<std::string> curies{"rdf:type", "foaf:name", "dc:creator", "bench:Article",
+										  "bench:Journal1:1940", "foaf:Person"};
+	constexpr std::size_t rounds = 1'000'000;
+
+	// the expansion as BulkLoad did it before
+	tsl::hopscotch_map<std::string, std::string, absl::Hash<std::string>> legacy_prefixes{};
+	PrefixResolver resolver{};
+	for (const auto &[prefix, iri] : prefix_definitions) {
+		legacy_prefixes[prefix] = iri;
+		resolver.set(prefix, iri);
+	}
+
+	std::size_t checksum = 0;
+	auto allocations_before = allocations.load();
+	auto start = steady_clock::now();
+	for (std::size_t round = 0; round < rounds; ++round) {
+		for (const std::string_view curie : curies) {
+			std::vector<std::string> prefix_and_suffix{};
+			boost::split(prefix_and_suffix, curie, [](char c) { return c == ':'; });
+			std::string iri = fmt::format("{}{}", legacy_prefixes.find(prefix_and_suffix[0])->second,
+										  prefix_and_suffix[1]);
+			checksum += iri.size();
+		}
+	}
+	auto legacy_duration = steady_clock::now() - start;
+	auto legacy_allocations = allocations.load() - allocations_before;
+
+	allocations_before = allocations.load();
+	start = steady_clock::now();
+	std::string iri{};
+	for (std::size_t round = 0; round < rounds; ++round) {
+		for (const std::string_view curie : curies) {
+			ASSERT_TRUE(resolver.expand(curie, iri));
+			checksum += iri.size();
+		}
+	}
+	auto resolver_duration = steady_clock::now() - start;
+	auto resolver_allocations = allocations.load() - allocations_before;
+
+	const double expansions = double(rounds * curies.size());
+	fmt::print("legacy (boost::split + fmt::format): {:.1f} ns, {:.2f} allocations per CURIE\n",
+			   duration_cast<nanoseconds>(legacy_duration).count() / expansions, legacy_allocations / expansions);
+	fmt::print("PrefixResolver:                      {:.1f} ns, {:.2f} allocations per CURIE\n",
+			   duration_cast<nanoseconds>(resolver_duration).count() / expansions,
+			   resolver_allocations / expansions);
+	fmt::print("checksum: {}\n", checksum);
+}
+
+TEST(BenchmarkPrefixResolver, turtle_load_allocations) {
+	std::size_t triples = 0;
+	const auto allocations_before = allocations.load();
+	const auto start = steady_clock::now();
+	for (auto iter = SerdParser{"dataset/sp2b.n3"}.begin(); iter; ++iter)
+		++triples;
+	const auto duration = steady_clock::now() - start;
+	const auto load_allocations = allocations.load() - allocations_before;
+	ASSERT_GT(triples, 0);
+	fmt::print("sp2b.n3: {} triples in {} ms, {:.2f} allocations per triple\n", triples,
+			   duration_cast<milliseconds>(duration).count(), double(load_allocations) / triples);
+}
+
+TEST(BenchmarkTermStore, concurrent_insert) {
+	std::vector<std::pair<Term, std::size_t>> terms{};
+	for (auto iter = SerdParser{"dataset/sp2b.nt"}.begin(); iter; ++iter) {
+		const auto &triple = *iter;
+		for (const auto &term : {triple.subject(), triple.predicate(), triple.object()})
+			terms.emplace_back(term, TermStore::hash(term));
+	}
+
+	double single_thread_seconds = 0;
+	for (std::size_t threads : {1, 2, 4, 8, 16, 32}) {
+		TermStore store{};
+		std::vector<std::thread> workers{};
+		const auto start = steady_clock::now();
+		for (std::size_t worker = 0; worker < threads; ++worker)
+			workers.emplace_back([&, worker]() {
+				for (std::size_t i = worker; i < terms.size(); i += threads)
+					store.insert(terms[i].first, terms[i].second);
+			});
+		for (auto &thread : workers)
+			thread.join();
+		const double seconds = duration<double>(steady_clock::now() - start).count();
+		if (threads == 1)
+			single_thread_seconds = seconds;
+		fmt::print("{:2} threads: {:.3f} s, {:.0f} inserts/s, speedup {:.2f}\n", threads, seconds,
+				   terms.size() / seconds, single_thread_seconds / seconds);
+		for (const auto &[term, hash] : terms)
+			ASSERT_NE(store.find(term, hash), TermStore::no_id);
+	}
+}
+
+TEST(BenchmarkTermStore, term_hash) {
+	std::vector<Term> terms{};
+	for (auto iter = SerdParser{"dataset/sp2b.nt"}.begin(); iter; ++iter)
+		terms.push_back((*iter).object());
+	constexpr std::size_t rounds = 20;
+
+	std::size_t checksum = 0;
+	auto start = steady_clock::now();
+	for (std::size_t round = 0; round < rounds; ++round)
+		for (const auto &term : terms)
+			checksum += std::hash<Term>()(term);
+	auto std_duration = steady_clock::now() - start;
+
+	start = steady_clock::now();
+	for (std::size_t round = 0; round < rounds; ++round)
+		for (const auto &term : terms)
+			checksum += TermStore::hash(term);
+	auto store_duration = steady_clock::now() - start;
+
+	const double hashes = double(rounds * terms.size());
+	fmt::print("std::hash<Term>:  {:.1f} ns/term\n", duration_cast<nanoseconds>(std_duration).count() / hashes);
+	fmt::print("TermStore::hash:  {:.1f} ns/term\n", duration_cast<nanoseconds>(store_duration).count() / hashes);
+	fmt::print("checksum: {}\n", checksum);
+}
+
+namespace {
+	struct CachedQuery {
+		std::string query;
+
+		explicit CachedQuery(const std::string &query) : query(query) {}
+	};
+
+	/**
+	 * Every thread looks up its own sequence of keys. The sequences are skewed like a query log: most lookups go to
+	 * a few hot queries and all keys fit into the cache, so after warm-up every lookup is a hit.
+	 * @return lookups per second
+	 */
+	template<typename Cache>
+	double cacheThroughput(Cache &cache, const std::vector<std::vector<std::string>> &sequences,
+						   std::size_t threads) {
+		std::vector<std::thread> workers{};
+		std::atomic<std::size_t> checksum{0};
+		const auto start = steady_clock::now();
+		for (std::size_t worker = 0; worker < threads; ++worker)
+			workers.emplace_back([&, worker]() {
+				std::size_t local = 0;
+				for (const auto &key : sequences[worker])
+					local += cache[key]->query.size();
+				checksum += local;
+			});
+		for (auto &thread : workers)
+			thread.join();
+		const double seconds = duration<double>(steady_clock::now() - start).count();
+		EXPECT_GT(checksum, 0);
+		return double(threads * sequences.front().size()) / seconds;
+	}
+}
+
+TEST(BenchmarkQueryCache, contention) {
+	constexpr std::size_t max_threads = 64;
+	constexpr std::size_t lookups_per_thread = 200'000;
+	constexpr std::size_t distinct_queries = 256;
+
+	std::vector<std::string> queries{};
+	for (std::size_t i = 0; i < distinct_queries; ++i)
+		queries.push_back(fmt::format("SELECT ?s WHERE {{ ?s <http://example.com/p> <http://example.com/o{}> }}", i));
+	std::vector<std::vector<std::string>> sequences(max_threads);
+	for (std::size_t worker = 0; worker < max_threads; ++worker) {
+		std::mt19937_64 random{worker};
+		std::geometric_distribution<std::size_t> skewed{0.05};
+		sequences[worker].reserve(lookups_per_thread);
+		for (std::size_t i = 0; i < lookups_per_thread; ++i)
+			sequences[worker].push_back(queries[skewed(random) % distinct_queries]);
+	}
+
+	fmt::print("threads  SyncedLRUCache [lookups/s]  ShardedClockCache [lookups/s]  speedup\n");
+	for (std::size_t threads : {1, 2, 4, 8, 16, 32, 64}) {
+		tentris::util::sync::SyncedLRUCache<std::string, CachedQuery> lru{1000};
+		tentris::util::sync::ShardedClockCache<std::string, CachedQuery> clock{1000};
+		for (const auto &query : queries) {
+			(void) lru[query];
+			(void) clock[query];
+		}
+		const double lru_throughput = cacheThroughput(lru, sequences, threads);
+		const double clock_throughput = cacheThroughput(clock, sequences, threads);
+		fmt::print("{:7}  {:27.0f}  {:29.0f}  {:7.2f}\n", threads, lru_throughput, clock_throughput,
+				   clock_throughput / lru_throughput);
+		fmt::print("         lru:   {}\n         clock: {}\n", lru.stats(), clock.stats());
+	}
+}
+
+TEST(BenchmarkQueryCache, admission_replay) {
+	constexpr std::size_t lookups = 200'000;
+	constexpr double one_off_share = 0.3;
+
+	std::vector<std::string> queries{};
+	for (const auto *file : {"queries/sp2b.txt", "queries/DBpedia.txt", "queries/swdf.txt"}) {
+		std::ifstream query_file{file};
+		for (std::string query; std::getline(query_file, query);)
+			if (not query.empty())
+				queries.push_back(std::move(query));
+	}
+	ASSERT_FALSE(queries.empty());
+
+	// a query log: Zipf-distributed repeated queries, mixed with one-off queries (e.g. with unique constants)
+	std::mt19937_64 random{42};
+	std::shuffle(queries.begin(), queries.end(), random);
+	std::vector<double> weights{};
+	for (std::size_t rank = 1; rank <= queries.size(); ++rank)
+		weights.push_back(1.0 / double(rank));
+	std::discrete_distribution<std::size_t> zipf{weights.begin(), weights.end()};
+	std::bernoulli_distribution one_off{one_off_share};
+	std::vector<std::string> trace{};
+	trace.reserve(lookups);
+	for (std::size_t i = 0; i < lookups; ++i) {
+		if (one_off(random))
+			trace.push_back(fmt::format("{} # {}", queries[zipf(random)], i));
+		else
+			trace.push_back(queries[zipf(random)]);
+	}
+
+	using tentris::util::sync::AdmissionPolicy;
+	fmt::print("{} distinct queries, {:.0f} % one-off lookups\n", queries.size(), one_off_share * 100);
+	fmt::print("cache size  always [hit rate]  tinylfu [hit rate]\n");
+	for (std::size_t cache_size : {32, 64, 128, 256, 512}) {
+		tentris::util::sync::ShardedClockCache<std::string, CachedQuery> always{cache_size};
+		tentris::util::sync::ShardedClockCache<std::string, CachedQuery> tiny_lfu{cache_size, 0,
+																				  AdmissionPolicy::TINY_LFU};
+		for (const auto &query : trace) {
+			(void) always[query];
+			(void) tiny_lfu[query];
+		}
+		fmt::print("{:10}  {:17.3f}  {:18.3f}\n", cache_size, always.stats().hitRate(), tiny_lfu.stats().hitRate());
+	}
+}
+
+TEST(BenchmarkSPARQLParser, parse_latency) {
+	using tentris::store::sparql::ParsedSPARQL;
+	constexpr std::size_t rounds = 10;
+
+	fmt::print("file                 queries  subset parser  antlr [us/query]  speedup\n");
+	for (const auto *file : {"queries/sp2b.txt", "queries/DBpedia.txt", "queries/swdf.txt"}) {
+		std::vector<std::string> queries{};
+		std::ifstream query_file{file};
+		for (std::string query; std::getline(query_file, query);)
+			if (not query.empty())
+				queries.push_back(std::move(query));
+		ASSERT_FALSE(queries.empty());
+
+		std::size_t parsed_by_subset_parser = 0;
+		auto parse_all = [&](bool use_subset_parser) {
+			const auto start = steady_clock::now();
+			for (std::size_t round = 0; round < rounds; ++round)
+				for (const auto &query : queries) {
+					try {
+						ParsedSPARQL parsed_sparql{query, use_subset_parser};
+						if (round == 0 and parsed_sparql.isParsedBySubsetParser())
+							++parsed_by_subset_parser;
+					} catch (const std::invalid_argument &) {}
+				}
+			return duration<double, std::micro>(steady_clock::now() - start).count() / double(rounds * queries.size());
+		};
+		const double subset = parse_all(true);
+		const double antlr = parse_all(false);
+		fmt::print("{:19}  {:7}  {:13.1f}  {:16.1f}  {:7.1f}\n", file, queries.size(), subset, antlr, antlr / subset);
+		fmt::print("  {} of {} queries parsed by the subset parser\n", parsed_by_subset_parser, queries.size());
+	}
+}
+
+int main(int argc, char **argv) {
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
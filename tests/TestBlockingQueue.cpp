@@ -0,0 +1,39 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include <tentris/util/BlockingQueue.hpp>
+
+namespace {
+	using namespace tentris::util::sync;
+}
+
+TEST(TestBlockingQueue, transfers_all_batches_in_order) {
+	BlockingQueue<std::vector<int>> queue{2};
+	std::thread producer{[&]() {
+		for (int i = 0; i < 100; ++i)
+			queue.push(std::vector<int>(10, i));
+		queue.close();
+	}};
+	int expected = 0;
+	while (auto batch = queue.pop()) {
+		ASSERT_EQ(batch->size(), 10);
+		ASSERT_EQ(batch->front(), expected++);
+	}
+	producer.join();
+	ASSERT_EQ(expected, 100);
+}
+
+TEST(TestBlockingQueue, close_wakes_blocked_producer) {
+	BlockingQueue<int> queue{1};
+	ASSERT_TRUE(queue.push(1));
+	std::thread producer{[&]() { ASSERT_FALSE(queue.push(2)); }};
+	while (queue.stalls().producer_stalls == 0)
+		std::this_thread::yield();
+	queue.close();
+	producer.join();
+	// remaining elements are still drained after close
+	ASSERT_EQ(queue.pop(), std::optional<int>{1});
+	ASSERT_EQ(queue.pop(), std::nullopt);
+}
@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include <tentris/store/RDF/SerdParser.hpp>
+#include <tentris/util/DecompressingReader.hpp>
+
+namespace {
+	using DecompressingReader = tentris::util::DecompressingReader;
+
+	std::string readAll(DecompressingReader &reader) {
+		std::string result{};
+		std::string buffer(1000, '\0'); // smaller than a chunk, so reads span chunk boundaries
+		while (auto count = reader.read(buffer.data(), buffer.size()))
+			result.append(buffer.data(), count);
+		return result;
+	}
+
+	std::string fileContent(const std::string &file_path) {
+		std::ifstream file{file_path, std::ios::binary};
+		return {std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+	}
+
+	/**
+	 * Parses a file with BulkLoad and counts the triples.
+	 */
+	std::size_t countTriples(const std::shared_ptr<tentris::store::rdf::BulkLoad> &bulk_load) {
+		std::size_t triples = 0;
+		while (auto batch = bulk_load->result_queue.pop())
+			triples += batch->size();
+		return triples;
+	}
+}
+
+TEST(TestDecompressingReader, compression_by_extension) {
+	ASSERT_EQ(DecompressingReader::compressionOf("a.nt.gz"), DecompressingReader::Compression::gzip);
+	ASSERT_EQ(DecompressingReader::compressionOf("a.nt.bz2"), DecompressingReader::Compression::bzip2);
+	ASSERT_EQ(DecompressingReader::compressionOf("a.nt.zst"), DecompressingReader::Compression::zstd);
+	ASSERT_EQ(DecompressingReader::compressionOf("a.nt"), DecompressingReader::Compression::none);
+	ASSERT_TRUE(DecompressingReader::needsReader("-"));
+	ASSERT_FALSE(DecompressingReader::needsReader("a.ttl"));
+}
+
+TEST(TestDecompressingReader, decompresses) {
+	const std::string expected = fileContent("compressed/sample.nt");
+	ASSERT_FALSE(expected.empty());
+	for (const std::string file_path : {"compressed/sample.nt", "compressed/sample.nt.gz", "compressed/sample.nt.bz2",
+										"compressed/sample.nt.zst"}) {
+		DecompressingReader reader{file_path};
+		ASSERT_EQ(readAll(reader), expected) << file_path;
+		ASSERT_FALSE(reader.error()) << file_path;
+	}
+}
+
+TEST(TestDecompressingReader, reports_truncated_input) {
+	for (const std::string file_path : {"compressed/truncated.nt.gz", "compressed/truncated.nt.bz2",
+										"compressed/truncated.nt.zst", "compressed/missing.nt.gz"}) {
+		DecompressingReader reader{file_path};
+		readAll(reader);
+		ASSERT_TRUE(reader.error()) << file_path;
+	}
+}
+
+TEST(TestDecompressingReader, reads_stdin) {
+	const std::string expected = fileContent("compressed/sample.nt");
+	std::istringstream input{expected};
+	auto *const original = std::cin.rdbuf(input.rdbuf());
+	std::string read;
+	{
+		DecompressingReader reader{"-"};
+		read = readAll(reader); // returns after the reading thread closed the queue, so it is done with std::cin
+		ASSERT_FALSE(reader.error());
+	}
+	std::cin.rdbuf(original);
+	ASSERT_EQ(read, expected);
+}
+
+TEST(TestDecompressingReader, bulk_load) {
+	auto compressed = tentris::store::rdf::BulkLoad::parse("compressed/sample.nt.zst");
+	ASSERT_EQ(countTriples(compressed), 200);
+	ASSERT_EQ(compressed->status, SERD_SUCCESS);
+	ASSERT_FALSE(compressed->input_error);
+
+	auto truncated = tentris::store::rdf::BulkLoad::parse("compressed/truncated.nt.gz");
+	countTriples(truncated);
+	ASSERT_TRUE(truncated->input_error);
+}
@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+#include <tentris/store/HeuristicSelector.hpp>
+
+namespace {
+	using tentris::store::HeuristicSelector;
+	using Reason = HeuristicSelector::Reason;
+
+	std::chrono::milliseconds heuristicTime(std::size_t heuristic) {
+		// heuristic 3 is the fastest, heuristic 5 is very slow
+		constexpr std::array<int, HeuristicSelector::heuristic_count> times{20, 30, 40, 5, 10, 1000};
+		return std::chrono::milliseconds(times[heuristic]);
+	}
+
+	std::size_t heuristicIndex(const HeuristicSelector::PlannerOptions &planner_options) {
+		return std::size_t(std::find(HeuristicSelector::heuristics.begin(), HeuristicSelector::heuristics.end(),
+									 planner_options) - HeuristicSelector::heuristics.begin());
+	}
+}
+
+TEST(TestHeuristicSelector, warms_up_and_exploits_the_fastest_heuristic) {
+	HeuristicSelector selector{0.0};
+	const std::string shape = "SELECT ?s WHERE { ?s ?__param0 ?o }";
+	for (std::size_t i = 0; i < HeuristicSelector::heuristic_count; ++i) {
+		const auto choice = selector.choose(shape);
+		ASSERT_EQ(choice.reason, Reason::WARM_UP);
+		ASSERT_EQ(heuristicIndex(choice.planner_options), i);
+		selector.record(shape, choice.planner_options, heuristicTime(i));
+	}
+	for (std::size_t i = 0; i < 10; ++i) {
+		const auto choice = selector.choose(shape);
+		ASSERT_EQ(choice.reason, Reason::EXPLOIT);
+		ASSERT_EQ(heuristicIndex(choice.planner_options), 3);
+		selector.record(shape, choice.planner_options, heuristicTime(3));
+	}
+
+	// the fastest heuristic becomes slow, the selector switches to the next best one
+	for (std::size_t i = 0; i < HeuristicSelector::mean_window; ++i)
+		selector.record(shape, HeuristicSelector::heuristics[3], std::chrono::milliseconds(100));
+	ASSERT_EQ(heuristicIndex(selector.choose(shape).planner_options), 4);
+
+	const auto reports = selector.report();
+	ASSERT_EQ(reports.size(), 1);
+	ASSERT_EQ(reports[0].shape, shape);
+	ASSERT_EQ(reports[0].best, 4);
+	ASSERT_EQ(reports[0].choices[std::size_t(Reason::WARM_UP)], HeuristicSelector::heuristic_count);
+	ASSERT_EQ(reports[0].choices[std::size_t(Reason::EXPLOIT)], 11);
+	ASSERT_EQ(reports[0].heuristics[3].executions, 1 + 10 + HeuristicSelector::mean_window);
+}
+
+TEST(TestHeuristicSelector, exploration_is_bounded) {
+	HeuristicSelector selector{0.2, 10.0};
+	const std::string shape = "SELECT ?s WHERE { ?s ?p ?o }";
+	for (std::size_t i = 0; i < HeuristicSelector::heuristic_count; ++i)
+		selector.record(shape, HeuristicSelector::heuristics[i], heuristicTime(i));
+
+	constexpr std::size_t queries = 10'000;
+	std::size_t explorations = 0;
+	for (std::size_t i = 0; i < queries; ++i) {
+		const auto choice = selector.choose(shape);
+		// heuristic 5 is more than 10 times slower than the best one
+		ASSERT_NE(heuristicIndex(choice.planner_options), 5);
+		if (choice.reason == Reason::EXPLORE) {
+			ASSERT_NE(heuristicIndex(choice.planner_options), 3);
+			++explorations;
+		}
+	}
+	ASSERT_NEAR(double(explorations) / queries, 0.2, 0.03);
+}
+
+TEST(TestHeuristicSelector, timeouts_count_with_the_full_budget) {
+	HeuristicSelector selector{1.0, 10.0};
+	const std::string shape = "SELECT ?s WHERE { ?s ?p ?__param0 }";
+	for (std::size_t i = 0; i < HeuristicSelector::heuristic_count; ++i)
+		if (i == 3)
+			// the deadline had nearly passed when the query started, it timed out after 1 ms
+			selector.recordTimeout(shape, HeuristicSelector::heuristics[i], std::chrono::seconds(1));
+		else
+			selector.record(shape, HeuristicSelector::heuristics[i], heuristicTime(i));
+
+	ASSERT_EQ(selector.report()[0].best, 4);
+	for (std::size_t i = 0; i < 1'000; ++i) {
+		const auto choice = selector.choose(shape);
+		ASSERT_NE(heuristicIndex(choice.planner_options), 3);
+		ASSERT_NE(heuristicIndex(choice.planner_options), 5);
+	}
+}
+
+TEST(TestHeuristicSelector, limits_the_time_of_other_heuristics) {
+	using namespace std::chrono_literals;
+	HeuristicSelector selector{0.0, 10.0};
+	const std::string shape = "SELECT ?o WHERE { ?__param0 ?p ?o }";
+	auto choice = selector.choose(shape);
+	ASSERT_EQ(heuristicIndex(choice.planner_options), 0);
+	ASSERT_FALSE(choice.time_limit);
+	selector.record(shape, choice.planner_options, 5ms);
+
+	choice = selector.choose(shape);
+	ASSERT_EQ(choice.reason, Reason::WARM_UP);
+	ASSERT_EQ(heuristicIndex(choice.planner_options), 1);
+	ASSERT_EQ(choice.time_limit, std::chrono::steady_clock::duration(50ms));
+	ASSERT_EQ(choice.best, HeuristicSelector::heuristics[0]);
+	// heuristic 1 exceeded its time limit, it is never explored
+	selector.recordTimeout(shape, choice.planner_options, *choice.time_limit);
+	for (std::size_t i = 2; i < HeuristicSelector::heuristic_count; ++i) {
+		choice = selector.choose(shape);
+		ASSERT_EQ(choice.time_limit, std::chrono::steady_clock::duration(50ms));
+		selector.record(shape, choice.planner_options, 20ms);
+	}
+	// the best heuristic runs without a time limit
+	choice = selector.choose(shape);
+	ASSERT_EQ(choice.reason, Reason::EXPLOIT);
+	ASSERT_FALSE(choice.time_limit);
+
+	// the time limit is at least min_time_limit
+	HeuristicSelector exploring{1.0, 10.0};
+	for (std::size_t i = 0; i < HeuristicSelector::heuristic_count; ++i)
+		exploring.record(shape, HeuristicSelector::heuristics[i], i == 1 ? 50ms : 1us);
+	for (std::size_t i = 0; i < 1'000; ++i) {
+		choice = exploring.choose(shape);
+		ASSERT_EQ(choice.reason, Reason::EXPLORE);
+		ASSERT_NE(heuristicIndex(choice.planner_options), 1);
+		ASSERT_EQ(choice.time_limit, std::chrono::steady_clock::duration(HeuristicSelector::min_time_limit));
+	}
+}
+
+TEST(TestHeuristicSelector, tracks_at_most_max_shapes) {
+	HeuristicSelector selector{0.05, 10.0, 2};
+	ASSERT_EQ(selector.choose("a").reason, Reason::WARM_UP);
+	ASSERT_EQ(selector.choose("b").reason, Reason::WARM_UP);
+	const auto untracked = selector.choose("c");
+	ASSERT_EQ(untracked.reason, Reason::UNTRACKED);
+	ASSERT_EQ(untracked.planner_options, HeuristicSelector::PlannerOptions{});
+	selector.record("c", untracked.planner_options, std::chrono::milliseconds(1));
+	ASSERT_EQ(selector.report().size(), 2);
+}
@@ -0,0 +1,40 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+
+#include <tentris/store/IdTripleFile.hpp>
+
+namespace {
+	using namespace tentris::store;
+	using Term = rdf_parser::store::rdf::Term;
+}
+
+TEST(TestIdTripleFile, write_and_read) {
+	const auto file_path = (std::filesystem::temp_directory_path() / "tentris_test.ids").string();
+	std::vector<id_triples::key_type> keys{};
+	for (id_triples::key_part_type i = 1; i <= 1000; ++i)
+		keys.push_back({i / 10 + 1, 2, (i % 2) ? i * 1000 : 0x80000001u});
+	{
+		id_triples::Writer writer{file_path, 64};
+		for (const auto &key : keys)
+			writer.add(key);
+		writer.close();
+	}
+	id_triples::Reader reader{file_path};
+	ASSERT_EQ(reader.size(), keys.size());
+	ASSERT_EQ(reader.readAll(), keys);
+	std::filesystem::remove(file_path);
+}
+
+TEST(TestIdTripleFile, dictionary) {
+	const auto file_path = (std::filesystem::temp_directory_path() / "tentris_test.dict").string();
+	rdf::TermStore written{};
+	written[Term::make_term("<http://example.com/a>")];
+	written[Term::make_term("\"b\"@en")];
+	id_triples::writeDictionary(written, file_path);
+	rdf::TermStore read{};
+	id_triples::readDictionary(read, file_path);
+	ASSERT_EQ(read.size(), 2);
+	ASSERT_EQ(read.identifier(2), written.identifier(2));
+	std::filesystem::remove(file_path);
+}
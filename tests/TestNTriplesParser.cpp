@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+
+#include <tentris/store/RDF/NTriplesParser.hpp>
+
+namespace {
+	namespace fs = std::filesystem;
+	using namespace tentris::store::rdf;
+	using Term = rdf_parser::store::rdf::Term;
+	using Triple = rdf_parser::store::rdf::Triple;
+
+	std::vector<Triple> drain(BulkLoad::queue_type &queue) {
+		std::vector<Triple> triples{};
+		while (auto batch = queue.pop())
+			triples.insert(triples.end(), batch->begin(), batch->end());
+		return triples;
+	}
+}
+
+TEST(TestNTriplesParser, parse_line) {
+	auto triple = NTriplesParser::parseLine(
+			R"(<http://example.com/s> <http://example.com/p> "a \"b\"\nä"@en-GB . # comment)");
+	ASSERT_TRUE(triple);
+	ASSERT_EQ(triple->subject(), Term::make_term("<http://example.com/s>"));
+	ASSERT_EQ(triple->predicate(), Term::make_term("<http://example.com/p>"));
+	ASSERT_TRUE(triple->object().isLiteral());
+	ASSERT_EQ(triple->object().value(), "a \"b\"\n\xC3\xA4");
+	ASSERT_EQ(triple->object().castLiteral().lang(), "en-GB");
+
+	triple = NTriplesParser::parseLine(
+			R"(_:b1 <http://example.com/p> "42"^^<http://www.w3.org/2001/XMLSchema#integer>.)");
+	ASSERT_TRUE(triple);
+	// renamed like serd renames it
+	ASSERT_EQ(triple->subject(), Term::make_term("_:B1"));
+	ASSERT_EQ(triple->object(), Term::make_term(R"("42"^^<http://www.w3.org/2001/XMLSchema#integer>)"));
+}
+
+TEST(TestNTriplesParser, skip_and_reject) {
+	ASSERT_FALSE(NTriplesParser::parseLine(""));
+	ASSERT_FALSE(NTriplesParser::parseLine("  # only a comment"));
+	ASSERT_THROW(NTriplesParser::parseLine("<http://example.com/s> <http://example.com/p> ."),
+				 std::invalid_argument);
+	ASSERT_THROW(NTriplesParser::parseLine(R"(<http://example.com/s> <http://example.com/p> "open .)"),
+				 std::invalid_argument);
+}
+
+TEST(TestNTriplesParser, blank_nodes_match_serd) {
+	const std::string document = "_:b1 <http://example.com/p> _:x.y .\n"
+								 "_:b12x <http://example.com/p> _:b .\n"
+								 "_:_1 <http://example.com/p> _:\xC3\xA4\xCC\x80 .\n";
+	const auto serd_triples = drain(BulkLoad::parseString(document)->result_queue);
+	std::vector<Triple> triples{};
+	std::size_t line_begin = 0;
+	for (auto line_end = document.find('\n'); line_end != std::string::npos;
+		 line_begin = line_end + 1, line_end = document.find('\n', line_begin))
+		triples.push_back(*NTriplesParser::parseLine(std::string_view{document}.substr(line_begin,
+																					   line_end - line_begin)));
+	ASSERT_EQ(triples.size(), serd_triples.size());
+	for (std::size_t i = 0; i < triples.size(); ++i) {
+		ASSERT_EQ(triples[i].subject(), serd_triples[i].subject());
+		ASSERT_EQ(triples[i].object(), serd_triples[i].object());
+	}
+	ASSERT_EQ(triples[0].subject(), Term::make_term("_:B1"));
+	ASSERT_EQ(triples[0].object(), Term::make_term("_:x.y"));
+	ASSERT_EQ(triples[1].subject(), Term::make_term("_:B12x"));
+}
+
+TEST(TestNTriplesParser, reject_invalid_characters) {
+	for (const char *line : {"<http://example.com/a b> <http://example.com/p> <http://example.com/o> .",
+							 "<http://example.com/{a}> <http://example.com/p> <http://example.com/o> .",
+							 "<http://example.com/a|b> <http://example.com/p> <http://example.com/o> .",
+							 "<http://example.com/a\"b> <http://example.com/p> <http://example.com/o> .",
+							 "<http://example.com/s> <http://example.com/p> <http://example.com/\\x> .",
+							 "<http://example.com/s> <http://example.com/p> <http://example.com/\x01> .",
+							 "_:a!b <http://example.com/p> <http://example.com/o> .",
+							 "_:-a <http://example.com/p> <http://example.com/o> .",
+							 "_:.a <http://example.com/p> <http://example.com/o> .",
+							 "_: <http://example.com/p> <http://example.com/o> .",
+							 "<http://example.com/s> <http://example.com/p> _:a,b ."})
+		ASSERT_THROW(NTriplesParser::parseLine(line), std::invalid_argument) << line;
+	ASSERT_TRUE(NTriplesParser::parseLine("_:a-b.c <http://example.com/p> _:1a ."));
+}
+
+TEST(TestNTriplesParser, reject_both_kinds_of_generated_labels) {
+	const auto file_path = (fs::temp_directory_path() / "tentris_test_labels.nt").string();
+	{
+		std::ofstream file{file_path};
+		file << "_:b1 <http://example.com/p> <http://example.com/o> .\n"
+			 << "_:B1 <http://example.com/p> <http://example.com/o> .\n";
+	}
+	auto parser = NTriplesParser::parse(file_path, 2);
+	drain(parser->result_queue);
+	ASSERT_TRUE(parser->error());
+	fs::remove(file_path);
+}
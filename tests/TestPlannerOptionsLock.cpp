@@ -0,0 +1,50 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <future>
+#include <optional>
+
+#include <tentris/tensor/PlannerOptionsLock.hpp>
+
+namespace {
+	using tentris::tensor::PlannerOptions;
+	using tentris::tensor::PlannerOptionsLock;
+	using namespace std::chrono_literals;
+
+	const PlannerOptions minimum{PlannerOptions::SORT::MINIMUM, PlannerOptions::WEIGHT::CARDINALITY};
+	const PlannerOptions maximum{PlannerOptions::SORT::MAXIMUM, PlannerOptions::WEIGHT::NORMAL};
+
+	bool isSet(const PlannerOptions &planner_options) {
+		return ::einsum::internal::sort_order == planner_options.sort_order and
+			   ::einsum::internal::weight_func == planner_options.weight_func;
+	}
+}
+
+TEST(TestPlannerOptionsLock, same_heuristic_is_shared) {
+	PlannerOptionsLock lock{};
+	auto first = lock.acquire(minimum);
+	ASSERT_TRUE(first);
+	auto second = lock.acquire(minimum, std::chrono::steady_clock::now());
+	ASSERT_TRUE(second);
+	ASSERT_TRUE(isSet(minimum));
+}
+
+TEST(TestPlannerOptionsLock, other_heuristic_waits_for_running_queries) {
+	PlannerOptionsLock lock{};
+	std::optional<PlannerOptionsLock::Guard> running = lock.acquire(minimum);
+	ASSERT_FALSE(lock.acquire(maximum, std::chrono::steady_clock::now() + 20ms));
+
+	auto waiting = std::async(std::launch::async, [&]() {
+		auto guard = lock.acquire(maximum);
+		return isSet(maximum);
+	});
+	ASSERT_EQ(waiting.wait_for(50ms), std::future_status::timeout);
+	// new queries with the running heuristic queue up behind the waiting one
+	ASSERT_FALSE(lock.acquire(minimum, std::chrono::steady_clock::now() + 20ms));
+	ASSERT_TRUE(isSet(minimum));
+
+	running.reset();
+	ASSERT_TRUE(waiting.get());
+	ASSERT_TRUE(lock.acquire(minimum, std::chrono::steady_clock::now() + 1s));
+	ASSERT_TRUE(isSet(minimum));
+}
@@ -0,0 +1,27 @@
+#include <gtest/gtest.h>
+
+#include <tentris/store/RDF/PrefixResolver.hpp>
+
+namespace {
+	using namespace tentris::store::rdf;
+}
+
+TEST(TestPrefixResolver, expand) {
+	PrefixResolver resolver{};
+	resolver.set("ex", "http://example.com/");
+	resolver.set("", "http://base.com/");
+	std::string iri{};
+	ASSERT_TRUE(resolver.expand("ex:a", iri));
+	ASSERT_EQ(iri, "http://example.com/a");
+	ASSERT_TRUE(resolver.expand("ex:a:b", iri));
+	ASSERT_EQ(iri, "http://example.com/a:b");
+	ASSERT_TRUE(resolver.expand(":c", iri));
+	ASSERT_EQ(iri, "http://base.com/c");
+	ASSERT_FALSE(resolver.expand("unknown:a", iri));
+	ASSERT_FALSE(resolver.expand("no_colon", iri));
+	ASSERT_EQ(iri, "http://base.com/c");
+
+	resolver.set("ex", "http://example.org/");
+	ASSERT_TRUE(resolver.expand("ex:a", iri));
+	ASSERT_EQ(iri, "http://example.org/a");
+}
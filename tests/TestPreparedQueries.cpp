@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include <tentris/store/PreparedQueries.hpp>
+#include <tentris/store/TripleStore.hpp>
+
+namespace {
+	using namespace tentris::store;
+	using Term = rdf_parser::store::rdf::Term;
+
+	const std::string name_query = "SELECT ?name WHERE { $person <http://xmlns.com/foaf/0.1/name> ?name }";
+}
+
+TEST(TestPreparedQueries, prepare) {
+	PreparedQueries prepared_queries{};
+	const auto prepared = prepared_queries.prepare(name_query);
+	ASSERT_EQ(prepared->getParameterNames(), std::vector<std::string>{"person"});
+	ASSERT_EQ(prepared->getId().size(), 32);
+	ASSERT_EQ(prepared_queries.prepare(name_query), prepared);
+	ASSERT_EQ(prepared_queries.find(prepared->getId()), prepared);
+
+	const auto other = prepared_queries.prepare(
+			"SELECT ?name WHERE { $person <http://xmlns.com/foaf/0.1/nick> ?name }");
+	ASSERT_NE(other->getId(), prepared->getId());
+	ASSERT_EQ(prepared_queries.size(), 2);
+	ASSERT_EQ(prepared_queries.find("1"), nullptr);
+	ASSERT_THROW(prepared_queries.prepare("SELECT ?name WHERE {"), std::invalid_argument);
+}
+
+TEST(TestPreparedQueries, remove_and_evict) {
+	PreparedQueries prepared_queries{2};
+	const auto first = prepared_queries.prepare(name_query);
+	ASSERT_TRUE(prepared_queries.remove(first->getId()));
+	ASSERT_FALSE(prepared_queries.remove(first->getId()));
+	ASSERT_EQ(prepared_queries.find(first->getId()), nullptr);
+	ASSERT_EQ(prepared_queries.size(), 0);
+
+	const auto a = prepared_queries.prepare("SELECT ?o WHERE { $s <http://example.com/a> ?o }");
+	const auto b = prepared_queries.prepare("SELECT ?o WHERE { $s <http://example.com/b> ?o }");
+	ASSERT_EQ(prepared_queries.find(a->getId()), a); // b is now the least recently used one
+	const auto c = prepared_queries.prepare("SELECT ?o WHERE { $s <http://example.com/c> ?o }");
+	ASSERT_EQ(prepared_queries.size(), 2);
+	ASSERT_EQ(prepared_queries.find(b->getId()), nullptr);
+	ASSERT_EQ(prepared_queries.find(a->getId()), a);
+	ASSERT_EQ(prepared_queries.find(c->getId()), c);
+	// the evicted query is registered anew
+	ASSERT_NE(prepared_queries.prepare("SELECT ?o WHERE { $s <http://example.com/b> ?o }")->getId(), b->getId());
+}
+
+TEST(TestPreparedQueries, bind) {
+	using namespace tentris::tensor;
+	auto triple_store = std::make_shared<TripleStore>();
+	triple_store->add({"<http://example.com/alice>", "<http://xmlns.com/foaf/0.1/name>", "\"Alice\""});
+	triple_store->add({"<http://example.com/bob>", "<http://xmlns.com/foaf/0.1/name>", "\"Bob\""});
+	PreparedQueries prepared_queries{};
+	const auto prepared = prepared_queries.prepare(name_query);
+
+	auto package = prepared->bind({{"person", Term::make_term("<http://example.com/alice>")}}, triple_store);
+	ASSERT_FALSE(package->is_trivial_empty);
+	ASSERT_EQ(package->getTripleStore(), triple_store);
+	auto einsum = package->getEinsum();
+	std::size_t results = 0;
+	for (const auto &entry : *static_cast<Einsum<COUNTED_t> *>(einsum.get()))
+		results += entry.value;
+	ASSERT_EQ(results, 1);
+
+	ASSERT_TRUE(prepared->bind({{"person", Term::make_term("<http://example.com/carol>")}},
+							   triple_store)->is_trivial_empty);
+	ASSERT_THROW(prepared->bind({}, triple_store), std::invalid_argument);
+}
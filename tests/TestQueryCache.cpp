@@ -0,0 +1,209 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <tentris/util/ShardedClockCache.hpp>
+#include <tentris/util/SyncedLRUCache.hpp>
+
+namespace {
+	using namespace tentris::util::sync;
+
+	std::atomic<std::size_t> constructions{0};
+
+	struct SlowValue {
+		std::string key;
+
+		explicit SlowValue(const std::string &key) : key(key) {
+			++constructions;
+			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+			if (key == "invalid")
+				throw std::invalid_argument{"invalid key"};
+		}
+	};
+
+	struct Value {
+		std::string key;
+
+		explicit Value(const std::string &key) : key(key) {}
+	};
+
+	/**
+	 * Reports a fixed memory usage. Keys starting with "expensive" take long to construct.
+	 */
+	struct SizedValue {
+		constexpr static std::size_t bytes = 1000;
+
+		explicit SizedValue(const std::string &key) {
+			if (key.rfind("expensive", 0) == 0)
+				std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		}
+
+		[[nodiscard]] std::size_t memoryUsage() const {
+			return bytes;
+		}
+	};
+
+	template<typename Cache>
+	class TestQueryCache : public ::testing::Test {
+	};
+
+	// selects the cache implementation; the value type differs between the tests
+
+	struct SyncedLRU {
+		template<typename V>
+		using cache_type = SyncedLRUCache<std::string, V>;
+	};
+
+	struct ShardedClock {
+		template<typename V>
+		using cache_type = ShardedClockCache<std::string, V>;
+	};
+
+	using CacheTypes = ::testing::Types<SyncedLRU, ShardedClock>;
+}
+
+TYPED_TEST_SUITE(TestQueryCache, CacheTypes);
+
+TYPED_TEST(TestQueryCache, hit_returns_cached_value) {
+	typename TypeParam::template cache_type<Value> cache{100};
+	const auto first = cache["query"];
+	ASSERT_EQ(first->key, "query");
+	ASSERT_EQ(cache["query"], first);
+	ASSERT_NE(cache["other"], first);
+	const auto stats = cache.stats();
+	ASSERT_EQ(stats.hits, 1);
+	ASSERT_EQ(stats.misses, 2);
+	ASSERT_EQ(cache.size(), 2);
+	cache.erase("query");
+	ASSERT_NE(cache["query"], first);
+}
+
+TYPED_TEST(TestQueryCache, size_is_bounded) {
+	typename TypeParam::template cache_type<Value> cache{64};
+	for (std::size_t i = 0; i < 10'000; ++i)
+		(void) cache[fmt::format("query {}", i % 1000)];
+	// SyncedLRUCache may grow by its elasticity before it prunes
+	ASSERT_LE(cache.size(), 64 + 100);
+	cache.clear();
+	ASSERT_TRUE(cache.empty());
+}
+
+TYPED_TEST(TestQueryCache, concurrent_misses_construct_once) {
+	typename TypeParam::template cache_type<SlowValue> cache{10};
+	constructions = 0;
+	std::vector<std::thread> threads{};
+	std::vector<std::shared_ptr<SlowValue>> values(8);
+	for (std::size_t i = 0; i < values.size(); ++i)
+		threads.emplace_back([&, i]() { values[i] = cache["query"]; });
+	for (auto &thread : threads)
+		thread.join();
+	ASSERT_EQ(constructions, 1);
+	for (const auto &value : values)
+		ASSERT_EQ(value, values.front());
+	const auto stats = cache.stats();
+	ASSERT_EQ(stats.hits + stats.misses, values.size());
+	ASSERT_EQ(stats.misses - stats.coalesced, 1);
+	// the lock is never held during a construction
+	ASSERT_LT(stats.max_lock_hold, std::chrono::milliseconds(50));
+}
+
+TYPED_TEST(TestQueryCache, failed_construction_is_not_cached) {
+	typename TypeParam::template cache_type<SlowValue> cache{10};
+	constructions = 0;
+	ASSERT_THROW((void) cache["invalid"], std::invalid_argument);
+	ASSERT_THROW((void) cache["invalid"], std::invalid_argument);
+	ASSERT_EQ(constructions, 2);
+	ASSERT_EQ(cache.size(), 0);
+}
+
+TYPED_TEST(TestQueryCache, clear_discards_running_construction) {
+	typename TypeParam::template cache_type<SlowValue> cache{10};
+	std::thread miss{[&]() { (void) cache["query"]; }};
+	while (cache.stats().misses == 0)
+		std::this_thread::yield();
+	cache.clear();
+	miss.join();
+	ASSERT_EQ(cache.size(), 0);
+}
+
+TEST(TestShardedClockCache, byte_budget_evicts_cheap_entries_first) {
+	constexpr std::size_t entries_per_shard = 12;
+	constexpr std::size_t max_bytes = ShardedClockCache<std::string, SizedValue>::shard_count * entries_per_shard *
+									  (SizedValue::bytes + 200);
+	ShardedClockCache<std::string, SizedValue> cache{1'000'000, max_bytes};
+	for (std::size_t i = 0; i < 16; ++i)
+		(void) cache[fmt::format("expensive {}", i)];
+	for (std::size_t i = 0; i < 2000; ++i)
+		(void) cache[fmt::format("cheap {}", i)];
+	auto stats = cache.stats();
+	ASSERT_LE(stats.bytes, max_bytes);
+	ASSERT_GT(stats.evictions, 0);
+
+	const auto hits_before = stats.hits;
+	for (std::size_t i = 0; i < 16; ++i)
+		(void) cache[fmt::format("expensive {}", i)];
+	ASSERT_EQ(cache.stats().hits - hits_before, 16);
+}
+
+TEST(TestShardedClockCache, entries_over_budget_are_not_cached) {
+	ShardedClockCache<std::string, SizedValue> cache{100, SizedValue::bytes};
+	(void) cache["query"];
+	ASSERT_EQ(cache.size(), 0);
+	ASSERT_EQ(cache.stats().bytes, 0);
+}
+
+TEST(TestShardedClockCache, limits_apply_to_the_whole_cache) {
+	ShardedClockCache<std::string, Value> single{1};
+	for (std::size_t i = 0; i < 1000; ++i) {
+		(void) single[fmt::format("query {}", i)];
+		ASSERT_EQ(single.size(), 1);
+	}
+	ASSERT_EQ(single.stats().evictions, 999);
+
+	// an entry may use more than its shard's share of the byte budget
+	constexpr std::size_t max_bytes = 4 * (SizedValue::bytes + 200);
+	ShardedClockCache<std::string, SizedValue> sized{1000, max_bytes};
+	for (std::size_t i = 0; i < 1000; ++i) {
+		(void) sized[fmt::format("query {}", i)];
+		ASSERT_GE(sized.size(), 1);
+		ASSERT_LE(sized.stats().bytes, max_bytes);
+	}
+	ASSERT_LE(sized.size(), 4);
+}
+
+TEST(TestShardedClockCache, frequency_sketch_estimates_recent_accesses) {
+	FrequencySketch sketch{64};
+	const std::size_t hot = absl::Hash<std::string>()("hot");
+	const std::size_t cold = absl::Hash<std::string>()("cold");
+	for (std::size_t i = 0; i < 5; ++i)
+		sketch.record(hot);
+	sketch.record(cold);
+	ASSERT_GE(sketch.estimate(hot), 5);
+	ASSERT_LT(sketch.estimate(cold), sketch.estimate(hot));
+	sketch.age();
+	ASSERT_EQ(sketch.estimate(hot), 2);
+}
+
+TEST(TestShardedClockCache, tiny_lfu_keeps_hot_entries_during_scan) {
+	constexpr std::size_t hot_keys = 64;
+	ShardedClockCache<std::string, Value> always{256};
+	ShardedClockCache<std::string, Value> tiny_lfu{256, 0, AdmissionPolicy::TINY_LFU};
+	for (auto *cache : {&always, &tiny_lfu}) {
+		// every hot key is requested once per 8 * hot_keys one-off keys, e.g. queries with unique constants
+		for (std::size_t i = 0; i < 80'000; ++i) {
+			(void) (*cache)[fmt::format("scan {}", i)];
+			if (i % 8 == 0)
+				(void) (*cache)[fmt::format("hot {}", (i / 8) % hot_keys)];
+		}
+	}
+	ASSERT_EQ(always.stats().rejections, 0);
+	ASSERT_GT(tiny_lfu.stats().rejections, 0);
+	// only hot keys can hit
+	ASSERT_GT(tiny_lfu.stats().hits, 2 * always.stats().hits);
+	ASSERT_GT(tiny_lfu.stats().hits, 10'000 * 8 / 10);
+}
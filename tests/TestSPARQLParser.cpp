@@ -4,7 +4,9 @@
 #include <regex>
 #include <filesystem>
 
+#include <tentris/store/SPARQL/NormalizedQuery.hpp>
 #include <tentris/store/SPARQL/ParsedSPARQL.hpp>
+#include <tentris/store/SPARQL/QueryShape.hpp>
 #include <tentris/util/FmtHelper.hpp>
 
 
@@ -133,4 +135,106 @@ TEST(TestSPARQLParser, parse_a_query) {
     fmt::print("{}", q);
 }
 
+TEST(TestSPARQLParser, normalized_queries_share_shape) {
+    const NormalizedQuery q1{"PREFIX foaf: <http://xmlns.com/foaf/0.1/>\n"
+                             "select ?name where {\n"
+                             "  <http://example.com/alice> foaf:name ?name . # comment\n"
+                             "  <http://example.com/alice> foaf:age 42 }"};
+    const NormalizedQuery q2{"PREFIX f: <http://xmlns.com/foaf/0.1/> PREFIX ex: <http://example.com/> "
+                             "SELECT ?name WHERE { ex:bob f:name ?name. ex:bob f:age 7 }"};
+    ASSERT_EQ(q1.getShape(), q2.getShape());
+    ASSERT_EQ(q1.getShape(), "SELECT ?name WHERE { ?__param0 ?__param1 ?name . ?__param0 ?__param2 ?__param3 }");
+    ASSERT_EQ(q1.getParameters().size(), 4);
+    ASSERT_EQ(q1.getParameters()[0], Term::make_term("<http://example.com/alice>"));
+    ASSERT_EQ(q2.getParameters()[0], Term::make_term("<http://example.com/bob>"));
+    ASSERT_EQ(q1.getParameters()[1], q2.getParameters()[1]);
+    ASSERT_EQ(q1.getParameters()[3],
+              Term::make_term("\"42\"^^<http://www.w3.org/2001/XMLSchema#integer>"));
+
+    const NormalizedQuery literal{"SELECT ?s WHERE { ?s ?p \"chat\"@fr } LIMIT 10"};
+    ASSERT_EQ(literal.getShape(), "SELECT ?s WHERE { ?s ?p ?__param0 } LIMIT 10");
+    ASSERT_EQ(literal.getParameters(), std::vector{Term::make_term("\"chat\"@fr")});
+
+    // constants are not lifted if the query uses the parameter names itself
+    const NormalizedQuery reserved{"SELECT ?__param0 WHERE { ?__param0 <http://example.com/p> ?o }"};
+    ASSERT_TRUE(reserved.getParameters().empty());
+
+    ASSERT_THROW(NormalizedQuery{"SELECT ?s WHERE { ?s ex:p ?o }"}, std::invalid_argument);
+}
+
+TEST(TestSPARQLParser, query_shapes_bind_benchmark_queries) {
+    std::size_t checked = 0;
+    for (const auto &file : {"queries/sp2b.txt", "queries/DBpedia.txt", "queries/swdf.txt"})
+        for (const auto &query : load_queries(file)) {
+            std::optional<ParsedSPARQL> parsed_sparql{};
+            try {
+                parsed_sparql.emplace(query);
+            } catch (const std::exception &) {
+                continue;
+            }
+            const NormalizedQuery normalized_query{query};
+            const QueryShape shape{normalized_query.getShape()};
+            const auto bgps = shape.bind(normalized_query.getParameters());
+            ASSERT_EQ(std::set<TriplePattern>(bgps.begin(), bgps.end()), parsed_sparql->getBgps()) << query;
+            ASSERT_EQ(shape.getQueryVariables(), parsed_sparql->getQueryVariables()) << query;
+            ASSERT_EQ(shape.getSelectModifier(), parsed_sparql->getSelectModifier()) << query;
+            ++checked;
+        }
+    ASSERT_GT(checked, 0);
+}
+
+TEST(TestSPARQLParser, named_parameters_of_prepared_queries) {
+    const NormalizedQuery prepared{"PREFIX foaf: <http://xmlns.com/foaf/0.1/> "
+                                   "SELECT ?name WHERE { $person foaf:name ?name . $person foaf:knows $friend }", true};
+    ASSERT_EQ(prepared.getShape(),
+              "SELECT ?name WHERE { ?__param2 ?__param0 ?name . ?__param2 ?__param1 ?__param3 }");
+    ASSERT_EQ(prepared.getParameters().size(), 2);
+    ASSERT_EQ(prepared.getNamedParameters(), (std::map<std::string, std::size_t>{{"person", 2}, {"friend", 3}}));
+
+    // without named parameters, $person is an ordinary variable
+    const NormalizedQuery query{"SELECT ?name WHERE { $person <http://xmlns.com/foaf/0.1/name> ?name }"};
+    ASSERT_EQ(query.getShape(), "SELECT ?name WHERE { ?person ?__param0 ?name }");
 
+    ASSERT_THROW((NormalizedQuery{"SELECT $person WHERE { $person ?p ?o }", true}), std::invalid_argument);
+}
+
+TEST(TestSPARQLParser, subset_parser_matches_antlr) {
+    std::size_t parsed_by_subset_parser = 0;
+    for (const auto &file : {"queries/sp2b.txt", "queries/DBpedia.txt", "queries/swdf.txt"})
+        for (const auto &query : load_queries(file)) {
+            std::optional<ParsedSPARQL> antlr{};
+            try {
+                antlr.emplace(query, false);
+            } catch (const std::exception &) {
+                ASSERT_THROW(ParsedSPARQL{query}, std::invalid_argument) << query;
+                continue;
+            }
+            const ParsedSPARQL parsed_sparql{query};
+            ASSERT_EQ(parsed_sparql.getBgps(), antlr->getBgps()) << query;
+            ASSERT_EQ(parsed_sparql.getQueryVariables(), antlr->getQueryVariables()) << query;
+            ASSERT_EQ(parsed_sparql.getVariables(), antlr->getVariables()) << query;
+            ASSERT_EQ(parsed_sparql.getSelectModifier(), antlr->getSelectModifier()) << query;
+            if (parsed_sparql.isParsedBySubsetParser())
+                ++parsed_by_subset_parser;
+        }
+    ASSERT_GT(parsed_by_subset_parser, 0);
+}
+
+TEST(TestSPARQLParser, subset_parser_terms_and_fallback) {
+    const std::string query = "PREFIX ex: <http://example.org/> select distinct ?s { ?s a ex:C ; "
+                              "ex:p 'it\\'s \"x\"'@en-US , \"y\"^^ex:t , -2.5 , true , _:b1 , [] . }";
+    const ParsedSPARQL parsed_sparql{query};
+    ASSERT_TRUE(parsed_sparql.isParsedBySubsetParser());
+    const ParsedSPARQL antlr{query, false};
+    ASSERT_EQ(parsed_sparql.getBgps(), antlr.getBgps());
+    ASSERT_EQ(parsed_sparql.getSelectModifier(), SelectModifier::DISTINCT);
+    ASSERT_EQ(antlr.getSelectModifier(), SelectModifier::DISTINCT);
+    ASSERT_EQ(parsed_sparql.getBgps().count(TriplePattern{Variable{"s"}, URIRef{"http://example.org/p"},
+                                                          Literal{"it's \\\"x\\\"", "en-US", std::nullopt}}), 1);
+
+    // not in the supported subset
+    ASSERT_FALSE(ParsedSPARQL{"SELECT ?s WHERE { ?s ?p ?o FILTER (?o) }"}.isParsedBySubsetParser());
+    ASSERT_FALSE(ParsedSPARQL{"SELECT ?s WHERE { ?s ?p ?o } LIMIT 10"}.isParsedBySubsetParser());
+    // syntax errors are reported by ANTLR
+    ASSERT_THROW(ParsedSPARQL{"SELECT ?s WHERE { ?s ?p }"}, std::invalid_argument);
+}
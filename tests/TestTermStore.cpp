@@ -1,8 +1,11 @@
 #include <gtest/gtest.h>
+#include <thread>
+#include <vector>
 #include <tentris/store/RDF/TermStore.hpp>
 
 namespace {
     using namespace tentris::store::rdf;
+    using namespace fmt::literals;
 }
 TEST(TestTermStore, double_write) {
     TermStore store{};
@@ -21,3 +24,121 @@ TEST(TestTermStore, double_write_same_str) {
 }
 
 
+
+TEST(TestTermStore, dense_ids) {
+	TermStore store{};
+	auto first = store[Term::make_term("<http://example.com/a>")];
+	auto second = store[Term::make_term("\"b\"")];
+	ASSERT_EQ(first, 1);
+	ASSERT_EQ(second, 2);
+	ASSERT_EQ(store.find(Term::make_term("<http://example.com/c>")), TermStore::no_id);
+	ASSERT_EQ(store.decode(first), Term::make_term("<http://example.com/a>"));
+	ASSERT_TRUE(store.valid(second));
+	ASSERT_FALSE(store.valid(3));
+}
+
+TEST(TestTermStore, get_names_missing_term) {
+	TermStore store{};
+	try {
+		(void) store.get(Term::make_term("<http://example.com/c>"));
+		FAIL() << "the missing term was found";
+	} catch (const std::out_of_range &e) {
+		ASSERT_STREQ(e.what(), "Term <http://example.com/c> not in TermStore.");
+	}
+}
+
+TEST(TestTermStore, compressed_iris) {
+	TermStore store{};
+	auto a = store[Term::make_term("<http://example.com/ns#a>")];
+	auto b = store[Term::make_term("<http://example.com/ns#b>")];
+	auto no_namespace = store[Term::make_term("<urn:isbn:0451450523>")];
+	auto literal = store[Term::make_term("\"http://example.com/ns#a\"")];
+	ASSERT_EQ(store.size(), 4);
+	ASSERT_EQ(store.prefixCount(), 2);
+	ASSERT_EQ(store.find(Term::make_term("<http://example.com/ns#a>")), a);
+	ASSERT_EQ(store.find(Term::make_term("<http://example.com/ns#c>")), TermStore::no_id);
+	ASSERT_EQ(store.find(Term::make_term("<http://example.com/ns/a>")), TermStore::no_id);
+	ASSERT_EQ(store.identifier(b), "<http://example.com/ns#b>");
+	ASSERT_EQ(store.identifier(no_namespace), "<urn:isbn:0451450523>");
+	ASSERT_EQ(store.decode(literal), Term::make_term("\"http://example.com/ns#a\""));
+}
+
+TEST(TestTermStore, inline_literals) {
+	TermStore store{};
+	auto integer = store[Term::make_term(R"("42"^^<http://www.w3.org/2001/XMLSchema#integer>)")];
+	auto boolean = store[Term::make_term(R"("true"^^<http://www.w3.org/2001/XMLSchema#boolean>)")];
+	auto date = store[Term::make_term(R"("2020-02-29"^^<http://www.w3.org/2001/XMLSchema#date>)")];
+	auto double_ = store[Term::make_term(R"("1.5E2"^^<http://www.w3.org/2001/XMLSchema#double>)")];
+	auto not_canonical = store[Term::make_term(R"("042"^^<http://www.w3.org/2001/XMLSchema#integer>)")];
+	ASSERT_EQ(store.size(), 1);
+	ASSERT_EQ(not_canonical, 1);
+	for (auto id : {integer, boolean, date, double_})
+		ASSERT_TRUE(inline_literal::isInline(id));
+	ASSERT_EQ(store.find(Term::make_term(R"("42"^^<http://www.w3.org/2001/XMLSchema#integer>)")), integer);
+	ASSERT_EQ(store.identifier(integer), R"("42"^^<http://www.w3.org/2001/XMLSchema#integer>)");
+	ASSERT_EQ(store.identifier(date), R"("2020-02-29"^^<http://www.w3.org/2001/XMLSchema#date>)");
+	ASSERT_EQ(store.identifier(double_), R"("1.5E2"^^<http://www.w3.org/2001/XMLSchema#double>)");
+	ASSERT_EQ(store.decode(boolean), Term::make_term(R"("true"^^<http://www.w3.org/2001/XMLSchema#boolean>)"));
+	ASSERT_LT(store[Term::make_term(R"("-1"^^<http://www.w3.org/2001/XMLSchema#integer>)")], integer);
+}
+
+TEST(TestTermStore, parts_match_decode) {
+	TermStore store{};
+	std::vector<TermStore::id_type> ids{};
+	for (const auto &identifier : {"<http://example.com/ns#a>", "<urn:isbn:0451450523>", "_:b1", "\"plain\"",
+								   "\"say \\\"hi\\\"\"@en", R"("x"^^<http://example.com/type>)",
+								   R"("42"^^<http://www.w3.org/2001/XMLSchema#integer>)"})
+		ids.push_back(store[Term::make_term(identifier)]);
+	std::string inline_buffer{};
+	for (auto id : ids) {
+		const Term term = store.decode(id);
+		const auto parts = store.parts(id, inline_buffer);
+		ASSERT_EQ(parts.type, term.type());
+		ASSERT_EQ(std::string{parts.value_prefix} + std::string{parts.value}, term.value());
+		if (term.isLiteral()) {
+			const auto &literal = term.castLiteral();
+			ASSERT_EQ(parts.datatype, literal.hasDataType() ? literal.dataType() : std::string_view{});
+			ASSERT_EQ(parts.lang, literal.hasLang() ? literal.lang() : std::string_view{});
+		}
+	}
+	ASSERT_EQ(store.parts(ids[0], inline_buffer).value_prefix, "http://example.com/ns#");
+	ASSERT_EQ(store.parts(ids.back(), inline_buffer).value, "42");
+}
+
+TEST(TestTermStore, concurrent_insert) {
+	TermStore store{};
+	constexpr std::size_t threads = 8;
+	constexpr std::size_t terms_per_thread = 1000;
+	std::vector<std::thread> workers{};
+	for (std::size_t worker = 0; worker < threads; ++worker)
+		workers.emplace_back([&]() {
+			// all threads insert the same terms
+			for (std::size_t i = 0; i < terms_per_thread; ++i)
+				store[Term::make_term("<http://example.com/ns{}/term{}>"_format(i % 10, i))];
+		});
+	for (auto &worker : workers)
+		worker.join();
+	ASSERT_EQ(store.size(), terms_per_thread);
+	ASSERT_EQ(store.prefixCount(), 11);
+	for (std::size_t i = 0; i < terms_per_thread; ++i) {
+		const auto identifier = "<http://example.com/ns{}/term{}>"_format(i % 10, i);
+		const auto id = store.find(Term::make_term(identifier));
+		ASSERT_TRUE(store.valid(id));
+		ASSERT_EQ(store.identifier(id), identifier);
+	}
+}
+
+TEST(TestTermStore, find_while_inserting) {
+	TermStore store{};
+	const auto known = Term::make_term("<http://example.com/known>");
+	const auto known_id = store[known];
+	std::thread inserter([&]() {
+		// grows the hash sets of all shards while the lookups run
+		for (std::size_t i = 0; i < 100'000; ++i)
+			store[Term::make_term("<http://example.com/term{}>"_format(i))];
+	});
+	for (std::size_t i = 0; i < 100'000; ++i)
+		ASSERT_EQ(store.find(known), known_id);
+	inserter.join();
+	ASSERT_EQ(store.size(), 100'001);
+}
@@ -1,7 +1,14 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <array>
 #include <filesystem>
+#include <fstream>
+#include <future>
+#include <thread>
 
+#include <tentris/store/AtomicTripleStore.hpp>
+#include <tentris/store/BackgroundReload.hpp>
 #include <tentris/store/TripleStore.hpp>
 #include <tentris/util/FmtHelper.hpp>
 
@@ -9,7 +16,245 @@ namespace {
     namespace fs = std::filesystem;
 
     using namespace tentris::store;
+    using namespace tentris::store::sparql;
 }
 
+TEST(TestTripleStore, parse_update) {
+	using Term = rdf_parser::store::rdf::Term;
+	ParsedUpdate update{R"(
+		PREFIX ex: <http://example.com/>
+		INSERT DATA { ex:s ex:p "a # b", ex:o ; ex:q _:b1 } ; # comment
+		DELETE data { <http://example.com/s> <http://example.com/p> """multi
+line""" . }
+	)"};
+	const auto &operations = update.getOperations();
+	ASSERT_EQ(operations.size(), 2);
+	ASSERT_EQ(operations[0].type, ParsedUpdate::OperationType::INSERT_DATA);
+	ASSERT_EQ(operations[0].triples.size(), 3);
+	ASSERT_EQ(operations[0].triples[0].subject(), Term::make_term("<http://example.com/s>"));
+	ASSERT_EQ(operations[0].triples[0].object().value(), "a # b");
+	ASSERT_EQ(operations[0].triples[2].object().type(), Term::NodeType::BNode_);
+	ASSERT_EQ(operations[1].type, ParsedUpdate::OperationType::DELETE_DATA);
+	ASSERT_EQ(operations[1].triples[0].object().value(), "multi\nline");
 
+	ASSERT_THROW(ParsedUpdate{"DELETE WHERE { ?s ?p ?o }"}, std::invalid_argument);
+	ASSERT_THROW(ParsedUpdate{"INSERT DATA { GRAPH <http://example.com/g> { <a:s> <a:p> <a:o> } }"},
+				 std::invalid_argument);
+	ASSERT_THROW(ParsedUpdate{"DELETE DATA { _:b <http://example.com/p> <http://example.com/o> }"},
+				 std::invalid_argument);
+	ASSERT_THROW(ParsedUpdate{"INSERT DATA { <http://example.com/s> <http://example.com/p> "},
+				 std::invalid_argument);
+}
+
+TEST(TestTripleStore, update) {
+	TripleStore store{};
+	store.add({"<http://example.com/s>", "<http://example.com/p>", "<http://example.com/o>"});
+
+	auto stats = store.update(ParsedUpdate{R"(
+		INSERT DATA { <http://example.com/s> <http://example.com/p> <http://example.com/o>, "1", 2 } ;
+		DELETE DATA { <http://example.com/s> <http://example.com/p> <http://example.com/o>, <http://example.com/x> }
+	)"});
+	ASSERT_EQ(stats.inserted, 2);
+	ASSERT_EQ(stats.deleted, 1);
+	ASSERT_EQ(store.size(), 2);
+	ASSERT_FALSE(store.contains({"<http://example.com/s>", "<http://example.com/p>", "<http://example.com/o>"}));
+	ASSERT_TRUE(store.contains({"<http://example.com/s>", "<http://example.com/p>", "\"1\""}));
+	ASSERT_TRUE(store.contains(
+			{"<http://example.com/s>", "<http://example.com/p>", "\"2\"^^<http://www.w3.org/2001/XMLSchema#integer>"}));
+}
+
+TEST(TestTripleStore, update_with_prefixed_datatype) {
+	TripleStore store{};
+	auto stats = store.update(ParsedUpdate{R"(
+		PREFIX xsd: <http://www.w3.org/2001/XMLSchema#>
+		PREFIX ex: <http://example.com/>
+		INSERT DATA { ex:s ex:p "5"^^xsd:integer, "x"^^ex:type }
+	)"});
+	ASSERT_EQ(stats.inserted, 2);
+	ASSERT_TRUE(store.contains(
+			{"<http://example.com/s>", "<http://example.com/p>", "\"5\"^^<http://www.w3.org/2001/XMLSchema#integer>"}));
+	ASSERT_TRUE(store.contains({"<http://example.com/s>", "<http://example.com/p>", "\"x\"^^<http://example.com/type>"}));
+	ASSERT_THROW(ParsedUpdate{"INSERT DATA { <http://example.com/s> <http://example.com/p> \"5\"^^undefined:type }"},
+				 std::invalid_argument);
+}
+
+TEST(TestTripleStore, update_creates_new_version) {
+	using namespace std::chrono_literals;
+	const std::tuple<std::string, std::string, std::string> a{"<http://example.com/a>", "<http://example.com/p>",
+															  "<http://example.com/o>"};
+	const std::tuple<std::string, std::string, std::string> b{"<http://example.com/b>", "<http://example.com/p>",
+															  "<http://example.com/o>"};
+	const std::tuple<std::string, std::string, std::string> c{"<http://example.com/c>", "<http://example.com/p>",
+															  "<http://example.com/o>"};
+	// the global store is restored at the end, so other tests are not affected
+	const auto original = AtomicTripleStore::swap(std::make_shared<TripleStore>());
+	// pinned like a running query does
+	auto first = AtomicTripleStore::pin();
+	first->add(a);
+
+	auto stats = AtomicTripleStore::update(
+			ParsedUpdate{"INSERT DATA { <http://example.com/b> <http://example.com/p> <http://example.com/o> }"}, 20ms);
+	ASSERT_EQ(stats.inserted, 1);
+	auto second = AtomicTripleStore::pin();
+	ASSERT_NE(second, first);
+	ASSERT_FALSE(first->contains(b));
+	ASSERT_TRUE(second->contains(a));
+	ASSERT_TRUE(second->contains(b));
+	ASSERT_EQ(&second->getTermIndex(), &first->getTermIndex());
+
+	// the first version is still pinned, so the store is copied
+	stats = AtomicTripleStore::update(
+			ParsedUpdate{"DELETE DATA { <http://example.com/a> <http://example.com/p> <http://example.com/o> }"}, 20ms);
+	ASSERT_EQ(stats.deleted, 1);
+	auto third = AtomicTripleStore::pin();
+	ASSERT_NE(third, first);
+	ASSERT_NE(third, second);
+	ASSERT_TRUE(first->contains(a));
+	ASSERT_TRUE(second->contains(a));
+	ASSERT_FALSE(third->contains(a));
+	ASSERT_TRUE(third->contains(b));
+
+	// nothing reads the second version anymore, so it is caught up and reused
+	const TripleStore *const second_address = second.get();
+	second.reset();
+	stats = AtomicTripleStore::update(
+			ParsedUpdate{"INSERT DATA { <http://example.com/c> <http://example.com/p> <http://example.com/o> }"}, 1s);
+	ASSERT_EQ(stats.inserted, 1);
+	auto fourth = AtomicTripleStore::pin();
+	ASSERT_EQ(fourth.get(), second_address);
+	ASSERT_FALSE(fourth->contains(a));
+	ASSERT_TRUE(fourth->contains(b));
+	ASSERT_TRUE(fourth->contains(c));
+	ASSERT_EQ(fourth->size(), 2);
+	ASSERT_FALSE(third->contains(c));
+
+	AtomicTripleStore::swap(original);
+}
+
+TEST(TestTripleStore, swap_keeps_pinned_store) {
+	// the global store is restored at the end, so other tests are not affected
+	const auto original = AtomicTripleStore::swap(std::make_shared<TripleStore>());
+	auto pinned = AtomicTripleStore::pin();
+	auto replacement = std::make_shared<TripleStore>();
+	replacement->add({"<http://example.com/s>", "<http://example.com/p>", "<http://example.com/o>"});
+
+	std::weak_ptr<TripleStore> previous = AtomicTripleStore::swap(replacement);
+	ASSERT_EQ(previous.lock(), pinned);
+	ASSERT_EQ(AtomicTripleStore::pin(), replacement);
+	ASSERT_EQ(AtomicTripleStore::getInstance().size(), 1);
+	ASSERT_FALSE(previous.expired());
+	pinned.reset();
+	ASSERT_TRUE(previous.expired());
+
+	AtomicTripleStore::swap(original);
+	ASSERT_EQ(AtomicTripleStore::pin(), original);
+}
+
+TEST(TestTripleStore, update_blocks_reload) {
+	using namespace std::chrono_literals;
+	const auto original = AtomicTripleStore::pin();
+	auto update = BackgroundReload::blockReload();
+	ASSERT_TRUE(update);
+	// the reload must not start, and so not swap the store, while the update holds the lock
+	auto started = std::async(std::launch::async, []() { return BackgroundReload::start("dataset/sp2b.nt", 1); });
+	ASSERT_EQ(started.wait_for(50ms), std::future_status::timeout);
+	ASSERT_EQ(AtomicTripleStore::pin(), original);
+	update.reset();
+	ASSERT_TRUE(started.get());
+	while (BackgroundReload::isRunning())
+		std::this_thread::sleep_for(1ms);
+	ASSERT_TRUE(BackgroundReload::blockReload());
+	const auto reloaded = AtomicTripleStore::swap(original);
+	ASSERT_NE(reloaded, original);
+}
+
+TEST(TestTripleStore, load_error_names_the_position) {
+	const auto file_path = (fs::temp_directory_path() / "tentris_test_invalid.nt").string();
+	{
+		std::ofstream file{file_path};
+		file << "<http://example.com/s> <http://example.com/p> <http://example.com/o> .\n"
+			 << "<http://example.com/s> <http://example.com/p> \"unterminated .\n";
+	}
+	TripleStore store{};
+	try {
+		store.loadRDF(file_path);
+		FAIL() << "the invalid line was not rejected";
+	} catch (const std::invalid_argument &e) {
+		ASSERT_NE(std::string{e.what()}.find("unterminated literal at byte 71"), std::string::npos) << e.what();
+	}
+	fs::remove(file_path);
+}
+
+TEST(TestTripleStore, snapshot_round_trip) {
+	const auto file_path = (fs::temp_directory_path() / "tentris_test.snapshot").string();
+	TripleStore written{};
+	written.loadRDF("dataset/sp2b.nt");
+	written.add({"<http://example.com/s>", "<http://example.com/p>", "\"3\"^^<http://www.w3.org/2001/XMLSchema#integer>"});
+	written.add({"<noslash>", "<http://example.com/p>", "\"a\"@en"});
+	written.writeSnapshot(file_path);
 
+	TripleStore read{};
+	read.loadSnapshot(file_path);
+	const auto &written_terms = written.getTermIndex();
+	const auto &read_terms = read.getTermIndex();
+	ASSERT_EQ(read_terms.size(), written_terms.size());
+	ASSERT_EQ(read_terms.prefixCount(), written_terms.prefixCount());
+	for (rdf::TermStore::id_type id = 1; id <= written_terms.size(); ++id) {
+		ASSERT_EQ(read_terms.identifier(id), written_terms.identifier(id));
+		// the hash sets are rebuilt, so the terms are found by value
+		ASSERT_EQ(read_terms.find(read_terms.decode(id)), id);
+	}
+	ASSERT_EQ(read.size(), written.size());
+	for (const auto &key : written.getBoolHypertrie())
+		ASSERT_TRUE(read.getBoolHypertrie()[key]);
+	ASSERT_TRUE(read.contains({"<noslash>", "<http://example.com/p>", "\"a\"@en"}));
+
+	// the triples are the last part of the file and sorted by key
+	std::ifstream file{file_path, std::ios::binary};
+	snapshot::Header header{};
+	file.read(reinterpret_cast<char *>(&header), sizeof(header));
+	std::vector<std::array<tentris::tensor::key_part_type, 3>> keys(header.triple_count);
+	file.seekg(-std::streamoff(keys.size() * sizeof(keys[0])), std::ios::end);
+	file.read(reinterpret_cast<char *>(keys.data()), keys.size() * sizeof(keys[0]));
+	ASSERT_TRUE(file);
+	ASSERT_TRUE(std::is_sorted(keys.begin(), keys.end()));
+	file.close();
+	fs::remove(file_path);
+}
+
+TEST(TestTripleStore, snapshot_detects_corruption) {
+	const auto file_path = (fs::temp_directory_path() / "tentris_test.snapshot").string();
+	TripleStore written{};
+	written.add({"<http://example.com/s>", "<http://example.com/p>", "<http://example.com/o>"});
+	written.add({"<http://example.com/s>", "<http://example.com/p>", "\"o\""});
+	written.writeSnapshot(file_path);
+	const auto file_size = fs::file_size(file_path);
+
+	auto patch = [&](std::size_t offset, char value) {
+		std::fstream file{file_path, std::ios::binary | std::ios::in | std::ios::out};
+		file.seekp(offset);
+		file.put(value);
+	};
+	auto load = [&]() {
+		TripleStore read{};
+		read.loadSnapshot(file_path);
+	};
+
+	// flipped byte in the body: checksum mismatch
+	patch(file_size - 1, '\xff');
+	ASSERT_THROW(load(), std::invalid_argument);
+
+	// truncated body
+	written.writeSnapshot(file_path);
+	fs::resize_file(file_path, file_size - 4);
+	ASSERT_THROW(load(), std::invalid_argument);
+
+	// no snapshot at all
+	written.writeSnapshot(file_path);
+	patch(0, 'X');
+	ASSERT_THROW(load(), std::invalid_argument);
+
+	written.writeSnapshot(file_path);
+	ASSERT_NO_THROW(load());
+	fs::remove(file_path);
+}
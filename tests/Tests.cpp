@@ -1,5 +1,14 @@
 #include <gtest/gtest.h>
 
+#include "TestBlockingQueue.cpp"
+#include "TestDecompressingReader.cpp"
+#include "TestHeuristicSelector.cpp"
+#include "TestIdTripleFile.cpp"
+#include "TestNTriplesParser.cpp"
+#include "TestPlannerOptionsLock.cpp"
+#include "TestPrefixResolver.cpp"
+#include "TestPreparedQueries.cpp"
+#include "TestQueryCache.cpp"
 #include "TestRDFNode.cpp"
 #include "TestSPARQLParser.cpp"
 #include "TestTermStore.cpp"